@@ -0,0 +1,669 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Headless throughput benchmark for the ModumateCore geometry, meant to be tracked over time on CI.
+// Usage: ModumateCoreBenchmark [--walls N] [--polygon-verts N] [--repeat N]
+
+#include "ModumateDelaunay.h"
+#include "ModumateFloorPlans.h"
+#include "ModumateGeometry.h"
+#include "ModumateSurfaceKernel.h"
+#include "ModumateSweepIntersection.h"
+#include "ModumateTriangulation.h"
+#include "ModumateTriangulationCache.h"
+#include "ModumateWallOpenings.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ModumateCore;
+
+namespace
+{
+	struct FBenchmarkOptions
+	{
+		int32_t NumWalls = 2000;
+		int32_t NumPolygonVerts = 500;
+		int32_t NumRepeats = 5;
+	};
+
+	class FScopedBenchmark
+	{
+	public:
+		FScopedBenchmark(const char* InName, int64_t InNumOps)
+			: Name(InName)
+			, NumOps(InNumOps)
+			, StartTime(std::chrono::steady_clock::now())
+		{ }
+
+		~FScopedBenchmark()
+		{
+			double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+			std::printf("%-28s %12lld ops %10.3f ms %14.0f ops/s\n", Name, static_cast<long long>(NumOps), 1000.0 * Seconds,
+				(Seconds > 0.0) ? (NumOps / Seconds) : 0.0);
+		}
+
+	private:
+		const char* Name;
+		int64_t NumOps;
+		std::chrono::steady_clock::time_point StartTime;
+	};
+
+	FVec3 RandomWallEnd(std::mt19937& Random, const FVec3& Start)
+	{
+		// Mostly axis-aligned walls, like real floor plans, with some diagonals mixed in
+		std::uniform_real_distribution<float> LengthDist(100.0f, 1500.0f);
+		std::uniform_real_distribution<float> UnitDist(0.0f, 1.0f);
+		std::uniform_int_distribution<int32_t> QuadrantDist(0, 3);
+
+		float Length = LengthDist(Random);
+		float Angle = (UnitDist(Random) < 0.8f) ? (1.5707963f * QuadrantDist(Random)) : (6.2831853f * UnitDist(Random));
+		return Start + Length * FVec3{ std::cos(Angle), std::sin(Angle), 0.0f };
+	}
+
+	void BenchSegmentIntersections(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		float Extent = 250.0f * std::sqrt(static_cast<float>(Options.NumWalls));
+		std::uniform_real_distribution<float> PositionDist(0.0f, Extent);
+
+		std::vector<FVec3> Starts, Ends;
+		for (int32_t WallIndex = 0; WallIndex < Options.NumWalls; ++WallIndex)
+		{
+			FVec3 Start{ PositionDist(Random), PositionDist(Random), 0.0f };
+			Starts.push_back(Start);
+			Ends.push_back(RandomWallEnd(Random, Start));
+		}
+
+		int64_t NumPairs = static_cast<int64_t>(Options.NumWalls) * (Options.NumWalls - 1) / 2;
+		int64_t NumHits = 0;
+		{
+			FScopedBenchmark Benchmark("segment intersections", NumPairs * Options.NumRepeats);
+			for (int32_t Repeat = 0; Repeat < Options.NumRepeats; ++Repeat)
+			{
+				FSegmentIntersection Intersection;
+				for (int32_t IndexA = 0; IndexA < Options.NumWalls; ++IndexA)
+				{
+					for (int32_t IndexB = IndexA + 1; IndexB < Options.NumWalls; ++IndexB)
+					{
+						NumHits += IntersectSegments2D(Starts[IndexA], Ends[IndexA], Starts[IndexB], Ends[IndexB], Intersection) ? 1 : 0;
+					}
+				}
+			}
+		}
+		std::printf("    %lld crossings per pass\n", static_cast<long long>(NumHits / Options.NumRepeats));
+	}
+
+	// Compares the sweep with testing every pair, which it has to match exactly. Returns how many crossings differ.
+	int32_t CheckSweepCrossings(const char* LayoutName, const std::vector<FWallSegment>& Walls, int32_t NumRepeats)
+	{
+		int32_t NumWalls = static_cast<int32_t>(Walls.size());
+		std::vector<FSegmentCrossing> SweepCrossings;
+		{
+			FScopedBenchmark Benchmark(LayoutName, static_cast<int64_t>(NumWalls) * NumRepeats);
+			for (int32_t Repeat = 0; Repeat < NumRepeats; ++Repeat)
+			{
+				FindSegmentCrossings(Walls.data(), NumWalls, SweepCrossings);
+			}
+		}
+
+		std::vector<FSegmentCrossing> PairCrossings;
+		FSegmentIntersection Intersection;
+		for (int32_t IndexA = 0; IndexA < NumWalls; ++IndexA)
+		{
+			for (int32_t IndexB = IndexA + 1; IndexB < NumWalls; ++IndexB)
+			{
+				if (IntersectSegments2D(Walls[IndexA].Start, Walls[IndexA].End, Walls[IndexB].Start, Walls[IndexB].End, Intersection))
+				{
+					PairCrossings.push_back(FSegmentCrossing{ IndexA, IndexB, Intersection });
+				}
+			}
+		}
+
+		// Both lists are sorted by indices, so walk them together
+		int32_t NumMismatches = 0;
+		size_t SweepIndex = 0, PairIndex = 0;
+		while ((SweepIndex < SweepCrossings.size()) || (PairIndex < PairCrossings.size()))
+		{
+			const FSegmentCrossing* Swept = (SweepIndex < SweepCrossings.size()) ? &SweepCrossings[SweepIndex] : nullptr;
+			const FSegmentCrossing* Paired = (PairIndex < PairCrossings.size()) ? &PairCrossings[PairIndex] : nullptr;
+			if (Swept && Paired && (Swept->SegmentIndexA == Paired->SegmentIndexA) && (Swept->SegmentIndexB == Paired->SegmentIndexB))
+			{
+				bool bSameHit = (Swept->Intersection.DistAlongA == Paired->Intersection.DistAlongA) &&
+					(Swept->Intersection.DistAlongB == Paired->Intersection.DistAlongB);
+				NumMismatches += bSameHit ? 0 : 1;
+				++SweepIndex;
+				++PairIndex;
+			}
+			else if (Swept && (!Paired || (Swept->SegmentIndexA < Paired->SegmentIndexA) ||
+				((Swept->SegmentIndexA == Paired->SegmentIndexA) && (Swept->SegmentIndexB < Paired->SegmentIndexB))))
+			{
+				++NumMismatches;
+				++SweepIndex;
+			}
+			else
+			{
+				++NumMismatches;
+				++PairIndex;
+			}
+		}
+
+		std::printf("    %d crossings, %d mismatched %s\n", static_cast<int32_t>(PairCrossings.size()), NumMismatches,
+			(NumMismatches > 0) ? "FAILED" : "against every pair");
+		return NumMismatches;
+	}
+
+	void AddTouchingWalls(std::mt19937& Random, const FVec3& Origin, std::vector<FWallSegment>& OutWalls)
+	{
+		std::uniform_real_distribution<float> UnitDist(0.0f, 1.0f);
+		FVec3 Along{ 1.0f, 0.0f, 0.0f }, Across{ 0.0f, 1.0f, 0.0f };
+		if (UnitDist(Random) < 0.5f)
+		{
+			float Angle = 6.2831853f * UnitDist(Random);
+			Along = { std::cos(Angle), std::sin(Angle), 0.0f };
+			Across = { -Along.Y, Along.X, 0.0f };
+		}
+
+		// Overlapping collinear walls, and walls that continue each other end to end
+		OutWalls.push_back({ Origin, Origin + 600.0f * Along });
+		OutWalls.push_back({ Origin + 200.0f * Along, Origin + 900.0f * Along });
+		OutWalls.push_back({ Origin + 900.0f * Along, Origin + 1200.0f * Along });
+
+		// T-junctions, ending on the middle of the walls above, and a wall crossing all of them
+		OutWalls.push_back({ Origin + 300.0f * Along - 400.0f * Across, Origin + 300.0f * Along });
+		OutWalls.push_back({ Origin + 900.0f * Along, Origin + 900.0f * Along + 400.0f * Across });
+		OutWalls.push_back({ Origin + 100.0f * Along - 200.0f * Across, Origin + 1100.0f * Along - 200.0f * Across });
+
+		// Several walls through one point, which all cross each other there at once
+		FVec3 Center = Origin + 600.0f * Along + 600.0f * Across;
+		for (int32_t SpokeIndex = 0; SpokeIndex < 5; ++SpokeIndex)
+		{
+			float Angle = 0.6283185f * SpokeIndex;
+			FVec3 Spoke = 300.0f * (std::cos(Angle) * Along + std::sin(Angle) * Across);
+			OutWalls.push_back({ Center - Spoke, Center + Spoke });
+		}
+	}
+
+	int32_t BenchSweepCrossings(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		int32_t NumMismatches = 0;
+
+		float Extent = 250.0f * std::sqrt(static_cast<float>(Options.NumWalls));
+		std::uniform_real_distribution<float> PositionDist(0.0f, Extent);
+		std::vector<FWallSegment> Walls;
+		for (int32_t WallIndex = 0; WallIndex < Options.NumWalls; ++WallIndex)
+		{
+			FVec3 Start{ PositionDist(Random), PositionDist(Random), 0.0f };
+			Walls.push_back({ Start, RandomWallEnd(Random, Start) });
+		}
+		NumMismatches += CheckSweepCrossings("sweep crossings (random)", Walls, Options.NumRepeats);
+
+		// Two grids, one offset by half a room, so that every wall of one crosses walls of the other
+		int32_t NumRoomsPerSide = std::max(1, static_cast<int32_t>(std::sqrt(Options.NumWalls / 4.0f)));
+		std::vector<FWallSegment> OffsetWalls;
+		Walls.clear();
+		GenerateGridPlan(NumRoomsPerSide, NumRoomsPerSide, 300.0f, Walls);
+		GenerateGridPlan(NumRoomsPerSide, NumRoomsPerSide, 300.0f, OffsetWalls);
+		for (FWallSegment& Wall : OffsetWalls)
+		{
+			FVec3 Offset{ 150.0f, 150.0f, 0.0f };
+			Walls.push_back({ Wall.Start + Offset, Wall.End + Offset });
+		}
+		NumMismatches += CheckSweepCrossings("sweep crossings (grid)", Walls, Options.NumRepeats);
+
+		// Diagonal plans only meet at endpoints and T-junctions, with collinear and touching walls scattered over them
+		Walls.clear();
+		GenerateDiagonalPlan(NumRoomsPerSide, NumRoomsPerSide, 300.0f, 1234, Walls);
+		for (int32_t MotifIndex = 0; MotifIndex < std::max(1, Options.NumWalls / 40); ++MotifIndex)
+		{
+			AddTouchingWalls(Random, FVec3{ PositionDist(Random), PositionDist(Random), 0.0f }, Walls);
+		}
+		NumMismatches += CheckSweepCrossings("sweep crossings (touching)", Walls, Options.NumRepeats);
+
+		return NumMismatches;
+	}
+
+	std::vector<FVec3> MakeStarPolygon(std::mt19937& Random, int32_t NumVerts, float MinRadius = 500.0f, float MaxRadius = 1000.0f)
+	{
+		// Star-shaped around the origin, so it's always simple, with plenty of reflex vertices.
+		// Angles decrease so that the ears wind the way that TriangulatePolygon expects around +Z.
+		std::uniform_real_distribution<float> RadiusDist(MinRadius, MaxRadius);
+		std::vector<FVec3> Verts;
+		for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+		{
+			float Angle = -6.2831853f * VertIndex / NumVerts;
+			float Radius = RadiusDist(Random);
+			Verts.push_back({ Radius * std::cos(Angle), Radius * std::sin(Angle), 0.0f });
+		}
+
+		return Verts;
+	}
+
+	typedef bool (*FTriangulator)(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices);
+
+	bool TriangulateWithScratch(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		// Reusing the scratch and the output's capacity, so repeats after the first one don't allocate
+		static FTriangulationScratch Scratch;
+		OutIndices.resize(GetMaxTriangleIndices(NumVerts, 1));
+		int32_t NumIndices = TriangulatePolygon(TVertexArrayAccessor<FVec3>(Verts), NumVerts, Normal, Scratch, OutIndices.data());
+		OutIndices.resize(std::max(NumIndices, 0));
+		return NumIndices >= 0;
+	}
+
+	bool TriangulateSingleLoopDelaunay(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		return TriangulatePolygonDelaunay(Verts, &NumVerts, 1, Normal, OutIndices);
+	}
+
+	bool TriangulateHoleDelaunay(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		// The last quarter of the vertices are a hole, which fits inside of the outer loop's smallest radius
+		int32_t LoopSizes[2] = { NumVerts - NumVerts / 4, NumVerts / 4 };
+		return TriangulatePolygonDelaunay(Verts, LoopSizes, 2, Normal, OutIndices);
+	}
+
+	bool TriangulateCachedDelaunay(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		FTriangulationCache::FIndexBuffer Indices = FTriangulationCache::Get().Triangulate(TVertexArrayAccessor<FVec3>(Verts), &NumVerts, 1, Normal);
+		if (!Indices)
+		{
+			return false;
+		}
+
+		OutIndices.insert(OutIndices.end(), Indices->begin(), Indices->end());
+		return true;
+	}
+
+	void BenchTriangulation(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		const FVec3 Normal{ 0.0f, 0.0f, 1.0f };
+		std::vector<FVec3> Polygon = MakeStarPolygon(Random, Options.NumPolygonVerts);
+		std::vector<FVec3> HolePolygon = MakeStarPolygon(Random, Options.NumPolygonVerts - Options.NumPolygonVerts / 4);
+		std::vector<FVec3> Hole = MakeStarPolygon(Random, Options.NumPolygonVerts / 4, 100.0f, 400.0f);
+		HolePolygon.insert(HolePolygon.end(), Hole.begin(), Hole.end());
+
+		auto RunTriangulator = [&Options, &Normal](const char* Name, const std::vector<FVec3>& Verts, FTriangulator Triangulator)
+		{
+			std::vector<int32_t> Indices;
+			bool bSucceeded = true;
+			{
+				FScopedBenchmark Benchmark(Name, static_cast<int64_t>(Verts.size()) * Options.NumRepeats);
+				for (int32_t Repeat = 0; Repeat < Options.NumRepeats; ++Repeat)
+				{
+					Indices.clear();
+					bSucceeded &= Triangulator(Verts.data(), static_cast<int32_t>(Verts.size()), Normal, Indices);
+				}
+			}
+
+			// The triangles should exactly cover the polygon, so their areas should add up to its area, less any holes
+			double TriangleArea = 0.0;
+			for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+			{
+				const FVec3& A = Verts[Indices[Index]];
+				TriangleArea += 0.5 * (((Verts[Indices[Index + 1]] - A) ^ (Verts[Indices[Index + 2]] - A)) | Normal);
+			}
+			std::printf("    %s, %zu triangles, area %.0f\n", bSucceeded ? "succeeded" : "FAILED", Indices.size() / 3, TriangleArea);
+		};
+
+		RunTriangulator("triangulated verts (naive)", Polygon, &TriangulatePolygonNaive);
+		RunTriangulator("triangulated verts", Polygon, &TriangulatePolygon);
+		RunTriangulator("triangulated verts (scratch)", Polygon, &TriangulateWithScratch);
+		RunTriangulator("triangulated verts (CDT)", Polygon, &TriangulateSingleLoopDelaunay);
+		RunTriangulator("triangulated verts (holes)", HolePolygon, &TriangulateHoleDelaunay);
+		RunTriangulator("triangulated verts (cached)", Polygon, &TriangulateCachedDelaunay);
+	}
+
+	// Returns how many of the rooms failed to triangulate, or lost area doing it
+	int32_t BenchIslandFloors(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		// Rectangular rooms with rectangular islands, like columns and shafts, whose corners are all cocircular in pairs
+		const FVec3 Normal{ 0.0f, 0.0f, 1.0f };
+		const int32_t NumRooms = 1000 * Options.NumRepeats;
+		std::uniform_real_distribution<float> UnitDist(0.0f, 1.0f);
+		std::vector<FVec3> Verts;
+		std::vector<int32_t> LoopSizes;
+		std::vector<int32_t> Indices;
+		int32_t NumFailed = 0;
+		{
+			FScopedBenchmark Benchmark("island floors (CDT)", NumRooms);
+			for (int32_t RoomIndex = 0; RoomIndex < NumRooms; ++RoomIndex)
+			{
+				float Width = 500.0f + 1500.0f * UnitDist(Random), Depth = 500.0f + 1500.0f * UnitDist(Random);
+				int32_t NumIslands = 2 + static_cast<int32_t>(Random() % 5);
+				Verts = { { 0.0f, 0.0f, 0.0f }, { 0.0f, Depth, 0.0f }, { Width, Depth, 0.0f }, { Width, 0.0f, 0.0f } };
+				LoopSizes = { 4 };
+				double ExpectedArea = static_cast<double>(Width) * Depth;
+
+				// Each island gets its own column of the room, so that they never overlap
+				float ColumnWidth = Width / NumIslands;
+				for (int32_t IslandIndex = 0; IslandIndex < NumIslands; ++IslandIndex)
+				{
+					float MinX = ColumnWidth * (IslandIndex + 0.1f + 0.2f * UnitDist(Random));
+					float MaxX = MinX + ColumnWidth * (0.2f + 0.3f * UnitDist(Random));
+					float MinY = Depth * (0.1f + 0.3f * UnitDist(Random));
+					float MaxY = MinY + Depth * (0.1f + 0.4f * UnitDist(Random));
+					Verts.insert(Verts.end(), { { MinX, MinY, 0.0f }, { MaxX, MinY, 0.0f }, { MaxX, MaxY, 0.0f }, { MinX, MaxY, 0.0f } });
+					LoopSizes.push_back(4);
+					ExpectedArea -= static_cast<double>(MaxX - MinX) * (MaxY - MinY);
+				}
+
+				Indices.clear();
+				if (!TriangulatePolygonDelaunay(Verts.data(), LoopSizes.data(), static_cast<int32_t>(LoopSizes.size()), Normal, Indices))
+				{
+					++NumFailed;
+					continue;
+				}
+
+				double TriangleArea = 0.0;
+				for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+				{
+					const FVec3& A = Verts[Indices[Index]];
+					TriangleArea -= 0.5 * (((Verts[Indices[Index + 1]] - A) ^ (Verts[Indices[Index + 2]] - A)) | Normal);
+				}
+				if (std::abs(TriangleArea - ExpectedArea) > 1.0e-3 * ExpectedArea)
+				{
+					++NumFailed;
+				}
+			}
+		}
+		std::printf("    %d of %d rooms with islands %s\n", NumFailed, NumRooms, (NumFailed > 0) ? "FAILED" : "failed");
+
+		return NumFailed;
+	}
+
+	void BenchParallelFloors(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		// Like a project load, where every room's floor is triangulated at once, each through the shared cache
+		const FVec3 Normal{ 0.0f, 0.0f, 1.0f };
+		const int32_t NumFloors = 256;
+		std::vector<std::vector<FVec3>> Floors;
+		for (int32_t FloorIndex = 0; FloorIndex < NumFloors; ++FloorIndex)
+		{
+			Floors.push_back(MakeStarPolygon(Random, Options.NumPolygonVerts));
+		}
+
+		auto TriangulateFloors = [&Floors, &Normal](int32_t NumThreads)
+		{
+			std::atomic<int32_t> NextFloor(0);
+			std::atomic<int32_t> NumFailed(0);
+			auto TriangulateNextFloors = [&]()
+			{
+				for (int32_t FloorIndex = NextFloor++; FloorIndex < static_cast<int32_t>(Floors.size()); FloorIndex = NextFloor++)
+				{
+					int32_t NumVerts = static_cast<int32_t>(Floors[FloorIndex].size());
+					if (!FTriangulationCache::Get().Triangulate(TVertexArrayAccessor<FVec3>(Floors[FloorIndex].data()), &NumVerts, 1, Normal))
+					{
+						++NumFailed;
+					}
+				}
+			};
+
+			std::vector<std::thread> Threads;
+			for (int32_t ThreadIndex = 1; ThreadIndex < NumThreads; ++ThreadIndex)
+			{
+				Threads.emplace_back(TriangulateNextFloors);
+			}
+			TriangulateNextFloors();
+			for (std::thread& Thread : Threads)
+			{
+				Thread.join();
+			}
+
+			return NumFailed.load();
+		};
+
+		int32_t NumThreads = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+		int64_t NumVerts = static_cast<int64_t>(NumFloors) * Options.NumPolygonVerts * Options.NumRepeats;
+		int32_t NumFailed = 0;
+		{
+			FScopedBenchmark Benchmark("floor verts (serial)", NumVerts);
+			for (int32_t Repeat = 0; Repeat < Options.NumRepeats; ++Repeat)
+			{
+				FTriangulationCache::Get().Empty();
+				NumFailed += TriangulateFloors(1);
+			}
+		}
+		{
+			FScopedBenchmark Benchmark("floor verts (parallel)", NumVerts);
+			for (int32_t Repeat = 0; Repeat < Options.NumRepeats; ++Repeat)
+			{
+				FTriangulationCache::Get().Empty();
+				NumFailed += TriangulateFloors(NumThreads);
+			}
+		}
+		std::printf("    %d threads, %d failed\n", NumThreads, NumFailed);
+		FTriangulationCache::Get().Empty();
+	}
+
+	void BenchRoomWinding(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		const FVec3 Normal{ 0.0f, 0.0f, 1.0f };
+		std::vector<FVec3> Polygon = MakeStarPolygon(Random, Options.NumPolygonVerts);
+		std::vector<FVec3> LoopDirs;
+		for (size_t VertIndex = 0; VertIndex < Polygon.size(); ++VertIndex)
+		{
+			FVec3 Edge = Polygon[(VertIndex + 1) % Polygon.size()] - Polygon[VertIndex];
+			LoopDirs.push_back(Edge / Edge.Size());
+		}
+
+		int32_t NumLoops = 1000 * Options.NumRepeats;
+		float Winding = 0.0f;
+		{
+			FScopedBenchmark Benchmark("room loop windings", static_cast<int64_t>(NumLoops) * Options.NumPolygonVerts);
+			for (int32_t Loop = 0; Loop < NumLoops; ++Loop)
+			{
+				Winding = GetLoopWinding(LoopDirs.data(), static_cast<int32_t>(LoopDirs.size()), Normal);
+			}
+		}
+		std::printf("    winding %.2f degrees\n", Winding);
+	}
+
+	void BenchWallOpenings(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		// A long wall lined with windows and doors, which are nudged one at a time, remeshing the wall after each, like dragging them
+		const int32_t NumOpenings = 100;
+		const float Spacing = 200.0f;
+		const FVec3 Start{ 0.0f, 0.0f, 0.0f };
+		const FVec3 End{ Spacing * (NumOpenings + 1), 0.0f, 0.0f };
+		std::uniform_real_distribution<float> NudgeDist(-10.0f, 10.0f);
+
+		FWallOpeningList Openings;
+		std::vector<int32_t> OpeningIDs;
+		for (int32_t OpeningIndex = 0; OpeningIndex < NumOpenings; ++OpeningIndex)
+		{
+			float Center = Spacing * (OpeningIndex + 1);
+			float Sill = (OpeningIndex % 4 == 0) ? 0.0f : 90.0f;
+			OpeningIDs.push_back(Openings.Add({ -1, Center - 50.0f, Center + 50.0f, Sill, 210.0f }, End.X));
+		}
+
+		std::vector<FVec3> Vertices, Normals;
+		std::vector<int32_t> Indices;
+		int32_t NumMoves = 10 * NumOpenings * Options.NumRepeats;
+		int32_t NumMoved = 0;
+		{
+			FScopedBenchmark Benchmark("wall openings moved", NumMoves);
+			for (int32_t Move = 0; Move < NumMoves; ++Move)
+			{
+				int32_t OpeningID = OpeningIDs[Move % NumOpenings];
+				FWallOpening Opening = *Openings.Find(OpeningID);
+				float Nudge = NudgeDist(Random);
+				Opening.Start += Nudge;
+				Opening.End += Nudge;
+				if (Openings.Move(OpeningID, Opening, End.X))
+				{
+					++NumMoved;
+				}
+				BuildWallMesh(Start, End, 10.0f, 300.0f, Openings, Vertices, Normals, Indices);
+			}
+		}
+		std::printf("    %d moved\n", NumMoved);
+
+		// Previewing a new opening slid along one gap, which only remeshes that span once the rest of the wall has been meshed around it
+		float GapStart, GapEnd;
+		Openings.GetGapAround(1.5f * Spacing, End.X, GapStart, GapEnd);
+		BuildWallMeshAroundSpan(Start, End, 10.0f, 300.0f, Openings, GapStart, GapEnd, Vertices, Normals, Indices);
+		int32_t NumPreviews = 10 * NumOpenings * Options.NumRepeats;
+		int32_t NumPreviewTriangles = 0;
+		{
+			FScopedBenchmark Benchmark("wall opening previews", NumPreviews);
+			std::uniform_real_distribution<float> PreviewDist(GapStart + 20.0f, GapEnd - 20.0f);
+			for (int32_t Preview = 0; Preview < NumPreviews; ++Preview)
+			{
+				float Center = PreviewDist(Random);
+				FWallOpening Opening = { -1, Center - 10.0f, Center + 10.0f, 100.0f, 150.0f };
+				BuildWallSpanMesh(Start, End, 10.0f, 300.0f, Openings, GapStart, GapEnd, &Opening, Vertices, Normals, Indices);
+				NumPreviewTriangles += static_cast<int32_t>(Indices.size() / 3);
+			}
+		}
+		std::printf("    %d triangles per preview\n", NumPreviewTriangles / NumPreviews);
+
+		// FWallBox split each wall into 3 more boxes per window and 2 more per door, with 12 triangles each, and 8 vertices
+		// whose normals were shared between faces, or 24 with a normal per face like these meshes
+		int32_t NumDoors = (NumOpenings + 3) / 4;
+		int32_t NumBoxes = 1 + 3 * (NumOpenings - NumDoors) + 2 * NumDoors;
+		std::printf("    per box:  %6d vertices (%d with face normals), %6d triangles\n", 8 * NumBoxes, 24 * NumBoxes, 12 * NumBoxes);
+		BuildWallMesh(Start, End, 10.0f, 300.0f, Openings, Vertices, Normals, Indices, false);
+		std::printf("    unwelded: %6d vertices, %6d triangles\n", static_cast<int32_t>(Vertices.size()), static_cast<int32_t>(Indices.size() / 3));
+		BuildWallMesh(Start, End, 10.0f, 300.0f, Openings, Vertices, Normals, Indices);
+		std::printf("    welded:   %6d vertices, %6d triangles\n", static_cast<int32_t>(Vertices.size()), static_cast<int32_t>(Indices.size() / 3));
+
+		// Collision is cooked from boxes around the openings rather than from the mesh's triangles
+		std::vector<FWallSolidBox> Boxes;
+		GetWallSolidBoxes(Openings, End.X, 300.0f, Boxes);
+		std::printf("    collision: %5d boxes\n", static_cast<int32_t>(Boxes.size()));
+
+		// From far enough away, the wall is drawn as a slab, with a quad over each opening
+		BuildWallSlabMesh(Start, End, 10.0f, 300.0f, Vertices, Normals, Indices);
+		int32_t NumSlabTriangles = static_cast<int32_t>(Indices.size() / 3);
+		BuildWallOpeningQuads(Start, End, 10.0f, 300.0f, Openings, 0.5f, Vertices, Normals, Indices);
+		std::printf("    simplified: %4d triangles (%d slab, %d opening quads)\n", NumSlabTriangles + static_cast<int32_t>(Indices.size() / 3),
+			NumSlabTriangles, static_cast<int32_t>(Indices.size() / 3));
+	}
+
+	void BenchFlatSurface(const FBenchmarkOptions& Options, std::mt19937& Random)
+	{
+		// Every wall's welded mesh, with a window and a door, shaded the way each one is before it's uploaded
+		struct FWallMesh
+		{
+			std::vector<FVec3> Vertices, Normals;
+			std::vector<int32_t> Indices;
+		};
+
+		std::vector<FWallMesh> Meshes(Options.NumWalls);
+		int64_t NumVertices = 0;
+		FVec3 Start{ 0.0f, 0.0f, 0.0f };
+		for (FWallMesh& Mesh : Meshes)
+		{
+			FVec3 End = RandomWallEnd(Random, Start);
+			float Length = (End - Start).Size();
+			FWallOpeningList Openings;
+			Openings.Add({ -1, 0.2f * Length, 0.4f * Length, 90.0f, 210.0f }, Length);
+			Openings.Add({ -1, 0.6f * Length, 0.8f * Length, 0.0f, 210.0f }, Length);
+			BuildWallMesh(Start, End, 10.0f, 300.0f, Openings, Mesh.Vertices, Mesh.Normals, Mesh.Indices);
+			NumVertices += static_cast<int64_t>(Mesh.Vertices.size());
+			Start = End;
+		}
+
+		std::vector<FVec3> Tangents;
+		std::vector<FVec2> UVs;
+		double Checksum = 0.0;
+		{
+			FScopedBenchmark Benchmark("flat surface verts", NumVertices * Options.NumRepeats);
+			for (int32_t Repeat = 0; Repeat < Options.NumRepeats; ++Repeat)
+			{
+				for (FWallMesh& Mesh : Meshes)
+				{
+					int32_t NumMeshVertices = static_cast<int32_t>(Mesh.Vertices.size());
+					Tangents.resize(NumMeshVertices);
+					UVs.resize(NumMeshVertices);
+					ComputeFlatSurface(Mesh.Vertices.data(), NumMeshVertices, Mesh.Indices.data(), static_cast<int32_t>(Mesh.Indices.size()), 0.01f,
+						Mesh.Normals.data(), Tangents.data(), UVs.data());
+					Checksum += UVs[0].X + UVs[0].Y;
+				}
+			}
+		}
+		std::printf("    checksum %.3f\n", Checksum);
+	}
+
+	void BenchImperialConversion(const FBenchmarkOptions& Options)
+	{
+		int32_t NumConversions = 1000000 * Options.NumRepeats;
+		int64_t Checksum = 0;
+		{
+			FScopedBenchmark Benchmark("imperial conversions", NumConversions);
+			int32_t Imperial[4];
+			for (int32_t Conversion = 0; Conversion < NumConversions; ++Conversion)
+			{
+				int32_t NumValues = CentimetersToImperialInches(0.01f * (Conversion % 100000), Imperial);
+				Checksum += Imperial[0] + Imperial[1] + ((NumValues == 4) ? Imperial[2] : 0);
+			}
+		}
+		std::printf("    checksum %lld\n", static_cast<long long>(Checksum));
+	}
+
+	bool ParseOptions(int argc, char** argv, FBenchmarkOptions& OutOptions)
+	{
+		for (int ArgIndex = 1; ArgIndex < argc; ++ArgIndex)
+		{
+			const char* Arg = argv[ArgIndex];
+			const char* Value = (ArgIndex + 1 < argc) ? argv[ArgIndex + 1] : nullptr;
+			int32_t* Option = nullptr;
+
+			if (std::strcmp(Arg, "--walls") == 0)
+			{
+				Option = &OutOptions.NumWalls;
+			}
+			else if (std::strcmp(Arg, "--polygon-verts") == 0)
+			{
+				Option = &OutOptions.NumPolygonVerts;
+			}
+			else if (std::strcmp(Arg, "--repeat") == 0)
+			{
+				Option = &OutOptions.NumRepeats;
+			}
+
+			if ((Option == nullptr) || (Value == nullptr) || (std::atoi(Value) <= 0))
+			{
+				std::fprintf(stderr, "Usage: %s [--walls N] [--polygon-verts N] [--repeat N]\n", argv[0]);
+				return false;
+			}
+
+			*Option = std::atoi(Value);
+			++ArgIndex;
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FBenchmarkOptions Options;
+	if (!ParseOptions(argc, argv, Options))
+	{
+		return 1;
+	}
+
+	std::printf("ModumateCore benchmark: %d walls, %d polygon vertices, %d repeats\n",
+		Options.NumWalls, Options.NumPolygonVerts, Options.NumRepeats);
+
+	std::mt19937 Random(1234);
+	BenchSegmentIntersections(Options, Random);
+	int32_t NumSweepMismatches = BenchSweepCrossings(Options, Random);
+	BenchTriangulation(Options, Random);
+	int32_t NumFailedIslandFloors = BenchIslandFloors(Options, Random);
+	BenchParallelFloors(Options, Random);
+	BenchRoomWinding(Options, Random);
+	BenchWallOpenings(Options, Random);
+	BenchFlatSurface(Options, Random);
+	BenchImperialConversion(Options);
+
+	// Throughput is only tracked, but wrong crossings or rooms that can't be triangulated fail the run
+	return ((NumSweepMismatches > 0) || (NumFailedIslandFloors > 0)) ? 1 : 0;
+}
@@ -17,6 +17,7 @@ public class Modumate : ModuleRules
             "Json",
 			//"DesktopPlatform",    Editor-only :(
 			"Slate",
+			"ModumateCore",
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
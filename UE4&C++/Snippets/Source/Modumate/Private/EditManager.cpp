@@ -3,16 +3,27 @@
 #include "EditManager.h"
 
 #include "Serialization/JsonTypes.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Reverse.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Engine/World.h"
 #include "ModumateGameInstance.h"
 #include "DrawDebugHelpers.h"
 #include "Wall.h"
+#include "WallSweepIntersector.h"
+#include "WallGraph.h"
 #include "Window.h"
 #include "Floor.h"
 #include "Room.h"
 #include "CaseWorkLine.h"
 #include "RoomNode.h"
+#include "ModumateGeometry.h"
+#include "ModumateTriangulation.h"
+#include "ModumateTriangulationCache.h"
+#include "ModumateCoreConversions.h"
+#include "ModumateProfiling.h"
 #include "DimensionStringBase.h"
 #include "ProceduralMeshComponent.h"
 
@@ -28,8 +39,15 @@ UEditManager::UEditManager(const FObjectInitializer& ObjectInitializer)
 	, RoomNodeClass(ARoomNode::StaticClass())
 	, RoomNodeEpsilon(0.1f)
 	, PendingWall(nullptr)
+	, PendingWallMesh(nullptr)
+	, PendingWallSurfaceDir(FVector::ZeroVector)
+	, WallGridCellSize(250.0f)
+	, WallClusterCellSize(2000.0f)
+	, SimplifiedMeshScreenSize(0.25f)
+	, WallOpeningLODMaterial(nullptr)
 	, PendingFloorLine(nullptr)
 	, PendingCaseWorkLine(nullptr)
+	, NextRoomID(0)
 {
 
 }
@@ -44,6 +62,63 @@ UWorld* UEditManager::GetWorld() const
 	return nullptr;
 }
 
+void UEditManager::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	WallGrid.SetCellSize(WallGridCellSize);
+	RoomNodeHash.SetEpsilon(RoomNodeEpsilon);
+	WallClusters.SetCellSize(WallClusterCellSize);
+}
+
+void UEditManager::Tick(float DeltaTime)
+{
+	WallClusters.SetOpeningMaterial(WallOpeningLODMaterial);
+	WallClusters.RebuildDirtyClusters(GetWorld(), MeshJobs, MeshLODs);
+	MeshJobs.UploadFinished();
+	CollisionQueue.CookIdle();
+
+	APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		MeshLODs.SimplifiedScreenSize = SimplifiedMeshScreenSize;
+		MeshLODs.Update(PlayerController->PlayerCameraManager->GetCameraLocation(), PlayerController->PlayerCameraManager->GetFOVAngle());
+	}
+}
+
+bool UEditManager::IsTickable() const
+{
+	return (MeshJobs.HasWork() || WallClusters.HasDirtyClusters() || CollisionQueue.HasWork() || MeshLODs.HasMeshes()) && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+TStatId UEditManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEditManager, STATGROUP_Tickables);
+}
+
+void UEditManager::FlushMeshBuilds()
+{
+	// Walls' own meshes go first, since uploading them can leave their clusters needing to be remeshed
+	MeshJobs.Flush();
+	WallClusters.SetOpeningMaterial(WallOpeningLODMaterial);
+	WallClusters.RebuildDirtyClusters(GetWorld(), MeshJobs, MeshLODs);
+	MeshJobs.Flush();
+	CollisionQueue.Flush();
+}
+
+void UEditManager::DestroyWallClusters()
+{
+	WallClusters.Empty(MeshJobs, MeshLODs);
+}
+
+void UEditManager::SetWallSelected(AWall* Wall, bool bSelected)
+{
+	if (ensureAlways(Wall))
+	{
+		WallClusters.SetWallSelected(Wall, bSelected);
+	}
+}
+
 
 TSharedPtr<FJsonObject> UEditManager::SerializeToJson() const
 {
@@ -64,14 +139,18 @@ bool UEditManager::DeserializeFromJson(const TSharedPtr<FJsonObject>& JsonObject
 {
 	auto WallsJson = JsonObject->GetArrayField(GET_MEMBER_NAME_STRING_CHECKED(UEditManager, Walls));
 
+	TArray<AWall*> LoadedWalls;
 	for (int32 iWall = 0; iWall < WallsJson.Num(); ++iWall)
 	{
 		AWall* NewWall = SpawnWall();
 		NewWall->DeserializeFromJson(WallsJson[iWall]->AsObject());
-		Walls.Add(NewWall);
-		OnWallMoved(NewWall);
+		LoadedWalls.Add(NewWall);
 	}
 
+	// Keep every saved wall, even if it crosses another one, but connect them and find rooms in a single batch.
+	TArray<AWall*> PlacedWalls;
+	CommitWallBatch(LoadedWalls, false, PlacedWalls);
+
 	return true;
 }
 
@@ -147,129 +226,223 @@ void UEditManager::RemoveFloor(class AFloor* Floor)
 	}
 }
 
-void UEditManager::GenterateFloorBase(UProceduralMeshComponent* FloorBase, float depth)
+namespace
 {
-	//FloorBase = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("GeneratedMesh"));
+	// The floor and casework builders below only read their arguments and write to their own buffers, so they run on worker threads,
+	// from a copy of the outline, and their meshes are uploaded in a later frame. They size the top, bottom and sides up front,
+	// so that building a mesh doesn't reallocate as it goes.
 
+	// Triangulates a flat outline into OutIndices, which is reused; safe to call from any thread
+	void TriangulateOutline(const TArray<FVector>& vertices, TArray<int32>& OutIndices)
+	{
+		OutIndices.Reset();
 
-	FloorBase->bUseAsyncCooking = true;
+		// Can't work if not enough verts for 1 triangle
+		if (vertices.Num() < 3)
+		{
+			// Return the indices of a single tri, as if the poly already were one
+			OutIndices.Add(0);
+			OutIndices.Add(1);
+			OutIndices.Add(2);
+			return;
+		}
 
-	TArray<FVector> vertices;
-	//vertices.Add(FloorLines[0]->StartPoint);
-	for (int i = 0; i != FloorLines.Num(); i++)
-	{
-		vertices.Add(FloorLines[i]->StartPoint);
-	}
+		// Read the vertices in place, rather than converting them, and size the output exactly once
+		ModumateCore::TVertexArrayAccessor<FVector> PolyVerts(vertices.GetData());
+		int32 NumPolyVerts = vertices.Num();
+		OutIndices.Reserve(ModumateCore::GetMaxTriangleIndices(NumPolyVerts, 1));
+
+		// Delaunay triangles avoid the long slivers that ear clipping leaves, which shade and collide badly.
+		// Floors and casework are regenerated with the same outlines, so those come straight from the shared cache.
+		bool bCacheHit = false;
+		ModumateCore::FTriangulationCache::FIndexBuffer CachedIndices = ModumateCore::FTriangulationCache::Get().Triangulate(
+			PolyVerts, &NumPolyVerts, 1, ToCore(FVector::UpVector), &bCacheHit);
+		FModumateCounters::AddTriangulationCacheLookup(bCacheHit);
+		if (CachedIndices)
+		{
+			OutIndices.Append(CachedIndices->data(), CachedIndices->size());
+			return;
+		}
 
-	TArray<int32> triangles = Triangulate(vertices);
+		OutIndices.SetNumUninitialized(ModumateCore::GetMaxTriangleIndices(NumPolyVerts, 1));
+		int32 NumIndices = ModumateCore::TriangulatePolygon(PolyVerts, NumPolyVerts, ToCore(FVector::UpVector),
+			ModumateCore::GetThreadTriangulationScratch(), OutIndices.GetData());
+		if (NumIndices < 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Triangulation of poly failed."));
+			NumIndices = 0;
+		}
 
-	//add thickness here
-	//setting up double sided floor
-	TArray<FVector> bottomVertices;
-	for (int i = 0; i != FloorLines.Num(); i++)
+		OutIndices.SetNum(NumIndices, false);
+	}
+
+	// Adds the sides between an outline's two caps, where the second cap's vertices follow the first's.
+	// Each side gets its own corners, rather than sharing the caps' vertices, so that it's shaded flat.
+	void AddOutlineSides(TArray<FVector>& vertices, int32 NumOutlineVerts, TArray<int32>& triangles)
 	{
-		FVector _i = FloorLines[i]->StartPoint;
+		for (int i = 0; i < NumOutlineVerts; i++)
+		{
+			int Next = (i + 1) % NumOutlineVerts;
+			FVector Corners[4] = { vertices[i], vertices[Next], vertices[i + NumOutlineVerts], vertices[Next + NumOutlineVerts] };
 
-		_i.Z = -depth;
-		bottomVertices.Add(_i);
-	}
+			int SideStart = vertices.Num();
+			vertices.Append(Corners, 4);
 
+			triangles.Add(SideStart + 2);
+			triangles.Add(SideStart + 1);
+			triangles.Add(SideStart);
 
-	TArray<int32> bottomTriangle;
-	for (int i = 0; i < triangles.Num(); i++)
-	{
-		bottomTriangle.Add(triangles[(triangles.Num() - 1 - i)] + vertices.Num());
+			triangles.Add(SideStart + 2);
+			triangles.Add(SideStart + 3);
+			triangles.Add(SideStart + 1);
+		}
 	}
 
-	TArray<int32> sides;
-	for (int i = 0; i < vertices.Num(); i++)
+	// Builds a floor slab, from its outline down to depth below the origin, with its bottom facing down
+	void BuildFloorBaseMesh(const TArray<FVector>& Outline, float depth, FModumateMeshBuffers& OutBuffers)
 	{
-		if (i < vertices.Num() - 1)
+		int32 NumOutlineVerts = Outline.Num();
+		int32 NumCapIndices = ModumateCore::GetMaxTriangleIndices(NumOutlineVerts, 1);
+
+		TArray<FVector>& vertices = OutBuffers.Vertices;
+		vertices.Reserve(6 * NumOutlineVerts);
+		vertices.Append(Outline);
+
+		TArray<int32>& triangles = OutBuffers.Triangles;
+		TriangulateOutline(vertices, triangles);
+		triangles.Reserve(2 * NumCapIndices + 6 * NumOutlineVerts);
+		int32 NumTopIndices = triangles.Num();
+
+		//add thickness here
+		//setting up double sided floor
+		for (int i = 0; i != NumOutlineVerts; i++)
 		{
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + 1);
-			sides.Add(i);
+			FVector _i = Outline[i];
 
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + (vertices.Num() + 1));
-			sides.Add(i + 1);
+			_i.Z = -depth;
+			vertices.Add(_i);
 		}
-		else
-		{
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + 1);
-			sides.Add(i);
 
-			sides.Add(vertices.Num());
-			sides.Add(0);
-			sides.Add(i);
+		AddOutlineSides(vertices, NumOutlineVerts, triangles);
+
+		// The bottom is the top, flipped over
+		for (int i = 0; i < NumTopIndices; i++)
+		{
+			triangles.Add(triangles[(NumTopIndices - 1 - i)] + NumOutlineVerts);
 		}
-	}
 
-	//add verst to vertecies
-	for (int i = 0; i != bottomVertices.Num(); i++)
-	{
-		vertices.Add(bottomVertices[i]);
+		OutBuffers.ComputeFlatSurface();
+		OutBuffers.VertexColors.Init(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f), triangles.Num());
 	}
 
-	//add rest of the indeces
-	for (int i = 0; i < sides.Num(); i++)
+	// Builds a casework block, from its outline on the ground up to height, with its top vertices first
+	void BuildCaseWorkMesh(const TArray<FVector>& Outline, float height, FModumateMeshBuffers& OutBuffers)
 	{
-		triangles.Add(sides[i]);
-	}
+		int32 NumOutlineVerts = Outline.Num();
+		int32 NumCapIndices = ModumateCore::GetMaxTriangleIndices(NumOutlineVerts, 1);
+
+		TArray<int32>& triangles = OutBuffers.Triangles;
+		TriangulateOutline(Outline, triangles);
+		triangles.Reserve(2 * NumCapIndices + 6 * NumOutlineVerts);
+		int32 NumBottomIndices = triangles.Num();
+
+		//setting up double sided CaseWork, with the top first
+		TArray<FVector>& AllVerts = OutBuffers.Vertices;
+		AllVerts.Reserve(6 * NumOutlineVerts);
+		for (int i = 0; i != NumOutlineVerts; i++)
+		{
+			FVector _i = Outline[i];
 
-	for (int i = 0; i < bottomTriangle.Num(); i++)
-	{
-		triangles.Add(bottomTriangle[i]);
-	}
+			_i.Z = height;
+			AllVerts.Add(_i);
+		}
+		AllVerts.Append(Outline);
 
-	//setup the rest of the variables
-	//TODO PEYVAN Figure out algo to fix \/
-
-	TArray<FVector> normals;
-	//for (int i = 0; i != bottomTriangle.Num(); i++)
-	//{
-	//	normals.Add(FVector(0, 0, 1));
-	//}
-	//for (int i = 0; i != bottomTriangle.Num(); i++)
-	//{
-	//	normals.Add(FVector(0, 0, -1));
-	//}
-
-	//TODO PEYVAN Figure out UV algo to fix
-	TArray<FVector2D> UV0;
-	/*for (int i = 0; i != triangles.Num() / 3; i++)
-	{
-		UV0.Add(FVector2D(0.0f, 0.0f));
-		UV0.Add(FVector2D(1.0f, 0.0f));
-		UV0.Add(FVector2D(0.0f, 1.0f));
-	}*/
+		AddOutlineSides(AllVerts, NumOutlineVerts, triangles);
 
-	TArray<FProcMeshTangent> tangents;
-	/*for (int i = 0; i != triangles.Num(); i++)
-	{
-		tangents.Add(FProcMeshTangent(0, 1, 0));
-	}*/
+		for (int i = 0; i < NumBottomIndices; i++)
+		{
+			triangles.Add(triangles[(NumBottomIndices - 1 - i)] + NumOutlineVerts);
+		}
 
+		OutBuffers.ComputeFlatSurface();
+		OutBuffers.VertexColors.Init(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f), triangles.Num());
+	}
+
+	// Floors and casework are drawn with their outline's full extrusion in section 0 up close, and simplified in section 1
+	const int32 OutlineMeshSection = 0;
+	const int32 SimplifiedOutlineMeshSection = 1;
 
-	TArray<FLinearColor> vertexColors;
-	for (int i = 0; i != triangles.Num(); i++)
+	// Builds only the floor's top, which is all that can be seen of it from far away
+	void BuildSimplifiedFloorBaseMesh(const TArray<FVector>& Outline, FModumateMeshBuffers& OutBuffers)
 	{
-		vertexColors.Add(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f));
+		OutBuffers.Vertices.Append(Outline);
+		TriangulateOutline(OutBuffers.Vertices, OutBuffers.Triangles);
+		OutBuffers.ComputeFlatSurface();
+		OutBuffers.VertexColors.Init(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f), OutBuffers.Triangles.Num());
 	}
 
-	//TODO PEYVAN Figure out algo to fix /\
+	// Builds a casework block from the bounding rectangle of its outline, wound the same way, so that it only takes a box
+	void BuildSimplifiedCaseWorkMesh(const TArray<FVector>& Outline, float height, FModumateMeshBuffers& OutBuffers)
+	{
+		if (Outline.Num() < 3)
+		{
+			BuildCaseWorkMesh(Outline, height, OutBuffers);
+			return;
+		}
 
-	normals.Empty();
-	UV0.Empty();
-	tangents.Empty();
-	//vertexColors.Empty();
+		FBox Bounds(Outline);
+		float TwiceArea = 0.0f;
+		for (int32 i = 0; i < Outline.Num(); i++)
+		{
+			const FVector& Next = Outline[(i + 1) % Outline.Num()];
+			TwiceArea += Outline[i].X * Next.Y - Next.X * Outline[i].Y;
+		}
 
+		TArray<FVector> BoundsOutline = {
+			FVector(Bounds.Min.X, Bounds.Min.Y, Bounds.Min.Z), FVector(Bounds.Max.X, Bounds.Min.Y, Bounds.Min.Z),
+			FVector(Bounds.Max.X, Bounds.Max.Y, Bounds.Min.Z), FVector(Bounds.Min.X, Bounds.Max.Y, Bounds.Min.Z) };
+		if (TwiceArea < 0.0f)
+		{
+			Algo::Reverse(BoundsOutline);
+		}
 
-	FloorBase->CreateMeshSection_LinearColor(0, vertices, triangles, normals, UV0, vertexColors, tangents, true);
+		BuildCaseWorkMesh(BoundsOutline, height, OutBuffers);
+	}
+}
 
+void UEditManager::GenterateFloorBase(UProceduralMeshComponent* FloorBase, float depth)
+{
+	MODUMATE_STAGE_SCOPE(GenerateFloorBase);
+
+	FloorBase->bUseAsyncCooking = true;
 
+	TArray<FVector> Outline;
+	Outline.Reserve(FloorLines.Num());
+	for (int i = 0; i != FloorLines.Num(); i++)
+	{
+		Outline.Add(FloorLines[i]->StartPoint);
+	}
 
+	// Outlines aren't generally convex, so the floor collides with its triangles, which are cooked once editing is idle
+	MeshJobs.Submit(FloorBase, SimplifiedOutlineMeshSection, false, [Outline](FModumateMeshBuffers& OutBuffers)
+	{
+		BuildSimplifiedFloorBaseMesh(Outline, OutBuffers);
+	},
+	[this](UProceduralMeshComponent* UploadedMesh, const FModumateMeshBuffers& Buffers)
+	{
+		UploadedMesh->SetMaterial(SimplifiedOutlineMeshSection, UploadedMesh->GetMaterial(OutlineMeshSection));
+		MeshLODs.SetLODSections(UploadedMesh, { OutlineMeshSection }, { SimplifiedOutlineMeshSection });
+	});
+	MeshJobs.Submit(FloorBase, OutlineMeshSection, false, [Outline = MoveTemp(Outline), depth](FModumateMeshBuffers& OutBuffers)
+	{
+		BuildFloorBaseMesh(Outline, depth, OutBuffers);
+	},
+	[this](UProceduralMeshComponent* UploadedMesh, const FModumateMeshBuffers& Buffers)
+	{
+		CollisionQueue.SubmitTrimesh(UploadedMesh, OutlineMeshSection);
+		MeshLODs.SetLODSections(UploadedMesh, { OutlineMeshSection }, { SimplifiedOutlineMeshSection });
+	});
 }
 
 
@@ -333,101 +506,32 @@ void UEditManager::GenterateCaseWork(UProceduralMeshComponent* CaseWorkBaseBase,
 	
 	CaseWorkBaseBase->bUseAsyncCooking = true;
 
-	TArray<FVector> vertices;
-	for (int i = 0; i != CaseWorkLines.Num(); i++)
-	{
-		vertices.Add(CaseWorkLines[i]->StartPoint);
-	}
-
-	TArray<int32> triangles = Triangulate(vertices);
-
-	//add thickness here
-	//setting up double sided CaseWork
-	TArray<FVector> topVertices;
+	TArray<FVector> Outline;
+	Outline.Reserve(CaseWorkLines.Num());
 	for (int i = 0; i != CaseWorkLines.Num(); i++)
 	{
-		FVector _i = CaseWorkLines[i]->StartPoint;
-
-		_i.Z = height;
-		topVertices.Add(_i);
-	}
-
-	TArray<int32> bottomTriangle;
-	for (int i = 0; i < triangles.Num(); i++)
-	{
-		bottomTriangle.Add(triangles[(triangles.Num() - 1 - i)] + vertices.Num());
+		Outline.Add(CaseWorkLines[i]->StartPoint);
 	}
 
-	TArray<int32> sides;
-	for (int i = 0; i < vertices.Num(); i++)
+	MeshJobs.Submit(CaseWorkBaseBase, SimplifiedOutlineMeshSection, false, [Outline, height](FModumateMeshBuffers& OutBuffers)
 	{
-		if (i < vertices.Num() - 1)
-		{
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + 1);
-			sides.Add(i);
-
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + (vertices.Num() + 1));
-			sides.Add(i + 1);
-		}
-		else
-		{
-			sides.Add(i + (vertices.Num()));
-			sides.Add(i + 1);
-			sides.Add(i);
-
-			sides.Add(vertices.Num());
-			sides.Add(0);
-			sides.Add(i);
-		}
-	}
-
-	////add verst to vertecies
-	TArray<FVector> AllVerts;
-	for (int i = 0; i != topVertices.Num(); i++)
+		BuildSimplifiedCaseWorkMesh(Outline, height, OutBuffers);
+	},
+	[this](UProceduralMeshComponent* UploadedMesh, const FModumateMeshBuffers& Buffers)
 	{
-		AllVerts.Add(topVertices[i]);
-	}
-	for (int i = 0; i != topVertices.Num(); i++)
-	{
-		AllVerts.Add(vertices[i]);
-	}
-
-
-
-	//add rest of the indeces
-	for (int i = 0; i < sides.Num(); i++)
-	{
-		triangles.Add(sides[i]);
-	}
-
-	for (int i = 0; i < bottomTriangle.Num(); i++)
+		UploadedMesh->SetMaterial(SimplifiedOutlineMeshSection, UploadedMesh->GetMaterial(OutlineMeshSection));
+		MeshLODs.SetLODSections(UploadedMesh, { OutlineMeshSection }, { SimplifiedOutlineMeshSection });
+	});
+	MeshJobs.Submit(CaseWorkBaseBase, OutlineMeshSection, false, [Outline = MoveTemp(Outline), height](FModumateMeshBuffers& OutBuffers)
 	{
-		triangles.Add(bottomTriangle[i]);
-	}
-
-	//setup the rest of the variables
-	//TODO PEYVAN Figure out algo to fix \/
-
-	TArray<FVector> normals;
-	TArray<FVector2D> UV0;
-	TArray<FProcMeshTangent> tangents;
-	TArray<FLinearColor> vertexColors;
-	for (int i = 0; i != triangles.Num(); i++)
+		BuildCaseWorkMesh(Outline, height, OutBuffers);
+	},
+	[this](UProceduralMeshComponent* UploadedMesh, const FModumateMeshBuffers& Buffers)
 	{
-		vertexColors.Add(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f));
-	}
-
-	//TODO PEYVAN Figure out algo to fix /\
-
-	normals.Empty();
-	UV0.Empty();
-	tangents.Empty();
-	//vertexColors.Empty();
-
+		CollisionQueue.SubmitTrimesh(UploadedMesh, OutlineMeshSection);
+		MeshLODs.SetLODSections(UploadedMesh, { OutlineMeshSection }, { SimplifiedOutlineMeshSection });
+	});
 
-	CaseWorkBaseBase->CreateMeshSection_LinearColor(0, AllVerts, triangles, normals, UV0, vertexColors, tangents, true);
 	CaseWorkLines.Empty();
 	CaseworkCompletes.Add(CaseworkGeneratedActor);
 }
@@ -450,15 +554,16 @@ AWall* UEditManager::StartWall(const FVector& WallOrigin)
 
 AWall* UEditManager::FinishWall(const FVector& WallEnd)
 {
+	MODUMATE_STAGE_SCOPE(FinishWall);
+
 	if (!ensureAlways(PendingWall))
 	{
 		return nullptr;
 	}
 
-	TArray<FWallIntersection> Intersections;
-	if (GetIntersectingWalls(PendingWall, Intersections))
+	if (GetIntersectingWalls(PendingWall, PendingWallIntersections))
 	{
-		for (FWallIntersection& Intersection : Intersections)
+		for (FWallIntersection& Intersection : PendingWallIntersections)
 		{
 			UE_LOG(LogTemp, Log, TEXT("Intersection between %s and %s at %s"), *PendingWall->GetName(), *Intersection.HitWall->GetName(), *Intersection.Location.ToString());
 			DrawDebugSphere(GetWorld(), Intersection.Location, 20.0f, 32, FColor::Red, true, 2.0f, 0, 1.0f);
@@ -471,6 +576,10 @@ AWall* UEditManager::FinishWall(const FVector& WallEnd)
 	PendingWall->ID = Walls.Num();
 	PendingWall->SetEndPoint(WallEnd);
 	PendingWall->bPlaced = true;
+	if (PendingWallMesh)
+	{
+		EndWallDrag(PendingWall);
+	}
 
 	Walls.Add(PendingWall);
 
@@ -480,11 +589,13 @@ AWall* UEditManager::FinishWall(const FVector& WallEnd)
 	OnWallMoved(NewWall);
 
 	
-	UpdateRoomsFromWalls();
+	UpdateRoomsFromWalls({ NewWall });
 	
 	
 	UpdateDimensionStringsForInteriorWalls();
 
+	FModumateCounters::SetSceneCounts(Walls.Num(), RoomNodes.Num(), Rooms.Num());
+
 	return NewWall;
 }
 
@@ -495,29 +606,134 @@ void UEditManager::RemoveWall(class AWall* Wall)
 		if (PendingWall == Wall)
 		{
 			PendingWall = nullptr;
+			PendingWallMesh = nullptr;
+			DestroyUnplacedWall(Wall);
+		}
+		else
+		{
+			ensureAlwaysMsgf(false, TEXT("We do not support rebuilding the wall connectivity after deleting fully placed walls!"));
+		}
+	}
+}
 
-			RoomNodes.Remove(Wall->StartNode);
-			Wall->StartNode->Destroy();
+TArray<AWall*> UEditManager::PlaceWalls(const TArray<FVector>& WallStarts, const TArray<FVector>& WallEnds)
+{
+	TArray<AWall*> PlacedWalls;
+	if (!ensureAlways(WallStarts.Num() == WallEnds.Num()))
+	{
+		return PlacedWalls;
+	}
 
-			Wall->WidthDimensionString->Destroy();
-			Wall->HeightDimensionString->Destroy();
-			for (ADimensionStringBase* String : Wall->FixtureDimensionStrings)
-			{
-				String->Destroy();
-			}
-			Wall->FixtureDimensionStrings.Empty();
+	TArray<AWall*> NewWalls;
+	for (int32 WallIndex = 0; WallIndex < WallStarts.Num(); ++WallIndex)
+	{
+		AWall* NewWall = SpawnWall(WallStarts[WallIndex]);
+		NewWall->SetEndPoint(WallEnds[WallIndex]);
+		NewWalls.Add(NewWall);
+	}
+
+	CommitWallBatch(NewWalls, true, PlacedWalls);
+	return PlacedWalls;
+}
+
+void UEditManager::CommitWallBatch(const TArray<AWall*>& NewWalls, bool bRejectCrossingWalls, TArray<AWall*>& OutPlacedWalls)
+{
+	MODUMATE_STAGE_SCOPE(CommitWallBatch);
 
-			RoomNodes.Remove(Wall->EndNode);
-			Wall->EndNode->Destroy();
+	// Sweep over the existing and new walls together, so every crossing is found in one pass instead of one query per wall.
+	int32 NumExistingWalls = Walls.Num();
+	TArray<AWall*> SweptWalls(Walls);
+	SweptWalls.Append(NewWalls);
 
-			Walls.Remove(Wall);
-			Wall->Destroy();
+	TArray<FWallCrossing> Crossings;
+	FWallSweepIntersector::FindAllCrossings(SweptWalls, Crossings);
+
+	// Walls are accepted in batch order, as if they had been placed one at a time with FinishWall.
+	TMultiMap<int32, int32> CrossingsByLaterWall;
+	for (const FWallCrossing& Crossing : Crossings)
+	{
+		if (Crossing.WallIndexB >= NumExistingWalls)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Intersection between %s and %s at %s"), *SweptWalls[Crossing.WallIndexA]->GetName(),
+				*SweptWalls[Crossing.WallIndexB]->GetName(), *Crossing.Intersection.Location.ToString());
+			CrossingsByLaterWall.Add(Crossing.WallIndexB, Crossing.WallIndexA);
 		}
-		else
+	}
+
+	TArray<bool> WallsAccepted;
+	WallsAccepted.Init(true, SweptWalls.Num());
+	for (int32 SweptWallIndex = NumExistingWalls; SweptWallIndex < SweptWalls.Num(); ++SweptWallIndex)
+	{
+		AWall* NewWall = SweptWalls[SweptWallIndex];
+
+		if (bRejectCrossingWalls)
 		{
-			ensureAlwaysMsgf(false, TEXT("We do not support rebuilding the wall connectivity after deleting fully placed walls!"));
+			TArray<int32, TInlineAllocator<4>> CrossedWallIndices;
+			CrossingsByLaterWall.MultiFind(SweptWallIndex, CrossedWallIndices);
+			for (int32 CrossedWallIndex : CrossedWallIndices)
+			{
+				if (WallsAccepted[CrossedWallIndex])
+				{
+					WallsAccepted[SweptWallIndex] = false;
+					break;
+				}
+			}
+
+			if (!WallsAccepted[SweptWallIndex])
+			{
+				DestroyUnplacedWall(NewWall);
+				continue;
+			}
 		}
+
+		NewWall->ID = Walls.Num();
+		NewWall->bPlaced = true;
+		Walls.Add(NewWall);
+		OutPlacedWalls.Add(NewWall);
 	}
+
+	for (AWall* PlacedWall : OutPlacedWalls)
+	{
+		OnWallMoved(PlacedWall);
+	}
+
+	if (OutPlacedWalls.Num() > 0)
+	{
+		UpdateRoomsFromWalls(OutPlacedWalls);
+		UpdateDimensionStringsForInteriorWalls();
+	}
+
+	FModumateCounters::SetSceneCounts(Walls.Num(), RoomNodes.Num(), Rooms.Num());
+}
+
+void UEditManager::DestroyUnplacedWall(AWall* Wall)
+{
+	// Unplaced walls' nodes haven't been merged with any others, so they only belong to this wall
+	WallGraph.RemoveEdge(Wall->GraphEdge);
+	WallGraph.RemoveVertex(Wall->StartNode->GraphVertex);
+	WallGraph.RemoveVertex(Wall->EndNode->GraphVertex);
+
+	RoomNodeHash.RemoveNode(Wall->StartNode);
+	RoomNodes.Remove(Wall->StartNode);
+	Wall->StartNode->Destroy();
+
+	Wall->WidthDimensionString->Destroy();
+	Wall->HeightDimensionString->Destroy();
+	for (ADimensionStringBase* String : Wall->FixtureDimensionStrings)
+	{
+		String->Destroy();
+	}
+	Wall->FixtureDimensionStrings.Empty();
+
+	RoomNodeHash.RemoveNode(Wall->EndNode);
+	RoomNodes.Remove(Wall->EndNode);
+	Wall->EndNode->Destroy();
+
+	WallGrid.RemoveWall(Wall);
+	WallTable.RemoveWall(Wall);
+	WallClusters.RemoveWall(Wall);
+	Walls.Remove(Wall);
+	Wall->Destroy();
 }
 
 AWall* UEditManager::SpawnWall(const FVector& Origin)
@@ -526,26 +742,40 @@ AWall* UEditManager::SpawnWall(const FVector& Origin)
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
 	AWall* NewWall = GetWorld()->SpawnActor<AWall>(WallClass, FTransform(FQuat::Identity, Origin), SpawnParams);
-	NewWall->StartNode = CreateNodeAtPoint(Origin);
-	NewWall->StartNode->ConnectWall(NewWall, true);
-	NewWall->EndNode = CreateNodeAtPoint(Origin);
-	NewWall->EndNode->ConnectWall(NewWall, true);
+	ARoomNode* StartNode = CreateNodeAtPoint(Origin);
+	ARoomNode* EndNode = CreateNodeAtPoint(Origin);
+
+	NewWall->GraphEdge = WallGraph.AddEdge(NewWall, StartNode->GraphVertex, EndNode->GraphVertex);
+	WallGraph.SortVertex(StartNode->GraphVertex);
+	WallGraph.SortVertex(EndNode->GraphVertex);
+
+	SyncWallFromGraph(NewWall);
+	SyncNodeFromGraph(StartNode);
+	SyncNodeFromGraph(EndNode);
 
 	return NewWall;
 }
 
 bool UEditManager::GetIntersectingWalls(AWall* QueryWall, TArray<FWallIntersection>& OutIntersections)
 {
-	// TODO: reduce search space from all walls
-	FWallIntersection TempIntersection;
-	for (AWall* OtherWall : Walls)
+	OutIntersections.Reset();
+
+	// Only test the walls that share grid cells with the query wall
+	CandidateWalls.Reset();
+	WallGrid.QuerySegment(QueryWall->StartPoint, QueryWall->EndPoint, CandidateWalls);
+
+	CandidateSlots.Reset();
+	for (AWall* CandidateWall : CandidateWalls)
 	{
-		if (OtherWall != QueryWall && QueryWall->GetWallIntersection2D(OtherWall, TempIntersection))
+		int32 CandidateSlot = WallTable.FindSlot(CandidateWall);
+		if (CandidateSlot != INDEX_NONE)
 		{
-			OutIntersections.Add(TempIntersection);
+			CandidateSlots.Add(CandidateSlot);
 		}
 	}
 
+	FWallIntersectionKernel::IntersectSlots(WallTable, CandidateSlots, CandidateLanes, QueryWall->StartPoint, QueryWall->EndPoint, OutIntersections, QueryWall);
+
 	OutIntersections.Sort([](const FWallIntersection& A, const FWallIntersection& B) {
 		return A.DistAlongQueryWall < B.DistAlongQueryWall;
 	});
@@ -555,8 +785,11 @@ bool UEditManager::GetIntersectingWalls(AWall* QueryWall, TArray<FWallIntersecti
 
 void UEditManager::OnWallMoved(AWall* ChangedWall)
 {
-	// Search through all existing walls to see if any of them intersect with the changed wall.
-	
+	MODUMATE_STAGE_SCOPE(OnWallMoved);
+
+	// Keep the wall's grid cells up to date, so that intersection queries against it stay correct.
+	WallGrid.AddOrUpdateWall(ChangedWall);
+	WallTable.AddOrUpdateWall(ChangedWall);
 
 	ResetWallConnectivity(ChangedWall);
 }
@@ -568,845 +801,691 @@ bool UEditManager::ResetWallConnectivity(AWall* InWall)
 	bool bChanged = false;
 
 	ARoomNode* InWallStartNode = InWall->StartNode;
+	ARoomNode* InWallEndNode = InWall->EndNode;
+
+	// The wall's nodes may have moved since they were hashed, so re-hash them before searching for nodes to merge with.
+	RoomNodeHash.AddOrUpdateNode(InWallStartNode);
+	RoomNodeHash.AddOrUpdateNode(InWallEndNode);
+	WallGraph.SetVertexPosition(InWallStartNode->GraphVertex, FVector2D(InWallStart));
+	WallGraph.SetVertexPosition(InWallEndNode->GraphVertex, FVector2D(InWallEnd));
+
+	// Merging only changes the graph; the walls and nodes around the merged vertex are refreshed from it below
+	auto MergeNode = [this](ARoomNode* IntoNode, ARoomNode* FromNode) {
+		WallGraph.MergeVertices(IntoNode->GraphVertex, FromNode->GraphVertex);
+		RoomNodeHash.RemoveNode(FromNode);
+		RoomNodes.Remove(FromNode);
+		FromNode->Destroy();
+	};
+
 	if (ARoomNode* ExistingStartNode = FindNodeAtPoint(InWallStart, InWallStartNode))
 	{
-		if (ExistingStartNode->MergeNode(InWallStartNode))
-		{
-			RoomNodes.Remove(InWallStartNode);
-			bChanged = true;
-		}
+		MergeNode(ExistingStartNode, InWallStartNode);
+		bChanged = true;
 	}
 
-	ARoomNode* InWallEndNode = InWall->EndNode;
 	if (ARoomNode* ExistingEndNode = FindNodeAtPoint(InWallEnd, InWallEndNode))
 	{
-		if (ExistingEndNode->MergeNode(InWallEndNode))
-		{
-			RoomNodes.Remove(InWallEndNode);
-			bChanged = true;
-		}
+		MergeNode(ExistingEndNode, InWallEndNode);
+		bChanged = true;
 	}
 
-	for (AWall* ConnectedWall : InWall->StartNode->SortedWalls)
+	// Re-link the half-edges around both of the wall's vertices, then refresh every actor around them from the graph
+	int32 InWallForward = FWallGraph::GetHalfEdge(InWall->GraphEdge, true);
+	int32 InWallBackward = FWallGraph::GetHalfEdge(InWall->GraphEdge, false);
+	for (int32 InWallVertex : { WallGraph.GetOrigin(InWallForward), WallGraph.GetOrigin(InWallBackward) })
 	{
-		if (ConnectedWall->SortConnectedWalls())
-		{
-			bChanged = true;
-		}
-	}
+		WallGraph.SortVertex(InWallVertex);
 
-	for (AWall* ConnectedWall : InWall->EndNode->SortedWalls)
-	{
-		if (ConnectedWall->SortConnectedWalls())
+		const FWallGraphVertex& Vertex = WallGraph.GetVertex(InWallVertex);
+		for (int32 Outgoing : Vertex.OutgoingHalfEdges)
 		{
-			bChanged = true;
+			if (SyncWallFromGraph(WallGraph.GetWall(Outgoing)))
+			{
+				bChanged = true;
+			}
 		}
+
+		SyncNodeFromGraph(Vertex.Node);
 	}
 
 	return bChanged;
 }
 
-
-void UEditManager::GenterateWall(UProceduralMeshComponent* WallMesh, float height, float thickness, AWall* PendingWallActor)
+bool UEditManager::SyncWallFromGraph(AWall* Wall)
 {
+	int32 Forward = FWallGraph::GetHalfEdge(Wall->GraphEdge, true);
+	int32 Backward = FWallGraph::GetHalfEdge(Wall->GraphEdge, false);
 
-	WallMesh->bUseAsyncCooking = true;
-
-	FVector WallDeltaStart = PendingWallActor->EndPoint - PendingWallActor->StartPoint;
-	FVector crosL = FVector::CrossProduct(FVector::UpVector, WallDeltaStart);
+	Wall->StartNode = WallGraph.GetVertex(WallGraph.GetOrigin(Forward)).Node;
+	Wall->EndNode = WallGraph.GetVertex(WallGraph.GetOrigin(Backward)).Node;
 
-	FVector crosLNorm = (crosL).GetUnsafeNormal();
-
-	FVector LeftSideStart	= PendingWallActor->StartPoint	- (thickness * crosLNorm);
-	FVector RightSideStart	= PendingWallActor->StartPoint	+ (thickness * crosLNorm);
-	FVector LeftSideEnd		= PendingWallActor->EndPoint	- (thickness * crosLNorm);
-	FVector RightSideEnd	= PendingWallActor->EndPoint	+ (thickness * crosLNorm);
-	
-	TArray<FVector> vertices;
-	vertices.Add(LeftSideStart);
-	vertices.Add(RightSideStart);
-	vertices.Add(RightSideEnd);
-	vertices.Add(LeftSideEnd);
+	// The neighbors of the wall's outgoing half-edge at each of its nodes; a wall with no neighbors has no connected walls there
+	auto GetNeighborWalls = [this](int32 HalfEdge, AWall*& OutClockwiseWall, AWall*& OutCounterClockwiseWall) {
+		const auto& Outgoing = WallGraph.GetVertex(WallGraph.GetOrigin(HalfEdge)).OutgoingHalfEdges;
+		int32 NumOutgoing = Outgoing.Num();
+		int32 OutgoingIndex = WallGraph.FindOutgoingIndex(HalfEdge);
+		bool bHasNeighbors = (NumOutgoing > 1) && (OutgoingIndex != INDEX_NONE);
 
-	FWallBox currentWall;
+		OutClockwiseWall = bHasNeighbors ? WallGraph.GetWall(Outgoing[(OutgoingIndex + NumOutgoing - 1) % NumOutgoing]) : nullptr;
+		OutCounterClockwiseWall = bHasNeighbors ? WallGraph.GetWall(Outgoing[(OutgoingIndex + 1) % NumOutgoing]) : nullptr;
+	};
 
-	currentWall.b_LeftSideStart		= LeftSideStart;
-	currentWall.b_RightSideStart	= RightSideStart;
-	currentWall.b_LeftSideEnd		= LeftSideEnd;
-	currentWall.b_RightSideEnd		= RightSideEnd;
+	AWall *NewSourceLeftWall, *NewSourceRightWall, *NewDestLeftWall, *NewDestRightWall;
+	GetNeighborWalls(Forward, NewSourceLeftWall, NewSourceRightWall);
+	GetNeighborWalls(Backward, NewDestRightWall, NewDestLeftWall);
 
+	bool bChanged = (Wall->SourceLeftWall != NewSourceLeftWall) || (Wall->SourceRightWall != NewSourceRightWall) ||
+		(Wall->DestLeftWall != NewDestLeftWall) || (Wall->DestRightWall != NewDestRightWall);
 
-	TArray<int32> Triangle;
-	//bottomTriangle
-	Triangle.Add(0);
-	Triangle.Add(2);
-	Triangle.Add(1);
-
-	Triangle.Add(0);
-	Triangle.Add(3);
-	Triangle.Add(2);
-
-	//TopTriangle
-	Triangle.Add(4);
-	Triangle.Add(5);
-	Triangle.Add(6);
-
-	Triangle.Add(4);
-	Triangle.Add(6);
-	Triangle.Add(7);
-
-
-	for (int i = 0; i < vertices.Num(); i++)
+	if (bChanged)
 	{
-		if (i < vertices.Num() - 1)
-		{
-			Triangle.Add(i + (vertices.Num()));
-			Triangle.Add(i);
-			Triangle.Add(i + 1);
-
-			Triangle.Add(i + (vertices.Num()));
-			Triangle.Add(i + 1);
-			Triangle.Add(i + (vertices.Num() + 1));
-		}
-		else
-		{
-			Triangle.Add(i + (vertices.Num()));
-			Triangle.Add(i);
-			Triangle.Add(i + 1);
-
-			Triangle.Add(vertices.Num());
-			Triangle.Add(i);
-			Triangle.Add(0);
-		}
+		Wall->SourceLeftWall = NewSourceLeftWall;
+		Wall->SourceRightWall = NewSourceRightWall;
+		Wall->DestLeftWall = NewDestLeftWall;
+		Wall->DestRightWall = NewDestRightWall;
+		Wall->DebugDrawConnectedWalls();
 	}
 
-	//setup top verts
-	vertices.Add(FVector(LeftSideStart.X,	LeftSideStart.Y,	height * 12.0f * 2.54f));
-	vertices.Add(FVector(RightSideStart.X,	RightSideStart.Y,	height * 12.0f * 2.54f));
-	vertices.Add(FVector(RightSideEnd.X,	RightSideEnd.Y,		height * 12.0f * 2.54f));
-	vertices.Add(FVector(LeftSideEnd.X,		LeftSideEnd.Y,		height * 12.0f * 2.54f));
-
-	currentWall.t_LeftSideStart = FVector(LeftSideStart.X, LeftSideStart.Y, height * 12.0f * 2.54f);
-	currentWall.t_RightSideStart = FVector(RightSideStart.X, RightSideStart.Y, height * 12.0f * 2.54f);
-	currentWall.t_RightSideEnd = FVector(RightSideEnd.X, RightSideEnd.Y, height * 12.0f * 2.54f);
-	currentWall.t_LeftSideEnd = FVector(LeftSideEnd.X, LeftSideEnd.Y, height * 12.0f * 2.54f);
-
-	currentWall.wallVertices = vertices;
-	currentWall.Triangles = Triangle;
-	PendingWallActor->WallBoxes.Add(currentWall);
-
-	////setup the rest of the variables
-	////TODO PEYVAN Figure out algo to fix \/
+	return bChanged;
+}
 
-	TArray<FVector> normals;
-	TArray<FVector2D> UV0;
+void UEditManager::SyncNodeFromGraph(ARoomNode* Node)
+{
+	const FWallGraphVertex& Vertex = WallGraph.GetVertex(Node->GraphVertex);
 
-	for (int i = 0; i < vertices.Num(); i++)
+	Node->SortedWalls.Reset(Vertex.OutgoingHalfEdges.Num());
+	Node->WallIndexMap.Empty(Vertex.OutgoingHalfEdges.Num());
+	for (int32 Outgoing : Vertex.OutgoingHalfEdges)
 	{
-		FVector Vertex = vertices[i];
-		FVector DeltaFromStart = Vertex - PendingWallActor->StartPoint;
-
-		normals.Add(DeltaFromStart.ProjectOnTo(crosLNorm));
-
-		float distanceXY = DeltaFromStart.Size2D();
-		float distanceZ = Vertex.Z;
-
-		UV0.Add(FVector2D(
-			FMath::Abs(0.01f * distanceXY),
-			FMath::Abs(0.01f * distanceZ)
-		));
+		AWall* Wall = WallGraph.GetWall(Outgoing);
+		Node->WallIndexMap.Emplace(Wall, Node->SortedWalls.Add(Wall));
 	}
-	TArray<FProcMeshTangent> tangents;
-	TArray<FLinearColor> vertexColors;
-	//for (int i = 0; i != Triangle.Num(); i++)
-	//{
-	//	FMath::Lerp(PendingWallActor->StartPoint, PendingWallActor->EndPoint, )
-	//	vertexColors.Add(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f));
-	//}
-
-	////TODO PEYVAN Figure out algo to fix /\
-
-	tangents.Empty();
-	vertexColors.Empty();
-
-	PendingWallActor->wallThickness = thickness;
-	PendingWallActor->wallVertices = vertices;
-	WallMesh->CreateMeshSection_LinearColor(0, PendingWallActor->wallVertices, Triangle, normals, UV0, vertexColors, tangents, true);
-	//CaseWorkLines.Empty();
-	//CaseworkCompletes.Add(CaseworkGeneratedActor);
 }
 
-void UEditManager::CutWindowIntoWall(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, FVector Origin, FVector BoxExtend, bool bIsDoor, bool isPreview)
+void UEditManager::SetWallSideRoom(int32 HalfEdge, ARoom* Room)
 {
-	FVector WallDeltaStart = CurrentWallActor->EndPoint - CurrentWallActor->StartPoint;
-	FVector crosL = FVector::CrossProduct(FVector::UpVector, WallDeltaStart);
+	WallGraph.SetFace(HalfEdge, Room ? Room->GraphFace : INDEX_NONE);
 
-	FVector crosLNorm = (crosL).GetUnsafeNormal();
-	WallDeltaStart.Normalize();
-
-	float HighestPoint = 0.0f;
-	for (size_t i = 0; i < CurrentWallActor->wallVertices.Num(); i++)
+	AWall* Wall = WallGraph.GetWall(HalfEdge);
+	if (FWallGraph::IsForward(HalfEdge))
 	{
-		if (HighestPoint < CurrentWallActor->wallVertices[i].Z)
-		{
-			HighestPoint = CurrentWallActor->wallVertices[i].Z;
-		}
+		Wall->LeftRoom = Room;
 	}
-	FVector NewOrigin = FVector::PointPlaneProject(Origin, CurrentWallActor->StartPoint, CurrentWallActor->GetActorRightVector());
-	
-	//Getnew verts
-	//Centerpoint + Unit(0,0,1)*HeightBound + Unit(WallDir)*WidthBound
-	//topright
-	FVector TopEnd = NewOrigin + FVector::UpVector * BoxExtend.Z + WallDeltaStart * BoxExtend.X;
-	//topleft
-	FVector TopStart = NewOrigin + FVector::UpVector * BoxExtend.Z - WallDeltaStart * BoxExtend.X;
-	//bottom right
-	FVector BottomEnd = NewOrigin - FVector::UpVector * BoxExtend.Z + WallDeltaStart * BoxExtend.X;
-	//bottom left
-	FVector BottomStart = NewOrigin - FVector::UpVector * BoxExtend.Z - WallDeltaStart * BoxExtend.X;
-
-	FIntersectionPoints Window;
-	if (FVector::Dist(CurrentWallActor->EndPoint, CurrentWallActor->StartPoint) < FVector::Dist(CurrentWallActor->EndPoint, BottomStart) ||
-		FVector::Dist(CurrentWallActor->EndPoint, CurrentWallActor->StartPoint) < FVector::Dist(CurrentWallActor->StartPoint, BottomEnd))
+	else
 	{
-		TArray<int32> Triangle;
-		CurrentWallActor->wallVertices.Empty();
-
-		for (size_t i = 0; i < CurrentWallActor->WallBoxes.Num(); i++)
-		{
-			TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), 4, Triangle);
-
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideStart);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideEnd);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideStart);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideEnd);
-		}
-
+		Wall->RightRoom = Room;
+	}
+}
 
-		TArray<FVector> normals;
-		TArray<FVector2D> UV0;
 
-		for (int i = 0; i < CurrentWallActor->wallVertices.Num(); i++)
-		{
-			FVector Vertex = CurrentWallActor->wallVertices[i];
-			FVector DeltaFromStart = Vertex - CurrentWallActor->StartPoint;
+namespace
+{
+	const int32 WallMeshSection = 0;
+	const int32 WallPreviewMeshSection = 1;
 
-			normals.Add(DeltaFromStart.ProjectOnTo(crosLNorm));
+	// What a wall's mesh is built from, copied so that it can be built on a worker thread while the wall is edited
+	struct FWallMeshInputs
+	{
+		FVector StartPoint;
+		FVector EndPoint;
+		float HalfThickness;
+		float Height;
+		ModumateCore::FWallOpeningList Openings;
+
+		FWallMeshInputs(const AWall* Wall)
+			: StartPoint(Wall->StartPoint)
+			, EndPoint(Wall->EndPoint)
+			, HalfThickness(Wall->wallThickness)
+			, Height(Wall->wallHeight)
+			, Openings(Wall->Openings)
+		{ }
+	};
+
+	// Each thread meshes walls into its own core buffers, which keep their capacity from one wall to the next
+	struct FWallCoreMesh
+	{
+		std::vector<ModumateCore::FVec3> Vertices;
+		std::vector<ModumateCore::FVec3> Normals;
+		std::vector<int32_t> Indices;
+	};
 
-			float distanceXY = DeltaFromStart.Size2D();
-			float distanceZ = Vertex.Z;
+	thread_local FWallCoreMesh ThreadWallCoreMesh;
 
-			UV0.Add(FVector2D(
-				FMath::Abs(0.01f * distanceXY),
-				FMath::Abs(0.01f * distanceZ)
-			));
+	// Copies a core wall mesh into engine buffers, shaded by the surface kernel like floors and casework
+	void CopyWallMesh(const FWallCoreMesh& CoreMesh, FModumateMeshBuffers& OutBuffers)
+	{
+		int32 NumVertices = static_cast<int32>(CoreMesh.Vertices.size());
+		OutBuffers.Reset();
+		OutBuffers.Vertices.Reserve(NumVertices);
+		for (const ModumateCore::FVec3& Vertex : CoreMesh.Vertices)
+		{
+			OutBuffers.Vertices.Add(FromCore(Vertex));
 		}
 
-		TArray<FProcMeshTangent> tangents;
-		TArray<FLinearColor> vertexColors;
-		//for (int i = 0; i != Triangle.Num(); i++)
-		//{
-		//	vertexColors.Add(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f));
-		//}
-
-		////TODO PEYVAN Figure out algo to fix /\
+		OutBuffers.Triangles.Append(CoreMesh.Indices.data(), static_cast<int32>(CoreMesh.Indices.size()));
+		OutBuffers.ComputeFlatSurface();
+	}
 
-		tangents.Empty();
-		vertexColors.Empty();
+	// Previews are meshed on the game thread, into buffers that keep their capacity from one preview to the next
+	FModumateMeshBuffers WallPreviewBuffers;
 
-		WallMesh->CreateMeshSection_LinearColor(0, CurrentWallActor->wallVertices, Triangle, normals, UV0, vertexColors, tangents, true);
+	// How far a dragged wall can turn, about a degree, before its normals, UVs and tangents are sent again along with its vertices
+	const float DragSurfaceMinCos = 0.9998f;
 
+	void CreateWallSection(UProceduralMeshComponent* WallMesh, int32 SectionIndex, const FModumateMeshBuffers& Buffers, bool bCreateCollision)
+	{
+		WallMesh->CreateMeshSection_LinearColor(SectionIndex, Buffers.Vertices, Buffers.Triangles, Buffers.Normals, Buffers.UV0,
+			Buffers.VertexColors, Buffers.Tangents, bCreateCollision);
+		FModumateCounters::AddTrianglesEmitted(Buffers.Triangles.Num() / 3);
 	}
-	else
+
+	// Uploads a section without collision, only sending its vertices again if it has the same triangles as before, as it does
+	// while an opening slides within its gap or a wall is dragged. Returns whether the section had to be created instead.
+	bool StreamWallSection(UProceduralMeshComponent* WallMesh, int32 SectionIndex, const FModumateMeshBuffers& Buffers)
 	{
+		const FProcMeshSection* Section = WallMesh->GetProcMeshSection(SectionIndex);
+		const TArray<int32>& Triangles = Buffers.Triangles;
+		bool bSameTriangles = Section && !Section->bEnableCollision && (Section->ProcVertexBuffer.Num() == Buffers.Vertices.Num()) &&
+			(Section->ProcIndexBuffer.Num() == Triangles.Num()) &&
+			(FMemory::Memcmp(Section->ProcIndexBuffer.GetData(), Triangles.GetData(), Triangles.Num() * sizeof(int32)) == 0);
 
-		if (FVector::Dist(CurrentWallActor->StartPoint, BottomStart) < FVector::Dist(CurrentWallActor->StartPoint, BottomEnd))
-		{
-			Window.b_LeftSideStart = BottomStart - (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_RightSideStart = BottomStart + (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_LeftSideEnd = BottomEnd - (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_RightSideEnd = BottomEnd + (CurrentWallActor->wallThickness * crosLNorm);
-
-			Window.t_LeftSideStart = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, (HighestPoint < Window.b_LeftSideStart.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_LeftSideStart.Z + BoxExtend.Z * 2);
-			Window.t_RightSideStart = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, (HighestPoint < Window.b_RightSideStart.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_RightSideStart.Z + BoxExtend.Z * 2);
-			Window.t_LeftSideEnd = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, (HighestPoint < Window.b_LeftSideEnd.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_LeftSideEnd.Z + BoxExtend.Z * 2);
-			Window.t_RightSideEnd = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, (HighestPoint < Window.b_RightSideEnd.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_RightSideEnd.Z + BoxExtend.Z * 2);
-		}
-		else
+		if (bSameTriangles)
 		{
-			Window.b_LeftSideStart = BottomStart - (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_RightSideStart = BottomStart + (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_LeftSideEnd = BottomEnd - (CurrentWallActor->wallThickness * crosLNorm);
-			Window.b_RightSideEnd = BottomEnd + (CurrentWallActor->wallThickness * crosLNorm);
-
-			Window.t_LeftSideStart = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, (HighestPoint < Window.b_LeftSideStart.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_LeftSideStart.Z + BoxExtend.Z * 2);
-			Window.t_RightSideStart = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, (HighestPoint < Window.b_RightSideStart.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_RightSideStart.Z + BoxExtend.Z * 2);
-			Window.t_LeftSideEnd = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, (HighestPoint < Window.b_LeftSideEnd.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_LeftSideEnd.Z + BoxExtend.Z * 2);
-			Window.t_RightSideEnd = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, (HighestPoint < Window.b_RightSideEnd.Z + BoxExtend.Z * 2) ? HighestPoint : Window.b_RightSideEnd.Z + BoxExtend.Z * 2);
+			WallMesh->UpdateMeshSection_LinearColor(SectionIndex, Buffers.Vertices, Buffers.Normals, Buffers.UV0, Buffers.VertexColors, Buffers.Tangents);
+			return false;
 		}
 
-		//CurrentWallActor->intersections.Add(Window);
-
-		/*TArray<FVector> BLintersectionPoints;
-		TArray<FVector> BRintersectionPoints;
-		TArray<FVector> TLintersectionPoints;
-		TArray<FVector> TRintersectionPoints;*/
-		TArray<int32> Triangle;
-
-		CurrentWallActor->wallVertices.Empty();
+		CreateWallSection(WallMesh, SectionIndex, Buffers, false);
+		return true;
+	}
 
-		if (CurrentWallActor->WallBoxes.Num() > 1)
+	// Walls collide as a box per solid part around their openings, which is much cheaper to cook and query than their triangles
+	void GetWallCollisionBoxes(const FWallMeshInputs& Inputs, TArray<TArray<FVector>>& OutConvexes)
+	{
+		FVector Axis = Inputs.EndPoint - Inputs.StartPoint;
+		float WallLength = Axis.Size();
+		FVector Right = FVector::CrossProduct(FVector::UpVector, Axis).GetSafeNormal();
+		if (WallLength <= 0.0f || Right.IsZero())
 		{
-			int i_currentLocalVertSize = 4;
-			TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-			bool triggered = false;
-
-			TArray<FWallBox> newWallBoxList;
+			return;
+		}
 
+		FVector Dir = Axis / WallLength;
+		std::vector<ModumateCore::FWallSolidBox> SolidBoxes;
+		ModumateCore::GetWallSolidBoxes(Inputs.Openings, WallLength, Inputs.Height, SolidBoxes);
 
-			//for loop here
-			for (size_t i = 0; i < CurrentWallActor->WallBoxes.Num(); i++)
+		OutConvexes.Reserve(static_cast<int32>(SolidBoxes.size()));
+		for (const ModumateCore::FWallSolidBox& Box : SolidBoxes)
+		{
+			TArray<FVector>& Corners = OutConvexes.AddDefaulted_GetRef();
+			for (float U : { Box.Start, Box.End })
 			{
-				if (triggered || FVector::Dist(CurrentWallActor->WallBoxes[i].b_LeftSideStart, CurrentWallActor->WallBoxes[i].b_LeftSideEnd) > FVector::Dist(CurrentWallActor->WallBoxes[i].b_LeftSideStart, Window.b_LeftSideEnd))
+				for (float Side : { -1.0f, 1.0f })
 				{
-
-					//get box effected and modify it into 4 boxes. 
-					if (!triggered)
+					for (float Z : { Box.Bottom, Box.Top })
 					{
+						Corners.Add(Inputs.StartPoint + Dir * U + Right * (Side * Inputs.HalfThickness) + FVector::UpVector * Z);
+					}
+				}
+			}
+		}
+	}
+}
 
-#pragma region Starting Wall
-						FWallBox _startingWall;
-
-						_startingWall.b_LeftSideStart = CurrentWallActor->WallBoxes[i].b_LeftSideStart;
-						_startingWall.b_RightSideStart = CurrentWallActor->WallBoxes[i].b_RightSideStart;
-						_startingWall.b_LeftSideEnd = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, 0);
-						_startingWall.b_RightSideEnd = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, 0);
-
-						_startingWall.t_LeftSideStart = CurrentWallActor->WallBoxes[i].t_LeftSideStart;
-						_startingWall.t_RightSideStart = CurrentWallActor->WallBoxes[i].t_RightSideStart;
-						_startingWall.t_LeftSideEnd = FVector(Window.t_LeftSideStart.X, Window.t_LeftSideStart.Y, CurrentWallActor->WallBoxes[i].t_LeftSideStart.Z);
-						_startingWall.t_RightSideEnd = FVector(Window.t_RightSideStart.X, Window.t_RightSideStart.Y, CurrentWallActor->WallBoxes[i].t_LeftSideStart.Z);
-
-						_startingWall.AddVerts();
-
-						//getTriangles here
-
-
-						TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-						CurrentWallActor->wallVertices.Add(_startingWall.b_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_startingWall.b_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_startingWall.b_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_startingWall.b_LeftSideEnd);
-						CurrentWallActor->wallVertices.Add(_startingWall.t_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_startingWall.t_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_startingWall.t_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_startingWall.t_LeftSideEnd);
-
-
-#pragma endregion
-
-#pragma region MiddleTop Box
-						FWallBox _middleWallTop;
-						_middleWallTop.b_LeftSideStart = Window.t_LeftSideStart;
-						_middleWallTop.b_RightSideStart = Window.t_RightSideStart;
-						_middleWallTop.b_LeftSideEnd = Window.t_LeftSideEnd;
-						_middleWallTop.b_RightSideEnd = Window.t_RightSideEnd;
-
-						_middleWallTop.t_LeftSideStart = FVector(Window.t_LeftSideStart.X, Window.t_LeftSideStart.Y, CurrentWallActor->WallBoxes[i].t_LeftSideStart.Z);
-						_middleWallTop.t_RightSideStart = FVector(Window.t_RightSideStart.X, Window.t_RightSideStart.Y, CurrentWallActor->WallBoxes[i].t_LeftSideStart.Z);
-						_middleWallTop.t_LeftSideEnd = FVector(Window.t_LeftSideEnd.X, Window.t_LeftSideEnd.Y, CurrentWallActor->WallBoxes[i].t_LeftSideEnd.Z);
-						_middleWallTop.t_RightSideEnd = FVector(Window.t_RightSideEnd.X, Window.t_RightSideEnd.Y, CurrentWallActor->WallBoxes[i].t_LeftSideEnd.Z);
-
-						_middleWallTop.AddVerts();
-
-						//getTriangles here
-
-						TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-
-						CurrentWallActor->wallVertices.Add(_middleWallTop.b_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.b_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.b_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.b_LeftSideEnd);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.t_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.t_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.t_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_middleWallTop.t_LeftSideEnd);
-
-
-
-#pragma endregion
-
-#pragma region MiddleBottomBox
-						FWallBox _middleWallBottom;
-						if (!bIsDoor)
-						{
-
-							_middleWallBottom.b_LeftSideStart = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, 0);
-							_middleWallBottom.b_RightSideStart = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, 0);
-							_middleWallBottom.b_LeftSideEnd = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, 0);
-							_middleWallBottom.b_RightSideEnd = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, 0);
-
-							_middleWallBottom.t_LeftSideStart = Window.b_LeftSideStart;
-							_middleWallBottom.t_RightSideStart = Window.b_RightSideStart;
-							_middleWallBottom.t_LeftSideEnd = Window.b_LeftSideEnd;
-							_middleWallBottom.t_RightSideEnd = Window.b_RightSideEnd;
-							_middleWallBottom.AddVerts();
+void UEditManager::GenterateWall(UProceduralMeshComponent* WallMesh, float height, float thickness, AWall* PendingWallActor)
+{
+	MODUMATE_STAGE_SCOPE(GenerateWall);
 
-							//getTriangles here
 
-							TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
+	WallMesh->bUseAsyncCooking = true;
 
+	// Regenerating a wall keeps its openings; any that no longer fit in it are left out of the mesh
+	PendingWallActor->wallThickness = thickness;
+	PendingWallActor->wallHeight = height * 12.0f * 2.54f;
+	UpdateWallMesh(WallMesh, PendingWallActor);
+	//CaseWorkLines.Empty();
+	//CaseworkCompletes.Add(CaseworkGeneratedActor);
+}
 
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.b_LeftSideStart);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.b_RightSideStart);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.b_RightSideEnd);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.b_LeftSideEnd);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.t_LeftSideStart);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.t_RightSideStart);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.t_RightSideEnd);
-							CurrentWallActor->wallVertices.Add(_middleWallBottom.t_LeftSideEnd);
-						}
+void UEditManager::BeginWallDrag(UProceduralMeshComponent* WallMesh, float height, float thickness)
+{
+	if (!ensureAlways(PendingWall))
+	{
+		return;
+	}
 
-#pragma endregion
+	// Nothing collides with the wall while it's dragged, so moving it doesn't update physics or overlaps, and nothing is cooked
+	WallMesh->bUseAsyncCooking = true;
+	PendingWallMesh = WallMesh;
+	PendingWallSurfaceDir = FVector::ZeroVector;
+	PendingWall->SetActorEnableCollision(false);
+	PendingWall->wallThickness = thickness;
+	PendingWall->wallHeight = height * 12.0f * 2.54f;
+	MeshJobs.Cancel(WallMesh);
+}
 
-#pragma region EndWall
+void UEditManager::DragWall(const FVector& WallEnd)
+{
+	MODUMATE_STAGE_SCOPE(GenerateWall);
 
-						FWallBox _endingWall;
+	if (!ensureAlways(PendingWall && PendingWallMesh))
+	{
+		return;
+	}
 
-						_endingWall.b_LeftSideStart = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, 0);
-						_endingWall.b_RightSideStart = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, 0);
-						_endingWall.b_LeftSideEnd = CurrentWallActor->WallBoxes[i].b_LeftSideEnd;
-						_endingWall.b_RightSideEnd = CurrentWallActor->WallBoxes[i].b_RightSideEnd;
+	// The actor itself is only moved into place once, by FinishWall
+	PendingWall->DragEndPoint(WallEnd);
+
+	// Without welding, stretching the wall only moves its vertices, so while it keeps its triangles and its direction, only their
+	// positions are sent. Its normals, UVs and tangents are left as they were until it turns, or is rebuilt once it's finished.
+	ModumateCore::BuildWallMesh(ToCore(PendingWall->StartPoint), ToCore(PendingWall->EndPoint), PendingWall->wallThickness, PendingWall->wallHeight,
+		PendingWall->Openings, ThreadWallCoreMesh.Vertices, ThreadWallCoreMesh.Normals, ThreadWallCoreMesh.Indices, false);
+	const std::vector<int32_t>& Indices = ThreadWallCoreMesh.Indices;
+	const FProcMeshSection* Section = PendingWallMesh->GetProcMeshSection(WallMeshSection);
+	FVector DragDir = (PendingWall->EndPoint - PendingWall->StartPoint).GetSafeNormal2D();
+	bool bOnlyPositions = Section && !Section->bEnableCollision && ((DragDir | PendingWallSurfaceDir) >= DragSurfaceMinCos) &&
+		(Section->ProcVertexBuffer.Num() == static_cast<int32>(ThreadWallCoreMesh.Vertices.size())) &&
+		(Section->ProcIndexBuffer.Num() == static_cast<int32>(Indices.size())) &&
+		(FMemory::Memcmp(Section->ProcIndexBuffer.GetData(), Indices.data(), Indices.size() * sizeof(int32)) == 0);
+
+	PendingWall->GeneratedMesh = PendingWallMesh;
+	if (bOnlyPositions)
+	{
+		WallPreviewBuffers.Vertices.Reset();
+		for (const ModumateCore::FVec3& Vertex : ThreadWallCoreMesh.Vertices)
+		{
+			WallPreviewBuffers.Vertices.Add(FromCore(Vertex));
+		}
+		PendingWallMesh->UpdateMeshSection_LinearColor(WallMeshSection, WallPreviewBuffers.Vertices,
+			TArray<FVector>(), TArray<FVector2D>(), TArray<FLinearColor>(), TArray<FProcMeshTangent>());
+	}
+	else
+	{
+		CopyWallMesh(ThreadWallCoreMesh, WallPreviewBuffers);
+		StreamWallSection(PendingWallMesh, WallMeshSection, WallPreviewBuffers);
+		PendingWallSurfaceDir = DragDir;
+	}
+	PendingWall->wallVertices = WallPreviewBuffers.Vertices;
+}
 
+void UEditManager::EndWallDrag(AWall* Wall)
+{
+	// The dragged mesh is replaced by the wall's welded one, and its collision is only cooked once editing is idle
+	Wall->SetActorEnableCollision(true);
+	UpdateWallMesh(PendingWallMesh, Wall);
+	PendingWallMesh = nullptr;
+}
 
-						_endingWall.t_LeftSideStart = FVector(Window.t_LeftSideEnd.X, Window.t_LeftSideEnd.Y, HighestPoint);
-						_endingWall.t_RightSideStart = FVector(Window.t_RightSideEnd.X, Window.t_RightSideEnd.Y, HighestPoint);
-						_endingWall.t_LeftSideEnd = CurrentWallActor->WallBoxes[i].t_LeftSideEnd;
-						_endingWall.t_RightSideEnd = CurrentWallActor->WallBoxes[i].t_RightSideEnd;
+int32 UEditManager::CutWindowIntoWall(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, FVector Origin, FVector BoxExtend, bool bIsDoor, bool isPreview)
+{
+	MODUMATE_STAGE_SCOPE(CutWindowIntoWall);
 
-						_endingWall.AddVerts();
+	ModumateCore::FWallOpening Opening = MakeWallOpening(CurrentWallActor, Origin, BoxExtend, bIsDoor);
+	float WallLength = FVector::Dist(CurrentWallActor->StartPoint, CurrentWallActor->EndPoint);
 
+	// Previews don't change the wall's openings; the full cut only happens once the opening is committed
+	if (isPreview)
+	{
+		if (CurrentWallActor->Openings.CanPlace(Opening, WallLength))
+		{
+			UpdateWallPreview(WallMesh, CurrentWallActor, Opening);
+		}
+		else
+		{
+			ClearWallOpeningPreview(WallMesh, CurrentWallActor);
+		}
+		return INDEX_NONE;
+	}
 
-						//getTriangles here
+	int32 OpeningID = CurrentWallActor->Openings.Add(Opening, WallLength);
+	UpdateWallMesh(WallMesh, CurrentWallActor);
+	return OpeningID;
+}
 
-						TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
+bool UEditManager::MoveWallOpening(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, int32 OpeningID, FVector Origin, FVector BoxExtend, bool bIsDoor)
+{
+	MODUMATE_STAGE_SCOPE(CutWindowIntoWall);
 
+	ModumateCore::FWallOpening Opening = MakeWallOpening(CurrentWallActor, Origin, BoxExtend, bIsDoor);
+	float WallLength = FVector::Dist(CurrentWallActor->StartPoint, CurrentWallActor->EndPoint);
+	if (!CurrentWallActor->Openings.Move(OpeningID, Opening, WallLength))
+	{
+		return false;
+	}
 
-						CurrentWallActor->wallVertices.Add(_endingWall.b_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_endingWall.b_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_endingWall.b_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_endingWall.b_LeftSideEnd);
-						CurrentWallActor->wallVertices.Add(_endingWall.t_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(_endingWall.t_RightSideStart);
-						CurrentWallActor->wallVertices.Add(_endingWall.t_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(_endingWall.t_LeftSideEnd);
+	UpdateWallMesh(WallMesh, CurrentWallActor);
+	return true;
+}
 
-#pragma endregion 
+bool UEditManager::RemoveWallOpening(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, int32 OpeningID)
+{
+	MODUMATE_STAGE_SCOPE(CutWindowIntoWall);
 
-						if (!isPreview)
-						{
-							newWallBoxList.Add(_startingWall);
-							newWallBoxList.Add(_middleWallTop);
-							if (!bIsDoor)
-							{
-								newWallBoxList.Add(_middleWallBottom);
-							}
-							newWallBoxList.Add(_endingWall);
-						}
-					}
-					else
-					{
-						TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideStart);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideEnd);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideStart);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideStart);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideEnd);
-						CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideEnd);
-						newWallBoxList.Add(CurrentWallActor->WallBoxes[i]);
-					}
+	if (!CurrentWallActor->Openings.Remove(OpeningID))
+	{
+		return false;
+	}
 
+	UpdateWallMesh(WallMesh, CurrentWallActor);
+	return true;
+}
 
-					//add back in the rest of the boxes with modified values
+void UEditManager::ClearWallOpeningPreview(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor)
+{
+	if (CurrentWallActor->bPreviewingOpening)
+	{
+		MODUMATE_STAGE_SCOPE(CutWindowIntoWall);
+		UpdateWallMesh(WallMesh, CurrentWallActor);
+	}
+}
 
-					//triangulate and add verts to 
+ModumateCore::FWallOpening UEditManager::MakeWallOpening(const AWall* Wall, const FVector& Origin, const FVector& BoxExtend, bool bIsDoor) const
+{
+	// The opening is centered on the origin projected onto the wall, and doors reach all the way down to its base
+	FVector NewOrigin = FVector::PointPlaneProject(Origin, Wall->StartPoint, Wall->GetActorRightVector());
+	FVector WallDir = (Wall->EndPoint - Wall->StartPoint).GetSafeNormal();
+	float Center = FVector::DotProduct(NewOrigin - Wall->StartPoint, WallDir);
+	float Bottom = NewOrigin.Z - BoxExtend.Z - Wall->StartPoint.Z;
+
+	ModumateCore::FWallOpening Opening;
+	Opening.ID = INDEX_NONE;
+	Opening.Start = Center - BoxExtend.X;
+	Opening.End = Center + BoxExtend.X;
+	Opening.SillHeight = bIsDoor ? 0.0f : Bottom;
+	Opening.HeadHeight = FMath::Min(Bottom + 2.0f * BoxExtend.Z, Wall->wallHeight);
+	return Opening;
+}
 
-					//break;
-					triggered = true;
-				}
-				else
+void UEditManager::UpdateWallMesh(UProceduralMeshComponent* WallMesh, AWall* Wall)
+{
+	// The wall is remeshed on a worker thread, and any preview stays up until the new mesh replaces it.
+	// Its collision is a box per solid part, queued once it's uploaded, rather than cooked from the mesh.
+	Wall->GeneratedMesh = WallMesh;
+	FWallMeshInputs WallInputs(Wall);
+	TArray<TArray<FVector>> CollisionBoxes;
+	GetWallCollisionBoxes(WallInputs, CollisionBoxes);
+	MeshJobs.Submit(WallMesh, WallMeshSection, false,
+		[Inputs = MoveTemp(WallInputs)](FModumateMeshBuffers& OutBuffers)
+		{
+			ModumateCore::BuildWallMesh(ToCore(Inputs.StartPoint), ToCore(Inputs.EndPoint), Inputs.HalfThickness, Inputs.Height,
+				Inputs.Openings, ThreadWallCoreMesh.Vertices, ThreadWallCoreMesh.Normals, ThreadWallCoreMesh.Indices);
+			CopyWallMesh(ThreadWallCoreMesh, OutBuffers);
+		},
+		[this, WeakWall = TWeakObjectPtr<AWall>(Wall), CollisionBoxes = MoveTemp(CollisionBoxes)](UProceduralMeshComponent* UploadedMesh, const FModumateMeshBuffers& Buffers)
+		{
+			CollisionQueue.SubmitConvexes(UploadedMesh, CollisionBoxes);
+			if (AWall* UploadedWall = WeakWall.Get())
+			{
+				UploadedWall->wallVertices = Buffers.Vertices;
+				if (UploadedWall->bPreviewingOpening)
 				{
-					//add unmodified box to verts and triangulate
-
-					TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideStart);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideStart);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_RightSideEnd);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].b_LeftSideEnd);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideStart);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideStart);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_RightSideEnd);
-					CurrentWallActor->wallVertices.Add(CurrentWallActor->WallBoxes[i].t_LeftSideEnd);
-
-
-					if (!isPreview)
-					{
-						newWallBoxList.Add(CurrentWallActor->WallBoxes[i]);
-					}
+					UploadedMesh->ClearMeshSection(WallPreviewMeshSection);
+					UploadedWall->bPreviewingOpening = false;
 				}
 
-
-			}
-
-			if (!isPreview)
-			{
-				CurrentWallActor->WallBoxes.Empty();
-
-				for (size_t i = 0; i < newWallBoxList.Num(); i++)
+				// Once a placed wall's mesh is up to date, its cluster can draw it again
+				if (UploadedWall->bPlaced && (UploadedWall->GeneratedMesh == UploadedMesh))
 				{
-					CurrentWallActor->WallBoxes.Add(newWallBoxList[i]);
+					WallClusters.SetWallEditing(UploadedWall, false);
+					WallClusters.AddOrUpdateWall(UploadedWall);
 				}
 			}
+		});
+}
 
-			//clearBoxList and add new stuff
-
-
-
-
-
-
-
-		}
-		else
+void UEditManager::UpdateWallPreview(UProceduralMeshComponent* WallMesh, AWall* Wall, const ModumateCore::FWallOpening& Opening)
+{
+	float WallLength = FVector::Dist(Wall->StartPoint, Wall->EndPoint);
+	float SpanStart, SpanEnd;
+	Wall->Openings.GetGapAround(0.5f * (Opening.Start + Opening.End), WallLength, SpanStart, SpanEnd);
+
+	// Previews follow the cursor, so they're meshed right away, replacing any remeshing of the wall that hasn't been uploaded yet.
+	// The rest of the wall is only remeshed when the preview moves into another gap, or the wall has changed, and neither is cooked;
+	// the wall's collision boxes only change with it, and are queued again if the build that had them was dropped.
+	bool bDroppedBuild = MeshJobs.Cancel(WallMesh);
+	Wall->GeneratedMesh = WallMesh;
+	WallClusters.SetWallEditing(Wall, true);
+	if (bDroppedBuild || !Wall->bPreviewingOpening || (SpanStart != Wall->PreviewSpanStart) || (SpanEnd != Wall->PreviewSpanEnd))
+	{
+		ModumateCore::BuildWallMeshAroundSpan(ToCore(Wall->StartPoint), ToCore(Wall->EndPoint), Wall->wallThickness, Wall->wallHeight,
+			Wall->Openings, SpanStart, SpanEnd, ThreadWallCoreMesh.Vertices, ThreadWallCoreMesh.Normals, ThreadWallCoreMesh.Indices);
+		CopyWallMesh(ThreadWallCoreMesh, WallPreviewBuffers);
+		CreateWallSection(WallMesh, WallMeshSection, WallPreviewBuffers, false);
+		Wall->wallVertices = WallPreviewBuffers.Vertices;
+		if (bDroppedBuild)
 		{
+			TArray<TArray<FVector>> CollisionBoxes;
+			GetWallCollisionBoxes(FWallMeshInputs(Wall), CollisionBoxes);
+			CollisionQueue.SubmitConvexes(WallMesh, CollisionBoxes);
+		}
 
-#pragma region Starting Wall
-			FWallBox _startingWall;
-
-			_startingWall.b_LeftSideStart = CurrentWallActor->WallBoxes[0].b_LeftSideStart;
-			_startingWall.b_RightSideStart = CurrentWallActor->WallBoxes[0].b_RightSideStart;
-			_startingWall.b_LeftSideEnd = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, 0);
-			_startingWall.b_RightSideEnd = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, 0);
-
-			_startingWall.t_LeftSideStart = CurrentWallActor->WallBoxes[0].t_LeftSideStart;
-			_startingWall.t_RightSideStart = CurrentWallActor->WallBoxes[0].t_RightSideStart;
-			_startingWall.t_LeftSideEnd = FVector(Window.t_LeftSideStart.X, Window.t_LeftSideStart.Y, CurrentWallActor->WallBoxes[0].t_LeftSideStart.Z);
-			_startingWall.t_RightSideEnd = FVector(Window.t_RightSideStart.X, Window.t_RightSideStart.Y, CurrentWallActor->WallBoxes[0].t_LeftSideStart.Z);
-
-			_startingWall.AddVerts();
-
-			//getTriangles here
-			//bottomTriangle
+		WallMesh->ClearMeshSection(WallPreviewMeshSection);
+		Wall->bPreviewingOpening = true;
+		Wall->PreviewSpanStart = SpanStart;
+		Wall->PreviewSpanEnd = SpanEnd;
+	}
 
-			int i_currentLocalVertSize = 4;
-			TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
+	ModumateCore::BuildWallSpanMesh(ToCore(Wall->StartPoint), ToCore(Wall->EndPoint), Wall->wallThickness, Wall->wallHeight,
+		Wall->Openings, SpanStart, SpanEnd, &Opening, ThreadWallCoreMesh.Vertices, ThreadWallCoreMesh.Normals, ThreadWallCoreMesh.Indices);
+	CopyWallMesh(ThreadWallCoreMesh, WallPreviewBuffers);
+	if (StreamWallSection(WallMesh, WallPreviewMeshSection, WallPreviewBuffers))
+	{
+		WallMesh->SetMaterial(WallPreviewMeshSection, WallMesh->GetMaterial(WallMeshSection));
+	}
+}
 
+void UEditManager::UpdateRoomsFromWalls()
+{
+	MODUMATE_STAGE_SCOPE(UpdateRooms);
 
-			CurrentWallActor->wallVertices.Add(_startingWall.b_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_startingWall.b_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_startingWall.b_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_startingWall.b_LeftSideEnd);
-			CurrentWallActor->wallVertices.Add(_startingWall.t_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_startingWall.t_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_startingWall.t_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_startingWall.t_LeftSideEnd);
+	// Every planar graph has at least one region: the outer region, which encompasses the whole graph.
+	// Every other region of the planar graph will be described by a list of edges, traversed counter-clockwise.
+	// Each edge of the graph is therefore adjacent to two regions of the graph.
 
+	// We need enough walls for a planar graph.
+	if (Walls.Num() == 0)
+	{
+		return;
+	}
 
-#pragma endregion
+	UE_LOG(LogTemp, Log, TEXT("Searching rooms..."));
 
-#pragma region MiddleTop Box
-			FWallBox _middleWallTop;
-			_middleWallTop.b_LeftSideStart = Window.t_LeftSideStart;
-			_middleWallTop.b_RightSideStart = Window.t_RightSideStart;
-			_middleWallTop.b_LeftSideEnd = Window.t_LeftSideEnd;
-			_middleWallTop.b_RightSideEnd = Window.t_RightSideEnd;
+	TSet<ARoom*> DirtyRooms(Rooms);				// The set of rooms that need to be updated, or removed if they are invalid.
 
-			_middleWallTop.t_LeftSideStart = FVector(Window.t_LeftSideStart.X, Window.t_LeftSideStart.Y, HighestPoint);
-			_middleWallTop.t_RightSideStart = FVector(Window.t_RightSideStart.X, Window.t_RightSideStart.Y, HighestPoint);
-			_middleWallTop.t_LeftSideEnd = FVector(Window.t_LeftSideEnd.X, Window.t_LeftSideEnd.Y, HighestPoint);
-			_middleWallTop.t_RightSideEnd = FVector(Window.t_RightSideEnd.X, Window.t_RightSideEnd.Y, HighestPoint);
+	// Clear out room references for all walls, since every room will be recreated
+	for (AWall* Wall : Walls)
+	{
+		SetWallSideRoom(FWallGraph::GetHalfEdge(Wall->GraphEdge, true), nullptr);
+		SetWallSideRoom(FWallGraph::GetHalfEdge(Wall->GraphEdge, false), nullptr);
+	}
 
-			_middleWallTop.AddVerts();
-			//getTriangles here
-			TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
+	TArray<ARoom*> TracedRooms;
+	bool bTracedRooms = TraceRoomsFromWalls(Walls, DirtyRooms, TracedRooms);
+	ensureAlwaysMsgf(bTracedRooms, TEXT("Failed to trace all of the rooms from the walls!"));
 
+	// TODO: if room data has changed, then update existing rooms that share data.
+	// For now, just create new rooms if data has changed, and destroy rooms that are no longer valid.
+	for (ARoom* DirtyRoom : DirtyRooms)
+	{
+		DestroyRoom(DirtyRoom);
+	}
 
-			CurrentWallActor->wallVertices.Add(_middleWallTop.b_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.b_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.b_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.b_LeftSideEnd);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.t_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.t_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.t_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_middleWallTop.t_LeftSideEnd);
+	TArray<ARoom*> DirtyFloorRooms;
+	UpdateRoomHoles(TracedRooms, DirtyFloorRooms);
+	TriangulateDirtyRooms(DirtyFloorRooms);
 
+	UE_LOG(LogTemp, Log, TEXT("... Done searching rooms. There are now %d total rooms."), Rooms.Num());
 
+}
 
-#pragma endregion
+void UEditManager::UpdateRoomsFromWalls(const TArray<AWall*>& ChangedWalls)
+{
+	MODUMATE_STAGE_SCOPE(UpdateRooms);
+
+	// Adding or moving a wall can only change the rooms that pass through its nodes;
+	// every other room keeps its walls, so only the dirty rooms' sides need to be traced again.
+	TSet<ARoom*> DirtyRooms;
+	TSet<AWall*> SeedWallSet;
+	TArray<AWall*> SeedWalls;
+
+	auto AddSeedWall = [&SeedWallSet, &SeedWalls](AWall* Wall) {
+		bool bAlreadySeeded = false;
+		SeedWallSet.Add(Wall, &bAlreadySeeded);
+		if (!bAlreadySeeded)
+		{
+			SeedWalls.Add(Wall);
+		}
+	};
 
-#pragma region MiddleBottomBox
+	for (AWall* ChangedWall : ChangedWalls)
+	{
+		int32 ChangedForward = FWallGraph::GetHalfEdge(ChangedWall->GraphEdge, true);
+		int32 ChangedBackward = FWallGraph::GetHalfEdge(ChangedWall->GraphEdge, false);
 
-			FWallBox _middleWallBottom;
-			if (!bIsDoor)
+		for (int32 ChangedVertex : { WallGraph.GetOrigin(ChangedForward), WallGraph.GetOrigin(ChangedBackward) })
+		{
+			for (int32 Outgoing : WallGraph.GetVertex(ChangedVertex).OutgoingHalfEdges)
 			{
-				_middleWallBottom.b_LeftSideStart = FVector(Window.b_LeftSideStart.X, Window.b_LeftSideStart.Y, 0);
-				_middleWallBottom.b_RightSideStart = FVector(Window.b_RightSideStart.X, Window.b_RightSideStart.Y, 0);
-				_middleWallBottom.b_LeftSideEnd = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, 0);
-				_middleWallBottom.b_RightSideEnd = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, 0);
-
-				_middleWallBottom.t_LeftSideStart = Window.b_LeftSideStart;
-				_middleWallBottom.t_RightSideStart = Window.b_RightSideStart;
-				_middleWallBottom.t_LeftSideEnd = Window.b_LeftSideEnd;
-				_middleWallBottom.t_RightSideEnd = Window.b_RightSideEnd;
-				_middleWallBottom.AddVerts();
-
-				//getTriangles here
-
-				TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.b_LeftSideStart);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.b_RightSideStart);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.b_RightSideEnd);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.b_LeftSideEnd);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.t_LeftSideStart);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.t_RightSideStart);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.t_RightSideEnd);
-				CurrentWallActor->wallVertices.Add(_middleWallBottom.t_LeftSideEnd);
-			}
-
-#pragma endregion
-
-#pragma region EndWall
-
-			FWallBox _endingWall;
-
-			_endingWall.b_LeftSideStart = FVector(Window.b_LeftSideEnd.X, Window.b_LeftSideEnd.Y, 0);
-			_endingWall.b_RightSideStart = FVector(Window.b_RightSideEnd.X, Window.b_RightSideEnd.Y, 0);
-			_endingWall.b_LeftSideEnd = CurrentWallActor->WallBoxes[0].b_LeftSideEnd;
-			_endingWall.b_RightSideEnd = CurrentWallActor->WallBoxes[0].b_RightSideEnd;
-
-
-			_endingWall.t_LeftSideStart = FVector(Window.t_LeftSideEnd.X, Window.t_LeftSideEnd.Y, HighestPoint);
-			_endingWall.t_RightSideStart = FVector(Window.t_RightSideEnd.X, Window.t_RightSideEnd.Y, HighestPoint);
-			_endingWall.t_LeftSideEnd = CurrentWallActor->WallBoxes[0].t_LeftSideEnd;
-			_endingWall.t_RightSideEnd = CurrentWallActor->WallBoxes[0].t_RightSideEnd;
-
-			_endingWall.AddVerts();
+				AddSeedWall(WallGraph.GetWall(Outgoing));
 
-
-			//getTriangles here
-
-			TriangulateWallBoxes(CurrentWallActor->wallVertices.Num(), i_currentLocalVertSize, Triangle);
-
-
-			CurrentWallActor->wallVertices.Add(_endingWall.b_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_endingWall.b_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_endingWall.b_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_endingWall.b_LeftSideEnd);
-			CurrentWallActor->wallVertices.Add(_endingWall.t_LeftSideStart);
-			CurrentWallActor->wallVertices.Add(_endingWall.t_RightSideStart);
-			CurrentWallActor->wallVertices.Add(_endingWall.t_RightSideEnd);
-			CurrentWallActor->wallVertices.Add(_endingWall.t_LeftSideEnd);
-
-#pragma endregion
-
-			if (!isPreview)
-			{
-				CurrentWallActor->WallBoxes.Empty();
-				CurrentWallActor->WallBoxes.Add(_startingWall);
-				CurrentWallActor->WallBoxes.Add(_middleWallTop);
-				if (!bIsDoor)
+				for (int32 NodeHalfEdge : { Outgoing, FWallGraph::GetTwin(Outgoing) })
 				{
-					CurrentWallActor->WallBoxes.Add(_middleWallBottom);
+					if (ARoom* NodeRoom = WallGraph.GetRoom(NodeHalfEdge))
+					{
+						DirtyRooms.Add(NodeRoom);
+					}
 				}
-				CurrentWallActor->WallBoxes.Add(_endingWall);
 			}
-			//bottom intersection points
-
-
-
-
 		}
-
-
-		//setup other things
-		TArray<FVector> normals;
-		TArray<FVector2D> UV0;
-
-		for (int i = 0; i < CurrentWallActor->wallVertices.Num(); i++)
-		{
-			FVector Vertex = CurrentWallActor->wallVertices[i];
-			FVector DeltaFromStart = Vertex - CurrentWallActor->StartPoint;
-
-			normals.Add(DeltaFromStart.ProjectOnTo(crosLNorm));
-
-			float distanceXY = DeltaFromStart.Size2D();
-			float distanceZ = Vertex.Z;
-
-			UV0.Add(FVector2D(
-				FMath::Abs(0.01f * distanceXY),
-				FMath::Abs(0.01f * distanceZ)
-			));
-		}
-
-		TArray<FProcMeshTangent> tangents;
-		TArray<FLinearColor> vertexColors;
-		//for (int i = 0; i != Triangle.Num(); i++)
-		//{
-		//	vertexColors.Add(FLinearColor(1.0f, 1.0f, 1.0f, 1.0f));
-		//}
-
-		////TODO PEYVAN Figure out algo to fix /\
-
-		tangents.Empty();
-		vertexColors.Empty();
-
-		WallMesh->CreateMeshSection_LinearColor(0, CurrentWallActor->wallVertices, Triangle, normals, UV0, vertexColors, tangents, true);
 	}
-}
 
-void UEditManager::TriangulateWallBoxes(int i_currentWallVertSize, int i_currentLocalVertSize, TArray<int> &Triangle)
-{
-	
-	Triangle.Add(i_currentWallVertSize + 0);
-	Triangle.Add(i_currentWallVertSize + 2);
-	Triangle.Add(i_currentWallVertSize + 1);
-
-	Triangle.Add(i_currentWallVertSize + 0);
-	Triangle.Add(i_currentWallVertSize + 3);
-	Triangle.Add(i_currentWallVertSize + 2);
-
-	//TopTriangle
-	Triangle.Add(i_currentWallVertSize + 4);
-	Triangle.Add(i_currentWallVertSize + 5);
-	Triangle.Add(i_currentWallVertSize + 6);
+	if (SeedWalls.Num() == 0)
+	{
+		return;
+	}
 
-	Triangle.Add(i_currentWallVertSize + 4);
-	Triangle.Add(i_currentWallVertSize + 6);
-	Triangle.Add(i_currentWallVertSize + 7);
+	UE_LOG(LogTemp, Log, TEXT("Searching rooms around %d changed walls, starting from %d dirty rooms..."), ChangedWalls.Num(), DirtyRooms.Num());
 
-	for (int i = 0; i < i_currentLocalVertSize; i++)
+	// Only clear the sides of walls that belonged to dirty rooms; the other side of those walls may belong to a room that's still valid.
+	for (ARoom* DirtyRoom : DirtyRooms)
 	{
-		if (i < i_currentLocalVertSize - 1)
+		const FRoomData& DirtyRoomData = DirtyRoom->RoomData;
+		for (int32 RoomWallIndex = 0; RoomWallIndex < DirtyRoomData.WallsOrdered.Num(); ++RoomWallIndex)
 		{
+			AWall* RoomWall = DirtyRoomData.WallsOrdered[RoomWallIndex];
+			AddSeedWall(RoomWall);
 
-			Triangle.Add(i_currentWallVertSize + i + (i_currentLocalVertSize));
-			Triangle.Add(i_currentWallVertSize + i);
-			Triangle.Add(i_currentWallVertSize + i + 1);
-			Triangle.Add(i_currentWallVertSize + i + (i_currentLocalVertSize));
-			Triangle.Add(i_currentWallVertSize + i + 1);
-			Triangle.Add(i_currentWallVertSize + i + (i_currentLocalVertSize + 1));
-		}
-		else
-		{
-			Triangle.Add(i_currentWallVertSize + i + (i_currentLocalVertSize));
-			Triangle.Add(i_currentWallVertSize + i);
-			Triangle.Add(i_currentWallVertSize + i + 1);
-			Triangle.Add(i_currentWallVertSize + i_currentLocalVertSize);
-			Triangle.Add(i_currentWallVertSize + i);
-			Triangle.Add(i_currentWallVertSize + 0);
+			int32 RoomHalfEdge = FWallGraph::GetHalfEdge(RoomWall->GraphEdge, DirtyRoomData.WallDirections[RoomWallIndex]);
+			if (WallGraph.GetRoom(RoomHalfEdge) == DirtyRoom)
+			{
+				SetWallSideRoom(RoomHalfEdge, nullptr);
+			}
 		}
 	}
-}
-
-
-/*******
-ROOMS
-*******/
 
-void UEditManager::UpdateRoomsFromWalls()
-{
-	// Every planar graph has at least one region: the outer region, which encompasses the whole graph.
-	// Every other region of the planar graph will be described by a list of edges, traversed counter-clockwise.
-	// Each edge of the graph is therefore adjacent to two regions of the graph.
+	for (AWall* ChangedWall : ChangedWalls)
+	{
+		SetWallSideRoom(FWallGraph::GetHalfEdge(ChangedWall->GraphEdge, true), nullptr);
+		SetWallSideRoom(FWallGraph::GetHalfEdge(ChangedWall->GraphEdge, false), nullptr);
+	}
 
-	// We need enough walls for a planar graph.
-	if (Walls.Num() == 0)
+	// If a traced room runs into a clean room's wall, then the dirty region was underestimated, so start over with every room.
+	TArray<ARoom*> TracedRooms;
+	if (!TraceRoomsFromWalls(SeedWalls, DirtyRooms, TracedRooms))
 	{
+		UE_LOG(LogTemp, Log, TEXT("... Incremental room search left the dirty rooms, searching all rooms instead."));
+		UpdateRoomsFromWalls();
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Searching rooms..."));
-
-	TSet<ARoom*> DirtyRooms(Rooms);				// The set of rooms that need to be updated, or removed if they are invalid.
-	TSet<AWall*> DirtyWalls(Walls);				// The set of walls that need to be traversed in order to update walls.
-
-	// Clear out room references for all walls that have been modified and need to recreate room data
-	for (AWall* DirtyWall : DirtyWalls)
+	for (ARoom* DirtyRoom : DirtyRooms)
 	{
-		DirtyWall->LeftRoom = nullptr;
-		DirtyWall->RightRoom = nullptr;
+		DestroyRoom(DirtyRoom);
 	}
 
+	TArray<ARoom*> DirtyFloorRooms;
+	UpdateRoomHoles(TracedRooms, DirtyFloorRooms);
+	TriangulateDirtyRooms(DirtyFloorRooms);
+
+	UE_LOG(LogTemp, Log, TEXT("... Done searching rooms. There are now %d total rooms."), Rooms.Num());
+}
+
+bool UEditManager::TraceRoomsFromWalls(const TArray<AWall*>& SeedWalls, TSet<ARoom*>& DirtyRooms, TArray<ARoom*>& OutTracedRooms)
+{
+	// Seed walls are only ever scanned forwards, since every wall side before the current one has already been traced
 	int32 CurrentWallIndex = 0;
-	AWall* CurrentWall = Walls[CurrentWallIndex];
-	bool bCurrentForwards = true;
+	int32 CurrentHalfEdge = INDEX_NONE;
 
 	FRoomData CurrentRoomData;
-	int32 CurrentRoomIndex = Rooms.Num();
-	CurrentRoomData.ID = CurrentRoomIndex;
 
-	while (CurrentWall)
+	bool bTracedAllRooms = true;
+
+	while (true)
 	{
-		// Add the current wall to the current room
-		bool bAddedWall = CurrentRoomData.AddWall(CurrentWall, bCurrentForwards);
-		if (!ensureAlways(bAddedWall))
+		if (CurrentHalfEdge == INDEX_NONE)
 		{
-			break;
-		}
+			// Find the next wall side to start traversing rooms from
+			bool bCurrentForwards = true;
+			for (; CurrentWallIndex < SeedWalls.Num();)
+			{
+				int32 NextHalfEdge = FWallGraph::GetHalfEdge(SeedWalls[CurrentWallIndex]->GraphEdge, bCurrentForwards);
+
+				if (WallGraph.GetFace(NextHalfEdge) != INDEX_NONE)
+				{
+					if (bCurrentForwards)
+					{
+						bCurrentForwards = false;
+					}
+					else
+					{
+						++CurrentWallIndex;
+						bCurrentForwards = true;
+					}
+				}
+				else
+				{
+					// We've found an available starting wall side that hasn't been in any rooms yet
+					CurrentHalfEdge = NextHalfEdge;
+
+					// Initialize the next room
+					CurrentRoomData = FRoomData();
+					CurrentRoomData.ID = NextRoomID++;
 
-		AWall* PreviousWall = CurrentWall;
-		ARoomNode* NextNode = bCurrentForwards ? CurrentWall->EndNode : CurrentWall->StartNode;
+					break;
+				}
+			}
 
-		// Traverse counter-clockwise (for connectivity, actual angle may not be if we're exploring an exterior or concave room)
-		CurrentWall = bCurrentForwards ? CurrentWall->DestLeftWall : CurrentWall->SourceRightWall;
+			if (CurrentHalfEdge == INDEX_NONE)
+			{
+				break;
+			}
+		}
 
-		if (!ensureAlways(PreviousWall != CurrentWall && NextNode != nullptr))
+		// Add the current wall to the current room
+		bool bAddedWall = CurrentRoomData.AddWall(WallGraph.GetWall(CurrentHalfEdge), FWallGraph::IsForward(CurrentHalfEdge));
+		if (!ensureAlways(bAddedWall))
 		{
+			bTracedAllRooms = false;
 			break;
 		}
 
-		// If the previous wall and direction lead to a dead end, try to wrap back around.
-		if (CurrentWall == nullptr)
+		// Traverse counter-clockwise (for connectivity, actual angle may not be if we're exploring an exterior or concave room).
+		// Dead ends are already linked back around onto the other side of the same wall.
+		CurrentHalfEdge = WallGraph.GetNext(CurrentHalfEdge);
+		if (!ensureAlways(CurrentHalfEdge != INDEX_NONE))
 		{
-			CurrentWall = PreviousWall;
-			bCurrentForwards = !bCurrentForwards;
+			bTracedAllRooms = false;
+			break;
 		}
-		// Otherwise figure out the next wall direction
-		else
-		{
-			bool bNextComesFromCurrent = (CurrentWall->StartNode == NextNode);
-			bool bNextGoesToCurrent = (CurrentWall->EndNode == NextNode);
-
-			if (!ensureAlways(bNextComesFromCurrent != bNextGoesToCurrent))
-			{
-				break;
-			}
 
-			bCurrentForwards = bNextComesFromCurrent;
-		}
+		AWall* CurrentWall = WallGraph.GetWall(CurrentHalfEdge);
+		bool bCurrentForwards = FWallGraph::IsForward(CurrentHalfEdge);
 
 		// See if our next wall has already been included in any other rooms
-		bool bCurWallHasRoom = bCurrentForwards ? (CurrentWall->LeftRoom != nullptr) : (CurrentWall->RightRoom != nullptr);
 		int32 CurrentRoomNextWallIndex = -1;
-		if (bCurWallHasRoom)
+		if (WallGraph.GetFace(CurrentHalfEdge) != INDEX_NONE)
 		{
-			ensureAlways(false);
-			CurrentWall = nullptr;
+			bTracedAllRooms = false;
 			break;
 		}
 		// Check if we've finished the room by reaching the original wall
@@ -1426,38 +1505,25 @@ void UEditManager::UpdateRoomsFromWalls()
 				if ((UpdatedRoom != nullptr) && (NumSharedWalls > 0) && DirtyRooms.Contains(UpdatedRoom))
 				{
 					CurrentRoomData.ID = UpdatedRoom->RoomData.ID;
-					UpdatedRoom->UpdateRoomData(CurrentRoomData);
+					UpdateRoomFromData(UpdatedRoom, CurrentRoomData);
 				}
 				// If there is no room that shares enough walls, then create a new room.
 				else
 				{
 					UpdatedRoom = CreateRoomFromData(CurrentRoomData);
 				}
-
-				
-				if (!UpdatedRoom->RoomData.IsClockWise())
-				{
-					UpdatedRoom->DebugDraw();
-				}
 			}
 			ensureAlways(UpdatedRoom != nullptr);
+			OutTracedRooms.Add(UpdatedRoom);
 
 			// Update this room's wall associations
 			for (int32 CurRoomWallIndex = 0; CurRoomWallIndex < UpdatedRoom->RoomData.WallsOrdered.Num(); ++CurRoomWallIndex)
 			{
 				AWall* CurRoomWall = UpdatedRoom->RoomData.WallsOrdered[CurRoomWallIndex];
-				bool bCurRoomWallForwards = UpdatedRoom->RoomData.WallDirections[CurRoomWallIndex];
+				int32 CurRoomHalfEdge = FWallGraph::GetHalfEdge(CurRoomWall->GraphEdge, UpdatedRoom->RoomData.WallDirections[CurRoomWallIndex]);
 
-				if (bCurRoomWallForwards)
-				{
-					ensureAlways(CurRoomWall->LeftRoom == nullptr);
-					CurRoomWall->LeftRoom = UpdatedRoom;
-				}
-				else
-				{
-					ensureAlways(CurRoomWall->RightRoom == nullptr);
-					CurRoomWall->RightRoom = UpdatedRoom;
-				}
+				ensureAlways(WallGraph.GetFace(CurRoomHalfEdge) == INDEX_NONE);
+				SetWallSideRoom(CurRoomHalfEdge, UpdatedRoom);
 			}
 
 			// Mark the updated room as no longer being dirty
@@ -1466,56 +1532,192 @@ void UEditManager::UpdateRoomsFromWalls()
 				DirtyRooms.Remove(UpdatedRoom);
 			}
 
-			// Clear out the current wall since we need to find a new starting point
-			CurrentWall = nullptr;
+			// Clear out the current wall side since we need to find a new starting point
+			CurrentHalfEdge = INDEX_NONE;
+		}
+	}
+
+	return bTracedAllRooms;
+}
+
+void UEditManager::UpdateRoomHoles(const TArray<ARoom*>& TracedRooms, TArray<ARoom*>& OutDirtyFloorRooms)
+{
+	// Traced rooms may have changed shape, or switched between being interior and being an island, so their holes are found again
+	for (ARoom* TracedRoom : TracedRooms)
+	{
+		TracedRoom->CacheLoop();
+		DetachRoomHoles(TracedRoom);
+
+		if (TracedRoom->RoomData.bFloorDirty)
+		{
+			OutDirtyFloorRooms.Add(TracedRoom);
 		}
+	}
 
-		if (!CurrentWall)
+	// Exterior rooms outline each group of connected walls, so the ones that are inside of an interior room are islands in its floor
+	for (ARoom* TracedRoom : TracedRooms)
+	{
+		if (TracedRoom->IsInterior())
 		{
-			// Find the next wall to start traversing rooms from
-			bCurrentForwards = true;
-			for (int32 NextWallIndex = CurrentWallIndex; NextWallIndex < Walls.Num();)
-			{
-				AWall* NextWall = Walls[NextWallIndex];
-				bool bNextWallHasRoom = bCurrentForwards ? (NextWall->LeftRoom != nullptr) : (NextWall->RightRoom != nullptr);
+			RoomsWithDirtyHoles.Add(TracedRoom);
 
-				if (bNextWallHasRoom)
+			// Islands that were already placed may be in this room now instead, if it's nested inside of the room they're in
+			for (ARoom* IslandRoom : IslandRooms)
+			{
+				if (TracedRoom->LoopBounds.IsInsideOrOnXY(IslandRoom->LoopVertices[0]))
 				{
-					if (bCurrentForwards)
-					{
-						bCurrentForwards = false;
-					}
-					else
-					{
-						++NextWallIndex;
-						bCurrentForwards = true;
-					}
+					IslandsToPlace.Add(IslandRoom);
 				}
-				else
-				{
-					// We've found an available starting wall that hasn't been in any rooms yet
-					CurrentWall = NextWall;
+			}
+		}
+		else if (TracedRoom->RoomData.LoopWallIndices.Num() >= 3)
+		{
+			IslandRooms.Add(TracedRoom);
+			IslandsToPlace.Add(TracedRoom);
+		}
+	}
 
-					// Initialize the next room
-					CurrentRoomData = FRoomData();
-					CurrentRoomData.ID = ++CurrentRoomIndex;
+	for (ARoom* IslandRoom : IslandsToPlace)
+	{
+		ARoom* HostRoom = FindIslandHost(IslandRoom);
+		if (HostRoom != IslandRoom->HostRoom)
+		{
+			if (IslandRoom->HostRoom)
+			{
+				IslandRoom->HostRoom->HoleRooms.Remove(IslandRoom);
+				RoomsWithDirtyHoles.Add(IslandRoom->HostRoom);
+			}
+			if (HostRoom)
+			{
+				HostRoom->HoleRooms.Add(IslandRoom);
+				RoomsWithDirtyHoles.Add(HostRoom);
+			}
+			IslandRoom->HostRoom = HostRoom;
+		}
+	}
+	IslandsToPlace.Reset();
 
-					break;
-				}
+	TArray<const FRoomData*> Holes;
+	for (ARoom* Room : RoomsWithDirtyHoles)
+	{
+		if (Room->IsInterior())
+		{
+			Holes.Reset();
+			for (const ARoom* HoleRoom : Room->HoleRooms)
+			{
+				Holes.Add(&HoleRoom->RoomData);
+			}
+
+			// Rooms whose floors were already dirty have been gathered above
+			bool bFloorWasDirty = Room->RoomData.bFloorDirty;
+			if (Room->RoomData.SetHoles(Holes) && !bFloorWasDirty)
+			{
+				OutDirtyFloorRooms.Add(Room);
 			}
 		}
 	}
+	RoomsWithDirtyHoles.Reset();
+}
 
-	// TODO: if room data has changed, then update existing rooms that share data.
-	// For now, just create new rooms if data has changed, and destroy rooms that are no longer valid.
-	for (ARoom* DirtyRoom : DirtyRooms)
+ARoom* UEditManager::FindIslandHost(const ARoom* IslandRoom) const
+{
+	// With only one group of walls, there can't be any islands
+	if (IslandRooms.Num() < 2)
 	{
-		DirtyRoom->Destroy();
-		Rooms.Remove(DirtyRoom);
+		return nullptr;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("... Done searching rooms. There are now %d total rooms."), Rooms.Num());
+	// Rooms that share the test node are in the same group of walls as the island, so they can't contain it
+	const FRoomData& IslandData = IslandRoom->RoomData;
+	AWall* TestWall = IslandData.WallsOrdered[IslandData.LoopWallIndices[0]];
+	ARoomNode* TestNode = IslandData.WallDirections[IslandData.LoopWallIndices[0]] ? TestWall->StartNode : TestWall->EndNode;
+	const FVector& TestPoint = IslandRoom->LoopVertices[0];
+
+	// Islands nested in other islands belong to the innermost room around them, which has the smallest bounds
+	ARoom* HostRoom = nullptr;
+	float HostBoundsArea = 0.0f;
+	for (ARoom* Room : Rooms)
+	{
+		const FBox& Bounds = Room->LoopBounds;
+		if (!Room->IsInterior() || !Bounds.IsInsideOrOnXY(TestPoint))
+		{
+			continue;
+		}
+
+		FVector BoundsSize = Bounds.GetSize();
+		float BoundsArea = BoundsSize.X * BoundsSize.Y;
+		if ((HostRoom && (BoundsArea >= HostBoundsArea)) || Room->RoomData.Nodes.Contains(TestNode))
+		{
+			continue;
+		}
+
+		TArray<ModumateCore::FVec3, TInlineAllocator<16>> PolyVerts;
+		for (const FVector& LoopVertex : Room->LoopVertices)
+		{
+			PolyVerts.Add(ToCore(LoopVertex));
+		}
+
+		if (ModumateCore::PointInPolygon2D(PolyVerts.GetData(), PolyVerts.Num(), ToCore(TestPoint)))
+		{
+			HostRoom = Room;
+			HostBoundsArea = BoundsArea;
+		}
+	}
+
+	return HostRoom;
+}
+
+void UEditManager::DetachRoomHoles(ARoom* Room)
+{
+	if (Room->HostRoom)
+	{
+		Room->HostRoom->HoleRooms.Remove(Room);
+		RoomsWithDirtyHoles.Add(Room->HostRoom);
+		Room->HostRoom = nullptr;
+	}
+
+	for (ARoom* HoleRoom : Room->HoleRooms)
+	{
+		HoleRoom->HostRoom = nullptr;
+		IslandsToPlace.Add(HoleRoom);
+	}
+	Room->HoleRooms.Reset();
+
+	IslandRooms.Remove(Room);
+	IslandsToPlace.Remove(Room);
+}
+
+void UEditManager::TriangulateDirtyRooms(const TArray<ARoom*>& DirtyFloorRooms)
+{
+	TArray<const FRoomData*> DirtyFloors;
+	for (ARoom* DirtyFloorRoom : DirtyFloorRooms)
+	{
+		DirtyFloors.Add(&DirtyFloorRoom->RoomData);
+	}
+
+	if (DirtyFloors.Num() == 0)
+	{
+		return;
+	}
+
+	MODUMATE_STAGE_SCOPE(Triangulate);
+
+	// Floors only read their own room's data and the thread-safe triangulation cache, so they're all triangulated in parallel,
+	// and then committed back to their rooms on the game thread.
+	if (FloorTriangulations.Num() < DirtyFloors.Num())
+	{
+		FloorTriangulations.SetNum(DirtyFloors.Num());
+	}
+	ParallelFor(DirtyFloors.Num(), [this, &DirtyFloors](int32 FloorIndex)
+	{
+		DirtyFloors[FloorIndex]->TriangulateFloor(FloorTriangulations[FloorIndex]);
+	});
 
+	for (int32 FloorIndex = 0; FloorIndex < DirtyFloorRooms.Num(); ++FloorIndex)
+	{
+		ARoom* DirtyFloorRoom = DirtyFloorRooms[FloorIndex];
+		DirtyFloorRoom->RoomData.CommitFloor(FloorTriangulations[FloorIndex]);
+	}
 }
 
 ARoom* UEditManager::CreateRoomFromData(const FRoomData& RoomData)
@@ -1529,18 +1731,69 @@ ARoom* UEditManager::CreateRoomFromData(const FRoomData& RoomData)
 	if (NewRoom)
 	{
 		NewRoom->RoomData = RoomData;
+		NewRoom->GraphFace = WallGraph.AddFace(NewRoom);
 		Rooms.Add(NewRoom);
+		RegisterRoom(NewRoom);
 	}
 
 	return NewRoom;
 }
 
+void UEditManager::UpdateRoomFromData(ARoom* Room, const FRoomData& RoomData)
+{
+	UnregisterRoom(Room);
+	Room->UpdateRoomData(RoomData);
+	RegisterRoom(Room);
+}
+
+void UEditManager::DestroyRoom(ARoom* Room)
+{
+	UnregisterRoom(Room);
+	DetachRoomHoles(Room);
+	RoomsWithDirtyHoles.Remove(Room);
+	WallGraph.RemoveFace(Room->GraphFace);
+	Room->GraphFace = INDEX_NONE;
+	Rooms.Remove(Room);
+	Room->Destroy();
+}
+
+void UEditManager::RegisterRoom(ARoom* Room)
+{
+	const FRoomData& RoomData = Room->RoomData;
+	RoomsByWallLoop.Add(RoomData.WallLoopHash, Room);
+
+	for (int32 WallIndex = 0; WallIndex < RoomData.WallsOrdered.Num(); ++WallIndex)
+	{
+		TPair<AWall*, bool> WallSide(RoomData.WallsOrdered[WallIndex], RoomData.WallDirections[WallIndex]);
+		RoomsByWallSide.FindOrAdd(WallSide).AddUnique(Room);
+	}
+}
+
+void UEditManager::UnregisterRoom(ARoom* Room)
+{
+	const FRoomData& RoomData = Room->RoomData;
+	RoomsByWallLoop.RemoveSingle(RoomData.WallLoopHash, Room);
+
+	for (int32 WallIndex = 0; WallIndex < RoomData.WallsOrdered.Num(); ++WallIndex)
+	{
+		TPair<AWall*, bool> WallSide(RoomData.WallsOrdered[WallIndex], RoomData.WallDirections[WallIndex]);
+		if (auto* WallSideRooms = RoomsByWallSide.Find(WallSide))
+		{
+			WallSideRooms->RemoveSwap(Room);
+			if (WallSideRooms->Num() == 0)
+			{
+				RoomsByWallSide.Remove(WallSide);
+			}
+		}
+	}
+}
+
 ARoom* UEditManager::FindRoomFromData(const FRoomData& RoomData, bool bCreateIfNotFound)
 {
-	// TODO: make this not a naive linear search, but there are few enough rooms where it shouldn't matter for a while.
-	// If RoomData could had a order-dependent hash of wall directions and IDs, then the rooms could be compared and stored quickly by that hash.
-	for (ARoom* Room : Rooms)
+	// Only rooms with the same wall loop hash can be equal; Equals resolves any hash collisions.
+	for (auto It = RoomsByWallLoop.CreateConstKeyIterator(RoomData.WallLoopHash); It; ++It)
 	{
+		ARoom* Room = It.Value();
 		if (Room && Room->RoomData.Equals(RoomData))
 		{
 			return Room;
@@ -1562,10 +1815,28 @@ ARoom* UEditManager::FindMostSimilarRoom(const FRoomData& RoomData, int32& NumSh
 	NumSharedWalls = 0;
 	ARoom* MostSimilarRoom = nullptr;
 
-	for (ARoom* Room : Rooms)
+	// Only rooms that use one of this room's walls in the same direction can share any walls with it,
+	// so count the shared walls per room through the wall side index rather than comparing against every room.
+	TMap<ARoom*, int32, TInlineSetAllocator<8>> SharedWallCounts;
+	for (int32 WallIndex = 0; WallIndex < RoomData.WallsOrdered.Num(); ++WallIndex)
+	{
+		TPair<AWall*, bool> WallSide(RoomData.WallsOrdered[WallIndex], RoomData.WallDirections[WallIndex]);
+		if (const auto* WallSideRooms = RoomsByWallSide.Find(WallSide))
+		{
+			for (ARoom* WallSideRoom : *WallSideRooms)
+			{
+				++SharedWallCounts.FindOrAdd(WallSideRoom);
+			}
+		}
+	}
+
+	// Like FRoomData::CompareWalls, shared walls are counted from both rooms; ties go to the oldest room, for stability.
+	for (auto& SharedWallCount : SharedWallCounts)
 	{
-		int CurSharedWalls = Room->RoomData.CompareWalls(RoomData);
-		if (CurSharedWalls > NumSharedWalls)
+		int32 CurSharedWalls = 2 * SharedWallCount.Value;
+		ARoom* Room = SharedWallCount.Key;
+		if ((CurSharedWalls > NumSharedWalls) ||
+			((CurSharedWalls == NumSharedWalls) && MostSimilarRoom && (Room->RoomData.ID < MostSimilarRoom->RoomData.ID)))
 		{
 			NumSharedWalls = CurSharedWalls;
 			MostSimilarRoom = Room;
@@ -1581,23 +1852,17 @@ ARoomNode* UEditManager::CreateNodeAtPoint(const FVector& Position)
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
 	ARoomNode* NewRoomNode = GetWorld()->SpawnActor<ARoomNode>(RoomNodeClass, FTransform(FQuat::Identity, Position), SpawnParams);
+	NewRoomNode->GraphVertex = WallGraph.AddVertex(NewRoomNode, FVector2D(Position));
 	RoomNodes.Add(NewRoomNode);
+	RoomNodeHash.AddOrUpdateNode(NewRoomNode);
 
 	return NewRoomNode;
 }
 
 ARoomNode* UEditManager::FindNodeAtPoint(const FVector& Position, ARoomNode* IgnoreNode)
 {
-	// TODO: search in quad tree if we have lots of nodes and call this frequently.
-	for (ARoomNode* RoomNode : RoomNodes)
-	{
-		if (RoomNode->GetActorLocation().Equals(Position, RoomNodeEpsilon) && RoomNode != IgnoreNode)
-		{
-			return RoomNode;
-		}
-	}
-
-	return nullptr;
+	// Only the cells neighboring the position's quantized cell can contain nodes within RoomNodeEpsilon.
+	return RoomNodeHash.FindNode(Position, IgnoreNode);
 }
 
 ARoomNode* UEditManager::FindOrCreateNodeAtPoint(const FVector& Position)
@@ -1615,178 +1880,23 @@ ARoomNode* UEditManager::FindOrCreateNodeAtPoint(const FVector& Position)
 OTHER
 *******/
 
-TArray<int32> UEditManager::Triangulate(TArray<FVector> vertices)
+TArray<int32> UEditManager::Triangulate(const TArray<FVector>& vertices)
 {
-	/** Decomposes the polygon into triangles with a naive ear-clipping algorithm. Does not handle internal holes in the polygon.
-	Based on the implementation in Engine/Source/Runtime/Engine/Private/GeomTools.cpp, Copyright 1998-2017 Epic Games, Inc. **/
-
-	bool bKeepColinearVertices = true;
-	TArray<int32> SimpleIndices;
-	SimpleIndices.Add(0);
-	SimpleIndices.Add(1);
-	SimpleIndices.Add(2);
-
+	MODUMATE_STAGE_SCOPE(Triangulate);
 
-
-	// Can't work if not enough verts for 1 triangle
-	if (vertices.Num() < 3)
-	{
-		// Return true because poly is already a tri
-		return SimpleIndices;
-	}
-
-	// Vertices of polygon in order - make a copy we are going to modify.
-	TArray<FVector> PolyVerts;
-	TArray<int32> OriginalVertIndices;
 	TArray<int32> TriangleIndices;
-	for (int i = 0; i < vertices.Num(); i++)
-	{
-		PolyVerts.Add(vertices[i]);
-		OriginalVertIndices.Add(i);
-	}
-
-	// Keep iterating while there are still vertices
-	while (true)
-	{
-		if (!bKeepColinearVertices)
-		{
-			// Cull redundant vertex edges from the polygon.
-			for (int32 VertexIndex = 0; VertexIndex < PolyVerts.Num(); VertexIndex++)
-			{
-				const int32 I0 = (VertexIndex + 0) % PolyVerts.Num();
-				const int32 I1 = (VertexIndex + 1) % PolyVerts.Num();
-				const int32 I2 = (VertexIndex + 2) % PolyVerts.Num();
-				if (FGraphUtils::AreEdgesMergeable(PolyVerts[I0], PolyVerts[I1], PolyVerts[I2]))
-				{
-					PolyVerts.RemoveAt(I1);
-					OriginalVertIndices.RemoveAt(I1);
-					VertexIndex--;
-				}
-			}
-		}
-
-		if (PolyVerts.Num() < 3)
-		{
-			break;
-		}
-		else
-		{
-			// Look for an 'ear' triangle
-			bool bFoundEar = false;
-			for (int32 EarVertexIndex = 0; EarVertexIndex < PolyVerts.Num(); EarVertexIndex++)
-			{
-				// Triangle is 'this' vert plus the one before and after it
-				const int32 AIndex = (EarVertexIndex == 0) ? PolyVerts.Num() - 1 : EarVertexIndex - 1;
-				const int32 BIndex = EarVertexIndex;
-				const int32 CIndex = (EarVertexIndex + 1) % PolyVerts.Num();
-
-				// Check that this vertex is convex (cross product must be positive)
-				const FVector ABEdge = PolyVerts[BIndex] - PolyVerts[AIndex];
-				const FVector ACEdge = PolyVerts[CIndex] - PolyVerts[AIndex];
-				const float TriangleDeterminant = (ABEdge ^ ACEdge) | FVector::UpVector;
-				if (!FMath::IsNegativeFloat(TriangleDeterminant))
-				{
-					continue;
-				}
-
-				bool bFoundVertInside = false;
-				// Look through all verts before this in array to see if any are inside triangle
-				for (int32 VertexIndex = 0; VertexIndex < PolyVerts.Num(); VertexIndex++)
-				{
-					if (VertexIndex != AIndex && VertexIndex != BIndex && VertexIndex != CIndex &&
-						FGraphUtils::PointInTriangle(PolyVerts[AIndex], PolyVerts[BIndex], PolyVerts[CIndex], PolyVerts[VertexIndex]))
-					{
-						bFoundVertInside = true;
-						break;
-					}
-				}
-
-				// Triangle with no verts inside - its an 'ear'! 
-				if (!bFoundVertInside)
-				{
-					// Add to output list..
-					TriangleIndices.Add(OriginalVertIndices[AIndex]);
-					TriangleIndices.Add(OriginalVertIndices[BIndex]);
-					TriangleIndices.Add(OriginalVertIndices[CIndex]);
-
-					// And remove vertex from polygon
-					PolyVerts.RemoveAt(EarVertexIndex);
-					OriginalVertIndices.RemoveAt(EarVertexIndex);
-
-					bFoundEar = true;
-					break;
-				}
-			}
-
-			// If we couldn't find an 'ear' it indicates something is bad with this polygon - discard triangles and return.
-			if (!bFoundEar)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Triangulation of poly failed."));
-				TriangleIndices.Empty();
-				return TriangleIndices;
-			}
-		}
-	}
-
+	TriangulateOutline(vertices, TriangleIndices);
 	return TriangleIndices;
 }
 
 bool  UEditManager::IsWithinBoxBounds(FVector origin, FVector bounds, AWall *CurrentWall)
 {
-	float objBounds = bounds.X;
-	if (bounds.Y > objBounds)
-	{
-		objBounds = bounds.Y;
-	}
-	/*if (bounds.Z > objBounds)
-	{
-		objBounds = bounds.Z;
-	}*/
-
-	for (int i = 0; i < CurrentWall->WallBoxes.Num(); i++)
-	{
-		float Dist = FVector::Distance(CurrentWall->WallBoxes[i].t_LeftSideStart, CurrentWall->WallBoxes[i].b_LeftSideEnd);
-		float first = FVector::Distance(origin, CurrentWall->WallBoxes[i].b_LeftSideStart);
-		float second = FVector::Distance(origin, CurrentWall->WallBoxes[i].b_LeftSideEnd);
-		float thirt = FVector::Distance(origin, CurrentWall->WallBoxes[i].t_LeftSideStart);
-		float fourth = FVector::Distance(origin, CurrentWall->WallBoxes[i].t_LeftSideEnd);
-		int distcount = 0;
-		
-		objBounds *= 1.1f;
-
-		if (Dist > FVector::Distance(origin, CurrentWall->WallBoxes[i].b_LeftSideStart) + objBounds)
-		{
-			distcount++;
-		}
-		
-		if (Dist > FVector::Distance(origin, CurrentWall->WallBoxes[i].b_LeftSideEnd) + objBounds)
-		{
-			distcount++;
-
-		}
-		
-		if (Dist > FVector::Distance(origin, CurrentWall->WallBoxes[i].t_LeftSideStart) + objBounds)
-		{
-			distcount++;
-
-		}
-		
-		if (Dist > FVector::Distance(origin, CurrentWall->WallBoxes[i].t_LeftSideEnd) + objBounds)
-		{
-			distcount++;
-
-		}
-
-		if (distcount == 4)
-		{
-			return true;
-		}
-
-
-	}
-
+	float objBounds = FMath::Max(bounds.X, bounds.Y) * 1.1f;
 
-	return false;
+	// Whether something that wide, centered on the origin, fits in the wall without reaching any of its openings
+	ModumateCore::FWallOpening Opening = MakeWallOpening(CurrentWall, origin, FVector(objBounds, 0.0f, 0.0f), true);
+	Opening.HeadHeight = CurrentWall->wallHeight;
+	return CurrentWall->Openings.CanPlace(Opening, FVector::Dist(CurrentWall->StartPoint, CurrentWall->EndPoint));
 }
 /*
 ============================================================================================================================================
@@ -1797,6 +1907,8 @@ bool  UEditManager::IsWithinBoxBounds(FVector origin, FVector bounds, AWall *Cur
 
 void UEditManager::UpdateDimensionStringsForInteriorWalls()
 {
+	MODUMATE_STAGE_SCOPE(UpdateDimensionStrings);
+
 	//remember, y goes left, x goes down, z goes up.
 	FVector VerticalNorm(1, 0, 0);
 	FVector HorizontalNorm(0, 1, 0);
@@ -4748,6 +4860,9 @@ void UEditManager::UpdateDimensionStringsForInteriorWalls()
 			 UpdateGrounded(Node);
 		}
 	}
+
+	// Every interior dimension string is respawned on each update
+	FModumateCounters::AddDimensionStringsSpawned(InteriorDimensionStrings.Num());
 }
 
 void UEditManager::UpdateGrounded(AWall * Wall)
@@ -0,0 +1,377 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Math/RandomStream.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "DimensionStringBase.h"
+#include "EditManager.h"
+#include "ModumateCoreConversions.h"
+#include "ModumateFloorPlans.h"
+#include "ModumateGameInstance.h"
+#include "ModumateProfiling.h"
+#include "Room.h"
+#include "RoomNode.h"
+#include "Wall.h"
+#include "WallIntersectionKernel.h"
+
+namespace
+{
+	AWall* SpawnBenchmarkWall(UWorld* World, const FVector& Start, const FVector& End)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AWall* Wall = World->SpawnActor<AWall>(AWall::StaticClass(), FTransform(FQuat::Identity, Start), SpawnParams);
+		Wall->StartPoint = Start;
+		Wall->EndPoint = End;
+		return Wall;
+	}
+
+	void DestroyBenchmarkWall(AWall* Wall)
+	{
+		if (Wall->WidthDimensionString)
+		{
+			Wall->WidthDimensionString->Destroy();
+		}
+		if (Wall->HeightDimensionString)
+		{
+			Wall->HeightDimensionString->Destroy();
+		}
+		Wall->Destroy();
+	}
+
+	FVector RandomWallEnd(FRandomStream& Random, const FVector& Start)
+	{
+		// Mostly axis-aligned walls, like real floor plans, with some diagonals mixed in
+		float Length = Random.FRandRange(100.0f, 1500.0f);
+		float Angle = (Random.FRand() < 0.8f) ? (HALF_PI * Random.RandRange(0, 3)) : Random.FRandRange(0.0f, 2.0f * PI);
+		return Start + Length * FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f);
+	}
+
+	/**
+	 * Compares AWall::GetWallIntersection2D against FWallIntersectionKernel::IntersectAll, querying random segments
+	 * against a table of random walls, and reports the timings along with any mismatched results.
+	 * Usage: Modumate.BenchWallIntersections [NumWalls=2000] [NumQueries=1000]
+	 */
+	void BenchWallIntersections(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		int32 NumWalls = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000;
+		int32 NumQueries = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+		float Extent = 250.0f * FMath::Sqrt(static_cast<float>(NumWalls));
+
+		FRandomStream Random(NumWalls);
+		TArray<AWall*> BenchWalls;
+		FWallSegmentTable Table;
+		for (int32 WallIndex = 0; WallIndex < NumWalls; ++WallIndex)
+		{
+			FVector Start(Random.FRandRange(0.0f, Extent), Random.FRandRange(0.0f, Extent), 0.0f);
+			AWall* Wall = SpawnBenchmarkWall(World, Start, RandomWallEnd(Random, Start));
+			BenchWalls.Add(Wall);
+			Table.AddOrUpdateWall(Wall);
+		}
+
+		AWall* QueryWall = SpawnBenchmarkWall(World, FVector::ZeroVector, FVector::ZeroVector);
+		TArray<FVector> QueryStarts, QueryEnds;
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			FVector Start(Random.FRandRange(0.0f, Extent), Random.FRandRange(0.0f, Extent), 0.0f);
+			QueryStarts.Add(Start);
+			QueryEnds.Add(RandomWallEnd(Random, Start));
+		}
+
+		TArray<TArray<FWallIntersection>> ScalarResults, KernelResults;
+		ScalarResults.SetNum(NumQueries);
+		KernelResults.SetNum(NumQueries);
+
+		double ScalarStartTime = FPlatformTime::Seconds();
+		FWallIntersection TempIntersection;
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			QueryWall->StartPoint = QueryStarts[QueryIndex];
+			QueryWall->EndPoint = QueryEnds[QueryIndex];
+			for (AWall* OtherWall : BenchWalls)
+			{
+				if (QueryWall->GetWallIntersection2D(OtherWall, TempIntersection))
+				{
+					ScalarResults[QueryIndex].Add(TempIntersection);
+				}
+			}
+		}
+		double ScalarTime = FPlatformTime::Seconds() - ScalarStartTime;
+
+		double KernelStartTime = FPlatformTime::Seconds();
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			FWallIntersectionKernel::IntersectAll(Table, QueryStarts[QueryIndex], QueryEnds[QueryIndex], KernelResults[QueryIndex]);
+		}
+		double KernelTime = FPlatformTime::Seconds() - KernelStartTime;
+
+		// Both paths visit the walls in the same order, so their results can be compared one by one
+		int32 NumHits = 0;
+		int32 NumMismatches = 0;
+		for (int32 QueryIndex = 0; QueryIndex < NumQueries; ++QueryIndex)
+		{
+			const TArray<FWallIntersection>& Scalar = ScalarResults[QueryIndex];
+			const TArray<FWallIntersection>& Kernel = KernelResults[QueryIndex];
+			NumHits += Scalar.Num();
+
+			if (Scalar.Num() != Kernel.Num())
+			{
+				NumMismatches += FMath::Abs(Scalar.Num() - Kernel.Num());
+				continue;
+			}
+
+			for (int32 HitIndex = 0; HitIndex < Scalar.Num(); ++HitIndex)
+			{
+				if ((Scalar[HitIndex].HitWall != Kernel[HitIndex].HitWall) ||
+					(Scalar[HitIndex].DistAlongQueryWall != Kernel[HitIndex].DistAlongQueryWall) ||
+					(Scalar[HitIndex].DistAlongHitWall != Kernel[HitIndex].DistAlongHitWall))
+				{
+					++NumMismatches;
+				}
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Wall intersections: %d walls x %d queries, %d hits"), NumWalls, NumQueries, NumHits);
+		UE_LOG(LogTemp, Display, TEXT("    Scalar: %.3f ms, kernel: %.3f ms (%.2fx), %d mismatched results"),
+			1000.0 * ScalarTime, 1000.0 * KernelTime, (KernelTime > 0.0) ? (ScalarTime / KernelTime) : 0.0, NumMismatches);
+
+		for (AWall* Wall : BenchWalls)
+		{
+			DestroyBenchmarkWall(Wall);
+		}
+		DestroyBenchmarkWall(QueryWall);
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs BenchWallIntersectionsCommand(
+		TEXT("Modumate.BenchWallIntersections"),
+		TEXT("Compares the scalar and vectorized wall intersection tests. Usage: Modumate.BenchWallIntersections [NumWalls] [NumQueries]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchWallIntersections));
+
+	enum class EBenchPlan : uint8
+	{
+		Grid,
+		Rectilinear,
+		Diagonal,
+		Num
+	};
+
+	const TCHAR* GetBenchPlanName(EBenchPlan Plan)
+	{
+		switch (Plan)
+		{
+		case EBenchPlan::Grid: return TEXT("grid");
+		case EBenchPlan::Rectilinear: return TEXT("rectilinear");
+		case EBenchPlan::Diagonal: return TEXT("diagonal");
+		default: return TEXT("unknown");
+		}
+	}
+
+	void GenerateBenchPlan(EBenchPlan Plan, int32 TargetNumWalls, std::vector<ModumateCore::FWallSegment>& OutWalls)
+	{
+		// Size each plan so that it has roughly the target number of walls
+		const float RoomSize = 400.0f;
+		switch (Plan)
+		{
+		case EBenchPlan::Grid:
+		{
+			// 2n(n + 1) walls
+			int32 NumRoomsPerSide = FMath::Max(FMath::RoundToInt(FMath::Sqrt(0.5f * TargetNumWalls)), 1);
+			ModumateCore::GenerateGridPlan(NumRoomsPerSide, NumRoomsPerSide, RoomSize, OutWalls);
+			break;
+		}
+		case EBenchPlan::Rectilinear:
+		{
+			// About 3 walls per room, once they're split at the T-junctions
+			int32 NumRooms = FMath::Max(TargetNumWalls / 3, 1);
+			ModumateCore::GenerateRectilinearPlan(NumRooms, 0.25f * RoomSize, TargetNumWalls, OutWalls);
+			break;
+		}
+		case EBenchPlan::Diagonal:
+		{
+			// About 4 walls per room for the split sides, plus the interior walls
+			int32 NumRoomsPerSide = FMath::Max(FMath::RoundToInt(FMath::Sqrt(TargetNumWalls / 4.67f)), 1);
+			ModumateCore::GenerateDiagonalPlan(NumRoomsPerSide, NumRoomsPerSide, RoomSize, TargetNumWalls, OutWalls);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void DestroyEditManagerActors(UEditManager* EditManager)
+	{
+		EditManager->DestroyWallClusters();
+		for (AWall* Wall : EditManager->Walls)
+		{
+			for (ADimensionStringBase* String : Wall->FixtureDimensionStrings)
+			{
+				String->Destroy();
+			}
+			DestroyBenchmarkWall(Wall);
+		}
+		for (ARoomNode* Node : EditManager->RoomNodes)
+		{
+			Node->Destroy();
+		}
+		for (ARoom* Room : EditManager->Rooms)
+		{
+			Room->Destroy();
+		}
+		for (ADimensionStringBase* String : EditManager->InteriorDimensionStrings)
+		{
+			String->Destroy();
+		}
+	}
+
+	/**
+	 * Places synthetic floor plans of increasing size through a fresh UEditManager, recording the latency percentiles
+	 * and allocation counts of each stage of the edit pipeline, and writes them to a CSV file in the profiling directory.
+	 * Walls are placed one at a time with StartWall/FinishWall, or all at once with PlaceWalls in batch mode.
+	 * Usage: Modumate.BenchEditPipeline [grid|rectilinear|diagonal] [batch] [NumWalls...=10 100 1000 10000]
+	 */
+	void BenchEditPipeline(const TArray<FString>& Args, UWorld* World)
+	{
+		UModumateGameInstance* GameInstance = World ? Cast<UModumateGameInstance>(World->GetGameInstance()) : nullptr;
+		if (GameInstance == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Modumate.BenchEditPipeline needs a world with a ModumateGameInstance."));
+			return;
+		}
+
+		TArray<EBenchPlan> Plans;
+		TArray<int32> TargetWallCounts;
+		bool bBatch = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.IsNumeric())
+			{
+				TargetWallCounts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+			}
+			else if (Arg.Equals(TEXT("batch"), ESearchCase::IgnoreCase))
+			{
+				bBatch = true;
+			}
+			else
+			{
+				for (int32 PlanIndex = 0; PlanIndex < (int32)EBenchPlan::Num; ++PlanIndex)
+				{
+					if (Arg.Equals(GetBenchPlanName((EBenchPlan)PlanIndex), ESearchCase::IgnoreCase))
+					{
+						Plans.AddUnique((EBenchPlan)PlanIndex);
+					}
+				}
+			}
+		}
+
+		if (Plans.Num() == 0)
+		{
+			Plans = { EBenchPlan::Grid, EBenchPlan::Rectilinear, EBenchPlan::Diagonal };
+		}
+		if (TargetWallCounts.Num() == 0)
+		{
+			TargetWallCounts = { 10, 100, 1000, 10000 };
+		}
+
+		FString Csv = TEXT("Plan,Mode,TargetWalls,PlacedWalls,Rooms,Stage,Samples,TotalMs,MeanUs,P50Us,P90Us,P99Us,MaxUs,Allocations,AllocationsPerSample\n");
+
+		// Swap in a fresh edit manager, since actors look up the current one through the game instance
+		UEditManager* OldEditManager = GameInstance->EditManager;
+		for (EBenchPlan Plan : Plans)
+		{
+			for (int32 TargetNumWalls : TargetWallCounts)
+			{
+				std::vector<ModumateCore::FWallSegment> PlanWalls;
+				GenerateBenchPlan(Plan, TargetNumWalls, PlanWalls);
+
+				UEditManager* EditManager = NewObject<UEditManager>(GameInstance, GameInstance->EditManagerClass);
+				GameInstance->EditManager = EditManager;
+
+				int32 NumRejectedWalls = 0;
+				double StartTime = FPlatformTime::Seconds();
+				FModumateStageRecorder::BeginRecording();
+
+				if (bBatch)
+				{
+					TArray<FVector> WallStarts, WallEnds;
+					for (const ModumateCore::FWallSegment& PlanWall : PlanWalls)
+					{
+						WallStarts.Add(FromCore(PlanWall.Start));
+						WallEnds.Add(FromCore(PlanWall.End));
+					}
+					NumRejectedWalls = WallStarts.Num() - EditManager->PlaceWalls(WallStarts, WallEnds).Num();
+				}
+				else
+				{
+					for (const ModumateCore::FWallSegment& PlanWall : PlanWalls)
+					{
+						// Like dragging out the wall before clicking, so that FinishWall tests the whole wall for intersections
+						AWall* NewWall = EditManager->StartWall(FromCore(PlanWall.Start));
+						NewWall->SetEndPoint(FromCore(PlanWall.End));
+						if (EditManager->FinishWall(FromCore(PlanWall.End)) == nullptr)
+						{
+							EditManager->RemoveWall(NewWall);
+							++NumRejectedWalls;
+						}
+					}
+				}
+
+				FModumateStageRecorder::EndRecording();
+				double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+				const TCHAR* PlanName = GetBenchPlanName(Plan);
+				const TCHAR* ModeName = bBatch ? TEXT("batch") : TEXT("incremental");
+				UE_LOG(LogTemp, Display, TEXT("Edit pipeline: %s plan, %s, %d walls placed (%d rejected), %d rooms, %.3f ms"),
+					PlanName, ModeName, EditManager->Walls.Num(), NumRejectedWalls, EditManager->Rooms.Num(), 1000.0 * TotalTime);
+
+				for (int32 StageIndex = 0; StageIndex < (int32)EModumateStage::Num; ++StageIndex)
+				{
+					EModumateStage Stage = (EModumateStage)StageIndex;
+					FModumateStageStats Stats = FModumateStageRecorder::GetStats(Stage);
+					if (Stats.NumSamples == 0)
+					{
+						continue;
+					}
+
+					UE_LOG(LogTemp, Display, TEXT("    %s: %d samples, p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us, %lld allocations"),
+						GetModumateStageName(Stage), Stats.NumSamples, 1.0e6 * Stats.P50Seconds, 1.0e6 * Stats.P90Seconds,
+						1.0e6 * Stats.P99Seconds, 1.0e6 * Stats.MaxSeconds, Stats.NumAllocations);
+
+					Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%s,%d,%.3f,%.2f,%.2f,%.2f,%.2f,%.2f,%lld,%.1f\n"),
+						PlanName, ModeName, TargetNumWalls, EditManager->Walls.Num(), EditManager->Rooms.Num(), GetModumateStageName(Stage),
+						Stats.NumSamples, 1.0e3 * Stats.TotalSeconds, 1.0e6 * Stats.MeanSeconds, 1.0e6 * Stats.P50Seconds,
+						1.0e6 * Stats.P90Seconds, 1.0e6 * Stats.P99Seconds, 1.0e6 * Stats.MaxSeconds, Stats.NumAllocations,
+						static_cast<double>(Stats.NumAllocations) / Stats.NumSamples);
+				}
+
+				DestroyEditManagerActors(EditManager);
+				GameInstance->EditManager = OldEditManager;
+			}
+		}
+
+		FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Modumate"),
+			FString::Printf(TEXT("EditPipeline-%s.csv"), *FDateTime::Now().ToString()));
+		if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+		{
+			UE_LOG(LogTemp, Display, TEXT("Wrote edit pipeline benchmark results to %s"), *CsvPath);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write edit pipeline benchmark results to %s"), *CsvPath);
+		}
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs BenchEditPipelineCommand(
+		TEXT("Modumate.BenchEditPipeline"),
+		TEXT("Times each stage of placing synthetic floor plans, and writes the results as CSV. Usage: Modumate.BenchEditPipeline [grid|rectilinear|diagonal] [batch] [NumWalls...]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchEditPipeline));
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateCollisionQueue.h"
+
+#include "HAL/PlatformTime.h"
+
+FModumateCollisionQueue::FModumateCollisionQueue(float InIdleDelay, int32 InMaxCooksPerFrame)
+	: IdleDelay(InIdleDelay)
+	, MaxCooksPerFrame(InMaxCooksPerFrame)
+	, LastSubmitTime(0.0)
+{
+}
+
+void FModumateCollisionQueue::SubmitConvexes(UProceduralMeshComponent* Mesh, const TArray<TArray<FVector>>& Convexes)
+{
+	FPendingCollision& Collision = PendingCollision.FindOrAdd(Mesh);
+	Collision.bConvexes = true;
+	Collision.Convexes = Convexes;
+	Collision.TrimeshSections.Reset();
+	LastSubmitTime = FPlatformTime::Seconds();
+}
+
+void FModumateCollisionQueue::SubmitTrimesh(UProceduralMeshComponent* Mesh, int32 SectionIndex)
+{
+	FPendingCollision& Collision = PendingCollision.FindOrAdd(Mesh);
+	if (Collision.bConvexes)
+	{
+		Collision.bConvexes = false;
+		Collision.Convexes.Reset();
+	}
+	Collision.TrimeshSections.AddUnique(SectionIndex);
+	LastSubmitTime = FPlatformTime::Seconds();
+}
+
+void FModumateCollisionQueue::CookIdle()
+{
+	if (FPlatformTime::Seconds() - LastSubmitTime < IdleDelay)
+	{
+		return;
+	}
+
+	int32 NumCooked = 0;
+	for (auto It = PendingCollision.CreateIterator(); It && (NumCooked < MaxCooksPerFrame); ++It)
+	{
+		if (UProceduralMeshComponent* Mesh = It.Key().Get())
+		{
+			Cook(Mesh, It.Value());
+			++NumCooked;
+		}
+		It.RemoveCurrent();
+	}
+}
+
+void FModumateCollisionQueue::Flush()
+{
+	for (auto& CollisionPair : PendingCollision)
+	{
+		if (UProceduralMeshComponent* Mesh = CollisionPair.Key.Get())
+		{
+			Cook(Mesh, CollisionPair.Value);
+		}
+	}
+
+	PendingCollision.Empty();
+}
+
+void FModumateCollisionQueue::Cook(UProceduralMeshComponent* Mesh, FPendingCollision& Collision)
+{
+	if (Collision.bConvexes)
+	{
+		// Queries then go against the convexes, rather than the sections' triangles, which aren't cooked at all
+		Mesh->bUseComplexAsSimpleCollision = false;
+		Mesh->SetCollisionConvexMeshes(Collision.Convexes);
+		return;
+	}
+
+	// Collision is switched on in the sections themselves, so that their render data isn't uploaded again
+	bool bCollisionChanged = !Mesh->bUseComplexAsSimpleCollision;
+	for (int32 SectionIndex : Collision.TrimeshSections)
+	{
+		FProcMeshSection* Section = Mesh->GetProcMeshSection(SectionIndex);
+		if (Section && !Section->bEnableCollision)
+		{
+			Section->bEnableCollision = true;
+			bCollisionChanged = true;
+		}
+	}
+
+	// Components that had convexes go back to colliding with their sections' triangles. Clearing the convexes is also
+	// the component's public way of rebuilding its body setup, which cooks the sections that now have collision.
+	if (bCollisionChanged)
+	{
+		Mesh->bUseComplexAsSimpleCollision = true;
+		Mesh->ClearCollisionConvexMeshes();
+	}
+}
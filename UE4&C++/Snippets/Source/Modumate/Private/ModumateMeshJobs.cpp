@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateMeshJobs.h"
+
+#include "Async/Async.h"
+#include "ModumateProfiling.h"
+#include "ModumateSurfaceKernel.h"
+
+// The surface kernel works on the engine's vectors in place, as packed floats
+static_assert(sizeof(FVector) == sizeof(ModumateCore::FVec3), "FVector must have the same layout as ModumateCore::FVec3");
+static_assert(sizeof(FVector2D) == sizeof(ModumateCore::FVec2), "FVector2D must have the same layout as ModumateCore::FVec2");
+
+void FModumateMeshBuffers::Reset()
+{
+	Vertices.Reset();
+	Triangles.Reset();
+	Normals.Reset();
+	UV0.Reset();
+	VertexColors.Reset();
+	Tangents.Reset();
+}
+
+namespace
+{
+	// The kernel's tangents, before they're wrapped in FProcMeshTangents, which each thread keeps from one mesh to the next
+	thread_local TArray<FVector> ThreadTangentXs;
+}
+
+void FModumateMeshBuffers::ComputeFlatSurface(float UVScale)
+{
+	int32 NumVertices = Vertices.Num();
+	Normals.SetNumUninitialized(NumVertices, false);
+	UV0.SetNumUninitialized(NumVertices, false);
+	TArray<FVector>& TangentXs = ThreadTangentXs;
+	TangentXs.SetNumUninitialized(NumVertices, false);
+
+	ModumateCore::ComputeFlatSurface(reinterpret_cast<const ModumateCore::FVec3*>(Vertices.GetData()), NumVertices, Triangles.GetData(), Triangles.Num(),
+		UVScale, reinterpret_cast<ModumateCore::FVec3*>(Normals.GetData()), reinterpret_cast<ModumateCore::FVec3*>(TangentXs.GetData()),
+		reinterpret_cast<ModumateCore::FVec2*>(UV0.GetData()));
+
+	Tangents.Reset(NumVertices);
+	for (const FVector& TangentX : TangentXs)
+	{
+		Tangents.Add(FProcMeshTangent(TangentX, false));
+	}
+}
+
+FModumateMeshJobQueue::~FModumateMeshJobQueue()
+{
+	// Worker threads may still be filling buffers that are about to go away
+	for (auto& SectionJobsPair : SectionJobs)
+	{
+		if (SectionJobsPair.Value->bBuilding)
+		{
+			SectionJobsPair.Value->BuildTask.Wait();
+		}
+	}
+}
+
+void FModumateMeshJobQueue::Submit(UProceduralMeshComponent* Mesh, int32 SectionIndex, bool bCreateCollision, FBuildFunction Build, FUploadedFunction OnUploaded)
+{
+	check(IsInGameThread());
+
+	TUniquePtr<FSectionJobs>& Jobs = SectionJobs.FindOrAdd(FSectionKey(Mesh, SectionIndex));
+	if (!Jobs.IsValid())
+	{
+		Jobs = MakeUnique<FSectionJobs>();
+		Jobs->Mesh = Mesh;
+		Jobs->SectionIndex = SectionIndex;
+	}
+
+	FJob Job{ bCreateCollision, MoveTemp(Build), MoveTemp(OnUploaded) };
+	if (Jobs->bBuilding)
+	{
+		Jobs->bWaiting = true;
+		Jobs->Waiting = MoveTemp(Job);
+	}
+	else
+	{
+		StartBuild(*Jobs, MoveTemp(Job));
+	}
+}
+
+bool FModumateMeshJobQueue::Cancel(UProceduralMeshComponent* Mesh, int32 SectionIndex)
+{
+	bool bHadBuilds = false;
+	for (auto& SectionJobsPair : SectionJobs)
+	{
+		FSectionJobs& CancelledJobs = *SectionJobsPair.Value;
+		if ((CancelledJobs.Mesh.Get() != Mesh) || ((SectionIndex != INDEX_NONE) && (CancelledJobs.SectionIndex != SectionIndex)))
+		{
+			continue;
+		}
+
+		// A build that's in flight can't be stopped, but it won't be uploaded
+		bHadBuilds |= (CancelledJobs.bBuilding && !CancelledJobs.bCancelled) || CancelledJobs.bWaiting;
+		CancelledJobs.bCancelled = CancelledJobs.bBuilding;
+		CancelledJobs.bWaiting = false;
+		CancelledJobs.Waiting = FJob();
+	}
+
+	return bHadBuilds;
+}
+
+void FModumateMeshJobQueue::UploadFinished()
+{
+	check(IsInGameThread());
+
+	for (auto It = SectionJobs.CreateIterator(); It; ++It)
+	{
+		FSectionJobs& Jobs = *It.Value();
+		if (Jobs.bBuilding && !Jobs.BuildTask.IsReady())
+		{
+			continue;
+		}
+
+		if (!FinishBuild(Jobs))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FModumateMeshJobQueue::Flush()
+{
+	check(IsInGameThread());
+
+	for (auto It = SectionJobs.CreateIterator(); It; ++It)
+	{
+		FSectionJobs& Jobs = *It.Value();
+		while (Jobs.bBuilding)
+		{
+			Jobs.BuildTask.Wait();
+			FinishBuild(Jobs);
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+void FModumateMeshJobQueue::StartBuild(FSectionJobs& Jobs, FJob&& Job)
+{
+	Jobs.bBuilding = true;
+	Jobs.bCancelled = false;
+	Jobs.Building = MoveTemp(Job);
+
+	// Only the worker touches the back buffers until the build is finished, and the job map keeps them where they are
+	FModumateMeshBuffers* BackBuffers = &Jobs.Buffers[1 - Jobs.FrontIndex];
+	FBuildFunction* Build = &Jobs.Building.Build;
+	Jobs.BuildTask = Async(EAsyncExecution::ThreadPool, [BackBuffers, Build]()
+	{
+		BackBuffers->Reset();
+		(*Build)(*BackBuffers);
+	});
+}
+
+bool FModumateMeshJobQueue::FinishBuild(FSectionJobs& Jobs)
+{
+	if (Jobs.bBuilding)
+	{
+		Jobs.bBuilding = false;
+		Jobs.FrontIndex = 1 - Jobs.FrontIndex;
+		FJob Built = MoveTemp(Jobs.Building);
+
+		// Starting the next build clears bCancelled, which belongs to the build that just finished, as when a mesh is
+		// cancelled and then submitted again while its last build was still running
+		const bool bWasCancelled = Jobs.bCancelled;
+
+		// Start the next build into the buffers that were just uploaded from, before uploading these
+		if (Jobs.bWaiting && Jobs.Mesh.IsValid())
+		{
+			Jobs.bWaiting = false;
+			StartBuild(Jobs, MoveTemp(Jobs.Waiting));
+		}
+
+		UProceduralMeshComponent* Mesh = Jobs.Mesh.Get();
+		if (Mesh && !bWasCancelled)
+		{
+			MODUMATE_STAGE_SCOPE(UploadMeshSections);
+
+			const FModumateMeshBuffers& Front = Jobs.Buffers[Jobs.FrontIndex];
+			Mesh->CreateMeshSection_LinearColor(Jobs.SectionIndex, Front.Vertices, Front.Triangles, Front.Normals, Front.UV0,
+				Front.VertexColors, Front.Tangents, Built.bCreateCollision);
+			FModumateCounters::AddTrianglesEmitted(Front.Triangles.Num() / 3);
+
+			if (Built.OnUploaded)
+			{
+				Built.OnUploaded(Mesh, Front);
+			}
+		}
+	}
+
+	return Jobs.bBuilding;
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateMeshLODs.h"
+
+FModumateMeshLODs::FModumateMeshLODs(float InSimplifiedScreenSize)
+	: SimplifiedScreenSize(InSimplifiedScreenSize)
+	, ViewOrigin(FVector::ZeroVector)
+	, ScreenScale(1.0f)
+	, bHasView(false)
+{
+}
+
+void FModumateMeshLODs::SetLODSections(UProceduralMeshComponent* Mesh, const TArray<int32>& DetailSections, const TArray<int32>& SimplifiedSections)
+{
+	FMeshLODs& LODs = MeshLODs.FindOrAdd(Mesh);
+	LODs.DetailSections = DetailSections;
+	LODs.SimplifiedSections = SimplifiedSections;
+	LODs.bSimplified = ShouldSimplify(Mesh);
+	ShowLOD(Mesh, LODs);
+}
+
+void FModumateMeshLODs::Remove(UProceduralMeshComponent* Mesh)
+{
+	MeshLODs.Remove(Mesh);
+}
+
+void FModumateMeshLODs::Update(const FVector& InViewOrigin, float FOVAngle)
+{
+	ViewOrigin = InViewOrigin;
+	ScreenScale = 1.0f / FMath::Tan(FMath::DegreesToRadians(0.5f * FMath::Clamp(FOVAngle, 1.0f, 179.0f)));
+	bHasView = true;
+
+	for (auto It = MeshLODs.CreateIterator(); It; ++It)
+	{
+		UProceduralMeshComponent* Mesh = It.Key().Get();
+		if (!Mesh)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Only meshes that switch are touched, since changing a section's visibility recreates the component's render state
+		bool bSimplified = ShouldSimplify(Mesh);
+		if (bSimplified != It.Value().bSimplified)
+		{
+			It.Value().bSimplified = bSimplified;
+			ShowLOD(Mesh, It.Value());
+		}
+	}
+}
+
+bool FModumateMeshLODs::ShouldSimplify(const UProceduralMeshComponent* Mesh) const
+{
+	if (!bHasView)
+	{
+		return false;
+	}
+
+	// The bounds' diameter over the view's width at their distance, like ComputeBoundSphereScreenSize
+	const FBoxSphereBounds& Bounds = Mesh->Bounds;
+	float Distance = FMath::Max(FVector::Dist(Bounds.Origin, ViewOrigin), 1.0f);
+	float ScreenSize = ScreenScale * Bounds.SphereRadius / Distance;
+	return ScreenSize < SimplifiedScreenSize;
+}
+
+void FModumateMeshLODs::ShowLOD(UProceduralMeshComponent* Mesh, const FMeshLODs& LODs)
+{
+	for (int32 SectionIndex : LODs.DetailSections)
+	{
+		Mesh->SetMeshSectionVisible(SectionIndex, !LODs.bSimplified);
+	}
+
+	for (int32 SectionIndex : LODs.SimplifiedSections)
+	{
+		Mesh->SetMeshSectionVisible(SectionIndex, LODs.bSimplified);
+	}
+}
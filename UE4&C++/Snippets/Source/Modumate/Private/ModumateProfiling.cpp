@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateProfiling.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "ModumateTriangulationCache.h"
+
+#if defined(__has_include)
+#if __has_include("ProfilingDebugging/CountersTrace.h")
+#include "ProfilingDebugging/CountersTrace.h"
+#define MODUMATE_WITH_TRACE_COUNTERS 1
+#endif
+#endif
+
+#ifndef MODUMATE_WITH_TRACE_COUNTERS
+#define MODUMATE_WITH_TRACE_COUNTERS 0
+#endif
+
+DEFINE_STAT(STAT_Modumate_FinishWall);
+DEFINE_STAT(STAT_Modumate_CommitWallBatch);
+DEFINE_STAT(STAT_Modumate_OnWallMoved);
+DEFINE_STAT(STAT_Modumate_UpdateRooms);
+DEFINE_STAT(STAT_Modumate_UpdateDimensionStrings);
+DEFINE_STAT(STAT_Modumate_CutWindowIntoWall);
+DEFINE_STAT(STAT_Modumate_GenerateWall);
+DEFINE_STAT(STAT_Modumate_GenerateFloorBase);
+DEFINE_STAT(STAT_Modumate_Triangulate);
+DEFINE_STAT(STAT_Modumate_UploadMeshSections);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Walls"), STAT_Modumate_NumWalls, STATGROUP_Modumate);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Room nodes"), STAT_Modumate_NumNodes, STATGROUP_Modumate);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Rooms"), STAT_Modumate_NumRooms, STATGROUP_Modumate);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Triangles emitted"), STAT_Modumate_TrianglesEmitted, STATGROUP_Modumate);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dimension strings spawned"), STAT_Modumate_DimensionStringsSpawned, STATGROUP_Modumate);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Triangulation cache hits"), STAT_Modumate_TriangulationCacheHits, STATGROUP_Modumate);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Triangulation cache misses"), STAT_Modumate_TriangulationCacheMisses, STATGROUP_Modumate);
+
+#if MODUMATE_WITH_TRACE_COUNTERS
+TRACE_DECLARE_INT_COUNTER(ModumateWalls, TEXT("Modumate/Walls"));
+TRACE_DECLARE_INT_COUNTER(ModumateNodes, TEXT("Modumate/Room nodes"));
+TRACE_DECLARE_INT_COUNTER(ModumateRooms, TEXT("Modumate/Rooms"));
+TRACE_DECLARE_INT_COUNTER(ModumateTrianglesEmitted, TEXT("Modumate/Triangles emitted"));
+TRACE_DECLARE_INT_COUNTER(ModumateDimensionStringsSpawned, TEXT("Modumate/Dimension strings spawned"));
+TRACE_DECLARE_INT_COUNTER(ModumateTriangulationCacheHits, TEXT("Modumate/Triangulation cache hits"));
+TRACE_DECLARE_INT_COUNTER(ModumateTriangulationCacheMisses, TEXT("Modumate/Triangulation cache misses"));
+#endif
+
+namespace
+{
+	/** Forwards everything to the wrapped allocator, counting the allocations made on the game thread. */
+	class FModumateCountingMalloc : public FMalloc
+	{
+	public:
+		FMalloc* InnerMalloc = nullptr;
+		FThreadSafeCounter64 NumAllocations;
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Original == nullptr)
+			{
+				CountAllocation();
+			}
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return InnerMalloc->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return InnerMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual bool IsInternallyThreadSafe() const override { return InnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return InnerMalloc->ValidateHeap(); }
+		virtual void UpdateStats() override { InnerMalloc->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { InnerMalloc->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { InnerMalloc->DumpAllocatorStats(Ar); }
+		virtual void SetupTLSCachesOnCurrentThread() override { InnerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual const TCHAR* GetDescriptiveName() override { return InnerMalloc->GetDescriptiveName(); }
+
+	private:
+		void CountAllocation()
+		{
+			if (IsInGameThread())
+			{
+				NumAllocations.Increment();
+			}
+		}
+	};
+
+	// Never destroyed, since other threads may still be calling into it just after it's swapped back out of GMalloc
+	FModumateCountingMalloc& GetCountingMalloc()
+	{
+		static FModumateCountingMalloc* CountingMalloc = new FModumateCountingMalloc();
+		return *CountingMalloc;
+	}
+
+	double GetPercentile(const TArray<double>& SortedSamples, float Percentile)
+	{
+		// Nearest-rank percentile
+		int32 Rank = FMath::CeilToInt(Percentile * SortedSamples.Num());
+		return SortedSamples[FMath::Clamp(Rank - 1, 0, SortedSamples.Num() - 1)];
+	}
+
+	/** The most recent samples of a stage, overwriting the oldest once it's full. */
+	struct FStageHistory
+	{
+		static const int32 Capacity = 1024;
+
+		TArray<double> Samples;
+		int32 NextSample = 0;
+
+		void Add(double Seconds)
+		{
+			if (Samples.Num() < Capacity)
+			{
+				Samples.Add(Seconds);
+			}
+			else
+			{
+				Samples[NextSample] = Seconds;
+			}
+			NextSample = (NextSample + 1) % Capacity;
+		}
+
+		void Reset()
+		{
+			Samples.Reset();
+			NextSample = 0;
+		}
+	};
+
+	FStageHistory StageHistories[(int32)EModumateStage::Num];
+
+	/**
+	 * Logs a histogram of each stage's recent latencies, in buckets that grow by 4x from 16 microseconds up.
+	 * Usage: Modumate.DumpStageHistograms [reset]
+	 */
+	void DumpStageHistograms(const TArray<FString>& Args)
+	{
+		static const double BucketLimits[] = { 16.0e-6, 64.0e-6, 256.0e-6, 1.0e-3, 4.0e-3, 16.0e-3, 64.0e-3, 256.0e-3 };
+		static const TCHAR* BucketNames[] = { TEXT("<16us"), TEXT("<64us"), TEXT("<256us"), TEXT("<1ms"), TEXT("<4ms"), TEXT("<16ms"), TEXT("<64ms"), TEXT("<256ms"), TEXT(">=256ms") };
+		const int32 NumBuckets = ARRAY_COUNT(BucketNames);
+
+		UE_LOG(LogTemp, Display, TEXT("Modumate stage latencies, over the last %d samples of each stage:"), FStageHistory::Capacity);
+		for (int32 StageIndex = 0; StageIndex < (int32)EModumateStage::Num; ++StageIndex)
+		{
+			TArray<double> SortedSamples(StageHistories[StageIndex].Samples);
+			if (SortedSamples.Num() == 0)
+			{
+				continue;
+			}
+			SortedSamples.Sort();
+
+			int32 BucketCounts[ARRAY_COUNT(BucketNames)] = { 0 };
+			for (double Sample : SortedSamples)
+			{
+				int32 Bucket = 0;
+				while ((Bucket < NumBuckets - 1) && (Sample >= BucketLimits[Bucket]))
+				{
+					++Bucket;
+				}
+				++BucketCounts[Bucket];
+			}
+
+			FString Histogram;
+			for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+			{
+				Histogram += FString::Printf(TEXT(" %s:%d"), BucketNames[Bucket], BucketCounts[Bucket]);
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("    %s: %d samples, p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us |%s"),
+				GetModumateStageName((EModumateStage)StageIndex), SortedSamples.Num(), 1.0e6 * GetPercentile(SortedSamples, 0.50f),
+				1.0e6 * GetPercentile(SortedSamples, 0.90f), 1.0e6 * GetPercentile(SortedSamples, 0.99f), 1.0e6 * SortedSamples.Last(), *Histogram);
+		}
+
+		if ((Args.Num() > 0) && Args[0].Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+		{
+			for (FStageHistory& History : StageHistories)
+			{
+				History.Reset();
+			}
+		}
+	}
+
+	FAutoConsoleCommandWithArgs DumpStageHistogramsCommand(
+		TEXT("Modumate.DumpStageHistograms"),
+		TEXT("Logs a histogram of the recent latencies of each edit pipeline stage. Usage: Modumate.DumpStageHistograms [reset]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&DumpStageHistograms));
+
+	void TriangulationCacheCommand(const TArray<FString>& Args)
+	{
+		ModumateCore::FTriangulationCache& Cache = ModumateCore::FTriangulationCache::Get();
+		if (Args.Num() > 0)
+		{
+			if (Args[0].Equals(TEXT("clear"), ESearchCase::IgnoreCase))
+			{
+				Cache.Empty();
+			}
+			else if (Args[0].IsNumeric())
+			{
+				Cache.SetCapacity(FMath::Max(FCString::Atoi(*Args[0]), 0));
+			}
+		}
+
+		uint64 NumLookups = Cache.GetNumHits() + Cache.GetNumMisses();
+		UE_LOG(LogTemp, Display, TEXT("Triangulation cache: %d / %d polygons, %llu hits, %llu misses (%.1f%% hit rate)"),
+			(int32)Cache.Num(), (int32)Cache.GetCapacity(), Cache.GetNumHits(), Cache.GetNumMisses(),
+			(NumLookups > 0) ? (100.0 * Cache.GetNumHits() / NumLookups) : 0.0);
+	}
+
+	FAutoConsoleCommandWithArgs TriangulationCacheCommandRegistration(
+		TEXT("Modumate.TriangulationCache"),
+		TEXT("Logs the size and hit rate of the shared triangulation cache. Usage: Modumate.TriangulationCache [clear | Capacity]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&TriangulationCacheCommand));
+}
+
+const TCHAR* GetModumateStageName(EModumateStage Stage)
+{
+	switch (Stage)
+	{
+	case EModumateStage::FinishWall: return TEXT("FinishWall");
+	case EModumateStage::CommitWallBatch: return TEXT("CommitWallBatch");
+	case EModumateStage::OnWallMoved: return TEXT("OnWallMoved");
+	case EModumateStage::UpdateRooms: return TEXT("UpdateRoomsFromWalls");
+	case EModumateStage::UpdateDimensionStrings: return TEXT("UpdateDimensionStringsForInteriorWalls");
+	case EModumateStage::CutWindowIntoWall: return TEXT("CutWindowIntoWall");
+	case EModumateStage::GenerateWall: return TEXT("GenterateWall");
+	case EModumateStage::GenerateFloorBase: return TEXT("GenterateFloorBase");
+	case EModumateStage::Triangulate: return TEXT("Triangulate");
+	case EModumateStage::UploadMeshSections: return TEXT("UploadMeshSections");
+	default: return TEXT("Unknown");
+	}
+}
+
+bool FModumateStageRecorder::bRecording = false;
+TArray<double> FModumateStageRecorder::StageSamples[(int32)EModumateStage::Num];
+int64 FModumateStageRecorder::StageAllocations[(int32)EModumateStage::Num];
+
+void FModumateStageRecorder::BeginRecording()
+{
+	if (!ensureAlways(!bRecording && IsInGameThread()))
+	{
+		return;
+	}
+
+	for (int32 StageIndex = 0; StageIndex < (int32)EModumateStage::Num; ++StageIndex)
+	{
+		StageSamples[StageIndex].Reset();
+		StageAllocations[StageIndex] = 0;
+	}
+
+	FModumateCountingMalloc& CountingMalloc = GetCountingMalloc();
+	CountingMalloc.InnerMalloc = GMalloc;
+	CountingMalloc.NumAllocations.Reset();
+	GMalloc = &CountingMalloc;
+
+	bRecording = true;
+}
+
+void FModumateStageRecorder::EndRecording()
+{
+	if (!ensureAlways(bRecording && IsInGameThread()))
+	{
+		return;
+	}
+
+	GMalloc = GetCountingMalloc().InnerMalloc;
+	bRecording = false;
+}
+
+void FModumateStageRecorder::AddSample(EModumateStage Stage, double Seconds, int64 NumAllocations)
+{
+	StageSamples[(int32)Stage].Add(Seconds);
+	StageAllocations[(int32)Stage] += NumAllocations;
+}
+
+FModumateStageStats FModumateStageRecorder::GetStats(EModumateStage Stage)
+{
+	FModumateStageStats Stats;
+
+	TArray<double> SortedSamples(StageSamples[(int32)Stage]);
+	if (SortedSamples.Num() == 0)
+	{
+		return Stats;
+	}
+
+	SortedSamples.Sort();
+	for (double Sample : SortedSamples)
+	{
+		Stats.TotalSeconds += Sample;
+	}
+
+	Stats.NumSamples = SortedSamples.Num();
+	Stats.MeanSeconds = Stats.TotalSeconds / Stats.NumSamples;
+	Stats.P50Seconds = GetPercentile(SortedSamples, 0.50f);
+	Stats.P90Seconds = GetPercentile(SortedSamples, 0.90f);
+	Stats.P99Seconds = GetPercentile(SortedSamples, 0.99f);
+	Stats.MaxSeconds = SortedSamples.Last();
+	Stats.NumAllocations = StageAllocations[(int32)Stage];
+
+	return Stats;
+}
+
+int64 FModumateStageRecorder::GetNumAllocations()
+{
+	return bRecording ? GetCountingMalloc().NumAllocations.GetValue() : 0;
+}
+
+int32 FModumateStageScope::StageDepths[(int32)EModumateStage::Num];
+
+FModumateStageScope::FModumateStageScope(EModumateStage InStage)
+	: Stage(InStage)
+	, bOutermost(false)
+	, bWasRecording(FModumateStageRecorder::IsRecording())
+	, StartTime(0.0)
+	, StartAllocations(0)
+{
+	// Stages only run on the game thread, so the depths don't need to be thread-safe
+	bOutermost = (StageDepths[(int32)Stage]++ == 0);
+	StartAllocations = FModumateStageRecorder::GetNumAllocations();
+	StartTime = FPlatformTime::Seconds();
+}
+
+FModumateStageScope::~FModumateStageScope()
+{
+	if (bOutermost)
+	{
+		double Seconds = FPlatformTime::Seconds() - StartTime;
+		StageHistories[(int32)Stage].Add(Seconds);
+
+		if (bWasRecording && FModumateStageRecorder::IsRecording())
+		{
+			FModumateStageRecorder::AddSample(Stage, Seconds, FModumateStageRecorder::GetNumAllocations() - StartAllocations);
+		}
+	}
+
+	--StageDepths[(int32)Stage];
+}
+
+void FModumateCounters::SetSceneCounts(int32 NumWalls, int32 NumNodes, int32 NumRooms)
+{
+	SET_DWORD_STAT(STAT_Modumate_NumWalls, NumWalls);
+	SET_DWORD_STAT(STAT_Modumate_NumNodes, NumNodes);
+	SET_DWORD_STAT(STAT_Modumate_NumRooms, NumRooms);
+
+#if MODUMATE_WITH_TRACE_COUNTERS
+	TRACE_COUNTER_SET(ModumateWalls, NumWalls);
+	TRACE_COUNTER_SET(ModumateNodes, NumNodes);
+	TRACE_COUNTER_SET(ModumateRooms, NumRooms);
+#endif
+}
+
+void FModumateCounters::AddTrianglesEmitted(int32 NumTriangles)
+{
+	INC_DWORD_STAT_BY(STAT_Modumate_TrianglesEmitted, NumTriangles);
+
+#if MODUMATE_WITH_TRACE_COUNTERS
+	TRACE_COUNTER_ADD(ModumateTrianglesEmitted, NumTriangles);
+#endif
+}
+
+void FModumateCounters::AddDimensionStringsSpawned(int32 NumStrings)
+{
+	INC_DWORD_STAT_BY(STAT_Modumate_DimensionStringsSpawned, NumStrings);
+
+#if MODUMATE_WITH_TRACE_COUNTERS
+	TRACE_COUNTER_ADD(ModumateDimensionStringsSpawned, NumStrings);
+#endif
+}
+
+void FModumateCounters::AddTriangulationCacheLookup(bool bHit)
+{
+	if (bHit)
+	{
+		INC_DWORD_STAT(STAT_Modumate_TriangulationCacheHits);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_Modumate_TriangulationCacheMisses);
+	}
+
+#if MODUMATE_WITH_TRACE_COUNTERS
+	if (bHit)
+	{
+		TRACE_COUNTER_INCREMENT(ModumateTriangulationCacheHits);
+	}
+	else
+	{
+		TRACE_COUNTER_INCREMENT(ModumateTriangulationCacheMisses);
+	}
+#endif
+}
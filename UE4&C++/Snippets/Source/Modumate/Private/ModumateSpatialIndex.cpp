@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateSpatialIndex.h"
+
+#include "Wall.h"
+#include "RoomNode.h"
+
+// Walls and queries are padded by this much (in cm) so that segments touching a cell border are found from both sides.
+static const float WallGridPadding = 1.0f;
+
+FWallSpatialGrid::FWallSpatialGrid(float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 1.0f))
+{ }
+
+void FWallSpatialGrid::SetCellSize(float InCellSize)
+{
+	InCellSize = FMath::Max(InCellSize, 1.0f);
+	if (InCellSize == CellSize)
+	{
+		return;
+	}
+
+	TArray<const AWall*> IndexedWalls;
+	WallCells.GetKeys(IndexedWalls);
+
+	Empty();
+	CellSize = InCellSize;
+
+	for (const AWall* Wall : IndexedWalls)
+	{
+		AddOrUpdateWall(const_cast<AWall*>(Wall));
+	}
+}
+
+void FWallSpatialGrid::Empty()
+{
+	Cells.Empty();
+	WallCells.Empty();
+}
+
+void FWallSpatialGrid::AddOrUpdateWall(AWall* Wall)
+{
+	if (!ensureAlways(Wall))
+	{
+		return;
+	}
+
+	FIntRect NewCellBounds = GetCellBounds(Wall->StartPoint, Wall->EndPoint);
+	if (FIntRect* OldCellBounds = WallCells.Find(Wall))
+	{
+		if (*OldCellBounds == NewCellBounds)
+		{
+			return;
+		}
+
+		RemoveFromCells(Wall, *OldCellBounds);
+		*OldCellBounds = NewCellBounds;
+	}
+	else
+	{
+		WallCells.Add(Wall, NewCellBounds);
+	}
+
+	AddToCells(Wall, NewCellBounds);
+}
+
+void FWallSpatialGrid::RemoveWall(AWall* Wall)
+{
+	FIntRect OldCellBounds;
+	if (WallCells.RemoveAndCopyValue(Wall, OldCellBounds))
+	{
+		RemoveFromCells(Wall, OldCellBounds);
+	}
+}
+
+void FWallSpatialGrid::QuerySegment(const FVector& Start, const FVector& End, TArray<AWall*>& OutWalls) const
+{
+	FIntRect CellBounds = GetCellBounds(Start, End);
+	FVector2D Start2D(Start);
+	FVector2D End2D(End);
+	TSet<AWall*> FoundWalls;
+
+	for (int32 CellY = CellBounds.Min.Y; CellY <= CellBounds.Max.Y; ++CellY)
+	{
+		for (int32 CellX = CellBounds.Min.X; CellX <= CellBounds.Max.X; ++CellX)
+		{
+			FIntPoint Cell(CellX, CellY);
+			const TArray<AWall*>* CellWalls = Cells.Find(Cell);
+			if (CellWalls && SegmentOverlapsCell(Start2D, End2D, Cell))
+			{
+				for (AWall* CellWall : *CellWalls)
+				{
+					bool bAlreadyFound = false;
+					FoundWalls.Add(CellWall, &bAlreadyFound);
+					if (!bAlreadyFound)
+					{
+						OutWalls.Add(CellWall);
+					}
+				}
+			}
+		}
+	}
+}
+
+FIntRect FWallSpatialGrid::GetCellBounds(const FVector& Start, const FVector& End) const
+{
+	FVector2D Min(FMath::Min(Start.X, End.X) - WallGridPadding, FMath::Min(Start.Y, End.Y) - WallGridPadding);
+	FVector2D Max(FMath::Max(Start.X, End.X) + WallGridPadding, FMath::Max(Start.Y, End.Y) + WallGridPadding);
+
+	return FIntRect(
+		FMath::FloorToInt(Min.X / CellSize), FMath::FloorToInt(Min.Y / CellSize),
+		FMath::FloorToInt(Max.X / CellSize), FMath::FloorToInt(Max.Y / CellSize));
+}
+
+bool FWallSpatialGrid::SegmentOverlapsCell(const FVector2D& Start, const FVector2D& End, const FIntPoint& Cell) const
+{
+	// Slab test of the segment against the padded cell box
+	FVector2D BoxMin(Cell.X * CellSize - WallGridPadding, Cell.Y * CellSize - WallGridPadding);
+	FVector2D BoxMax((Cell.X + 1) * CellSize + WallGridPadding, (Cell.Y + 1) * CellSize + WallGridPadding);
+	FVector2D Delta = End - Start;
+	float MinT = 0.0f;
+	float MaxT = 1.0f;
+
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		if (FMath::IsNearlyZero(Delta[Axis]))
+		{
+			if (Start[Axis] < BoxMin[Axis] || Start[Axis] > BoxMax[Axis])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			float T0 = (BoxMin[Axis] - Start[Axis]) / Delta[Axis];
+			float T1 = (BoxMax[Axis] - Start[Axis]) / Delta[Axis];
+			if (T0 > T1)
+			{
+				Swap(T0, T1);
+			}
+
+			MinT = FMath::Max(MinT, T0);
+			MaxT = FMath::Min(MaxT, T1);
+			if (MinT > MaxT)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void FWallSpatialGrid::AddToCells(AWall* Wall, const FIntRect& CellBounds)
+{
+	for (int32 CellY = CellBounds.Min.Y; CellY <= CellBounds.Max.Y; ++CellY)
+	{
+		for (int32 CellX = CellBounds.Min.X; CellX <= CellBounds.Max.X; ++CellX)
+		{
+			Cells.FindOrAdd(FIntPoint(CellX, CellY)).Add(Wall);
+		}
+	}
+}
+
+void FWallSpatialGrid::RemoveFromCells(AWall* Wall, const FIntRect& CellBounds)
+{
+	for (int32 CellY = CellBounds.Min.Y; CellY <= CellBounds.Max.Y; ++CellY)
+	{
+		for (int32 CellX = CellBounds.Min.X; CellX <= CellBounds.Max.X; ++CellX)
+		{
+			FIntPoint Cell(CellX, CellY);
+			if (TArray<AWall*>* CellWalls = Cells.Find(Cell))
+			{
+				CellWalls->RemoveSwap(Wall);
+				if (CellWalls->Num() == 0)
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+}
+
+
+FRoomNodeSpatialHash::FRoomNodeSpatialHash(float InEpsilon)
+	: Epsilon(FMath::Max(InEpsilon, KINDA_SMALL_NUMBER))
+{ }
+
+void FRoomNodeSpatialHash::SetEpsilon(float InEpsilon)
+{
+	InEpsilon = FMath::Max(InEpsilon, KINDA_SMALL_NUMBER);
+	if (InEpsilon == Epsilon)
+	{
+		return;
+	}
+
+	TArray<const ARoomNode*> IndexedNodes;
+	NodeCells.GetKeys(IndexedNodes);
+
+	Empty();
+	Epsilon = InEpsilon;
+
+	for (const ARoomNode* Node : IndexedNodes)
+	{
+		AddOrUpdateNode(const_cast<ARoomNode*>(Node));
+	}
+}
+
+void FRoomNodeSpatialHash::Empty()
+{
+	Cells.Empty();
+	NodeCells.Empty();
+}
+
+void FRoomNodeSpatialHash::AddOrUpdateNode(ARoomNode* Node)
+{
+	if (!ensureAlways(Node))
+	{
+		return;
+	}
+
+	FIntPoint NewCell = GetCell(Node->GetActorLocation());
+	if (FIntPoint* OldCell = NodeCells.Find(Node))
+	{
+		if (*OldCell == NewCell)
+		{
+			return;
+		}
+
+		if (auto* OldCellNodes = Cells.Find(*OldCell))
+		{
+			OldCellNodes->RemoveSwap(Node);
+			if (OldCellNodes->Num() == 0)
+			{
+				Cells.Remove(*OldCell);
+			}
+		}
+
+		*OldCell = NewCell;
+	}
+	else
+	{
+		NodeCells.Add(Node, NewCell);
+	}
+
+	Cells.FindOrAdd(NewCell).Add(Node);
+}
+
+void FRoomNodeSpatialHash::RemoveNode(ARoomNode* Node)
+{
+	FIntPoint OldCell;
+	if (NodeCells.RemoveAndCopyValue(Node, OldCell))
+	{
+		if (auto* OldCellNodes = Cells.Find(OldCell))
+		{
+			OldCellNodes->RemoveSwap(Node);
+			if (OldCellNodes->Num() == 0)
+			{
+				Cells.Remove(OldCell);
+			}
+		}
+	}
+}
+
+ARoomNode* FRoomNodeSpatialHash::FindNode(const FVector& Position, const ARoomNode* IgnoreNode) const
+{
+	FIntPoint QueryCell = GetCell(Position);
+	ARoomNode* ClosestNode = nullptr;
+	float ClosestDistSq = FLT_MAX;
+
+	for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+	{
+		for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+		{
+			const auto* CellNodes = Cells.Find(QueryCell + FIntPoint(OffsetX, OffsetY));
+			if (CellNodes == nullptr)
+			{
+				continue;
+			}
+
+			for (ARoomNode* CellNode : *CellNodes)
+			{
+				FVector NodeLocation = CellNode->GetActorLocation();
+				if ((CellNode != IgnoreNode) && NodeLocation.Equals(Position, Epsilon))
+				{
+					float DistSq = FVector::DistSquared(NodeLocation, Position);
+					if (DistSq < ClosestDistSq)
+					{
+						ClosestDistSq = DistSq;
+						ClosestNode = CellNode;
+					}
+				}
+			}
+		}
+	}
+
+	return ClosestNode;
+}
+
+FIntPoint FRoomNodeSpatialHash::GetCell(const FVector& Position) const
+{
+	return FIntPoint(FMath::FloorToInt(Position.X / Epsilon), FMath::FloorToInt(Position.Y / Epsilon));
+}
@@ -2,55 +2,15 @@
 
 #include "ModumateUniversalFunctions.h"
 
+#include "ModumateGeometry.h"
+
 void UModumateUniversalFunctions::CentimetersToImperialInches(float Centimeters,  TArray<int>& ReturnImperial)
 {
-	ReturnImperial.Empty();
-	float Inches = Centimeters / 2.54f;
-	int NonDecimal = (int)Inches;
-	float Decimal = FMath::Abs(Inches - NonDecimal);
-	ReturnImperial.Add(NonDecimal / 12);
-	ReturnImperial.Add(NonDecimal % 12);
-	if (Decimal >= 0.875)
-	{
-		ReturnImperial[0] = ReturnImperial[0] + (ReturnImperial[1] + 1) / 12;
-		ReturnImperial[1] = (ReturnImperial[1] + 1) % 12;
-		return;
-	}
-	else if (Decimal <= 0.125)
-	{
-		return;
-	}
-	else
-	{
-		for (int num = 1; num < 8; num++)
-		{
-			if ((float)num / 8 <= Decimal && Decimal <= (float)(num + 1) / 8)
-			{
-				//GEngine->AddOnScreenDebugMessage(0, 0.5f, FColor::Red, *FString::SanitizeFloat((float)num / denom));
-				//GEngine->AddOnScreenDebugMessage(0, 0.5f, FColor::Red, *FString::SanitizeFloat((float)(num + 1) / denom));
-				float ManhatDistFromLowToDec = FMath::Abs((float)num / 8 - Decimal);
-				float ManhatDistFromDecToHigh = FMath::Abs((float)(num + 1) / 8 - Decimal);
+	int32_t Imperial[4];
+	int32 NumImperial = ModumateCore::CentimetersToImperialInches(Centimeters, Imperial);
 
-				if (ManhatDistFromLowToDec < ManhatDistFromDecToHigh)
-				{
-					int Gcd = FMath::GreatestCommonDivisor(num, 8);
-					ReturnImperial.Add(num / Gcd);
-					ReturnImperial.Add(8 / Gcd);
-					return;
-				}
-				else
-				{
-					int Gcd = FMath::GreatestCommonDivisor(num + 1, 8);
-					ReturnImperial.Add((num + 1) / Gcd);
-					ReturnImperial.Add(8 / Gcd);
-					return;
-				}
-			}
-		}
-		return;
-	}
-	
-	
+	ReturnImperial.Empty();
+	ReturnImperial.Append(Imperial, NumImperial);
 }
 
 FText UModumateUniversalFunctions::ImperialInchesToDimensionStringText(TArray<int>& Imperial)
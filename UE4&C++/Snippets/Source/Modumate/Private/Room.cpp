@@ -8,50 +8,28 @@
 #include "Components/PrimitiveComponent.h"
 #include "Wall.h"
 #include "RoomNode.h"
+#include "ModumateGeometry.h"
+#include "ModumateTriangulation.h"
+#include "ModumateTriangulationCache.h"
+#include "ModumateCoreConversions.h"
+#include "ModumateProfiling.h"
 
 
 /***************************FGraphUtils Implementation*******************/
 
 bool FGraphUtils::AreEdgesMergeable(const FVector& V0, const FVector& V1, const FVector& V2)
 {
-	const FVector MergedEdgeVector = V2 - V0;
-	const float MergedEdgeLengthSquared = MergedEdgeVector.SizeSquared();
-	if (MergedEdgeLengthSquared > DELTA)
-	{
-		// Find the vertex closest to A1/B0 that is on the hypothetical merged edge formed by A0-B1.
-		const float IntermediateVertexEdgeFraction = ((V2 - V0) | (V1 - V0)) / MergedEdgeLengthSquared;
-		const FVector InterpolatedVertex = FMath::Lerp(V0, V2, IntermediateVertexEdgeFraction);
-
-		// The edges are merge-able if the interpolated vertex is close enough to the intermediate vertex.
-		return InterpolatedVertex.Equals(V1, THRESH_POINTS_ARE_SAME);
-	}
-	else
-	{
-		return true;
-	}
+	return ModumateCore::AreEdgesMergeable(ToCore(V0), ToCore(V1), ToCore(V2));
 }
 
 bool FGraphUtils::VectorsOnSameSide(const FVector& Vec, const FVector& A, const FVector& B)
 {
-	const FVector CrossA = Vec ^ A;
-	const FVector CrossB = Vec ^ B;
-	return !FMath::IsNegativeFloat(CrossA | CrossB);
+	return ModumateCore::VectorsOnSameSide(ToCore(Vec), ToCore(A), ToCore(B));
 }
 
 bool FGraphUtils::PointInTriangle(const FVector& A, const FVector& B, const FVector& C, const FVector& P)
 {
-	// Cross product indicates which 'side' of the vector the point is on
-	// If its on the same side as the remaining vert for all edges, then its inside.	
-	if (VectorsOnSameSide(B - A, P - A, C - A) &&
-		VectorsOnSameSide(C - B, P - B, A - B) &&
-		VectorsOnSameSide(A - C, P - C, B - C))
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	return ModumateCore::PointInTriangle(ToCore(A), ToCore(B), ToCore(C), ToCore(P));
 }
 
 
@@ -62,7 +40,10 @@ FRoomData::FRoomData()
 	, Normal(FVector::UpVector)
 	, Winding(0.0f)
 	, bClosed(false)
+	, Area(0.0f)
+	, bFloorDirty(false)
 	, MinWallIDIndex(0)
+	, WallLoopHash(0)
 { }
 
 bool FRoomData::AddWall(class AWall* NewWall, bool bWallForward)
@@ -126,7 +107,9 @@ bool FRoomData::AddWall(class AWall* NewWall, bool bWallForward)
 
 		if (!IsClockWise())
 		{
-			Triangulate();
+			GetLoopVertices(FloorVertices);
+			FloorLoopSizes = { FloorVertices.Num() };
+			bFloorDirty = true;
 		}
 	}
 
@@ -138,18 +121,31 @@ bool FRoomData::Close()
 	if (!bClosed)
 	{
 		// Update the index of the minimum wall ID, for fast comparisons with other RoomData.
+		// A wall can be traversed in both directions by the same room, in which case the forward traversal comes first.
 		int32 MinWallID = INT_MAX;
+		bool bMinWallForward = false;
 		MinWallIDIndex = 0;
 		for (int32 WallIndex = 0; WallIndex < WallsOrdered.Num(); ++WallIndex)
 		{
 			AWall* Wall = WallsOrdered[WallIndex];
-			if (Wall->ID < MinWallID)
+			bool bWallForward = WallDirections[WallIndex];
+			if ((Wall->ID < MinWallID) || ((Wall->ID == MinWallID) && bWallForward && !bMinWallForward))
 			{
 				MinWallIDIndex = WallIndex;
 				MinWallID = Wall->ID;
+				bMinWallForward = bWallForward;
 			}
 		}
 
+		// Hash the walls in the same canonical order that Equals compares them in
+		WallLoopHash = 0;
+		for (int32 WallIndex = 0; WallIndex < WallsOrdered.Num(); ++WallIndex)
+		{
+			int32 CanonicalIndex = (MinWallIDIndex + WallIndex) % WallsOrdered.Num();
+			uint32 WallHash = HashCombine(GetTypeHash(WallsOrdered[CanonicalIndex]), GetTypeHash(WallDirections[CanonicalIndex]));
+			WallLoopHash = HashCombine(WallLoopHash, WallHash);
+		}
+
 		// Then, find the walls that form a strict loop (no walls are adjacent to the polygon on both sides)
 		LoopWallIndices.Empty();
 		for (int32 WallIndex = 0; WallIndex < WallsOrdered.Num(); ++WallIndex)
@@ -165,22 +161,16 @@ bool FRoomData::Close()
 		}
 
 		// Now, accumulate the winding accurately using the strict loop iteration
-		Winding = 0.0f;
-		for (int32 LoopWallIndexIndex = 0; LoopWallIndexIndex < LoopWallIndices.Num(); ++LoopWallIndexIndex)
+		TArray<ModumateCore::FVec3, TInlineAllocator<16>> LoopDirs;
+		for (int32 LoopWallIndex : LoopWallIndices)
 		{
-			int32 PrevLoopWallIndexIndex = (LoopWallIndexIndex == 0) ? (LoopWallIndices.Num() - 1) : (LoopWallIndexIndex - 1);
-			int32 PrevLoopWallIndex = LoopWallIndices[PrevLoopWallIndexIndex];
-			int32 CurLoopWallIndex = LoopWallIndices[LoopWallIndexIndex];
-
-			AWall* PrevLoopWall = WallsOrdered[PrevLoopWallIndex];
-			bool bPrevLoopWallForward = WallDirections[PrevLoopWallIndex];
-			AWall* CurLoopWall = WallsOrdered[CurLoopWallIndex];
-			bool bCurLoopWallForward = WallDirections[CurLoopWallIndex];
-
-			Winding += GetWinding((bPrevLoopWallForward ? 1.0f : -1.0f) * PrevLoopWall->GetWallDir(),
-				(bCurLoopWallForward ? 1.0f : -1.0f) * CurLoopWall->GetWallDir());
+			AWall* LoopWall = WallsOrdered[LoopWallIndex];
+			bool bLoopWallForward = WallDirections[LoopWallIndex];
+			LoopDirs.Add(ToCore((bLoopWallForward ? 1.0f : -1.0f) * LoopWall->GetWallDir()));
 		}
 
+		Winding = ModumateCore::GetLoopWinding(LoopDirs.GetData(), LoopDirs.Num(), ToCore(Normal));
+
 		bClosed = true;
 	}
 
@@ -282,9 +272,9 @@ int32 FRoomData::CompareWalls(const FRoomData& Other) const
 
 bool FRoomData::Equals(const FRoomData& Other, bool bCompareIDs) const
 {
-	// Make sure the rooms have the same number of walls
+	// Make sure the rooms have the same number of walls, and quickly reject closed rooms whose walls differ
 	int32 NumWalls = WallsOrdered.Num();
-	if (NumWalls != Other.WallsOrdered.Num())
+	if ((NumWalls != Other.WallsOrdered.Num()) || (bClosed && Other.bClosed && (WallLoopHash != Other.WallLoopHash)))
 	{
 		return false;
 	}
@@ -317,130 +307,149 @@ bool FRoomData::Equals(const FRoomData& Other, bool bCompareIDs) const
 
 float FRoomData::GetWinding(const FVector& FromDir, const FVector& ToDir) const
 {
-	FVector Cross = FromDir ^ ToDir;
-	float AbsAngle = FMath::RadiansToDegrees(FMath::Acos(FromDir | ToDir));
-	return AbsAngle * FMath::Sign(Cross | Normal);
+	return ModumateCore::GetWinding(ToCore(FromDir), ToCore(ToDir), ToCore(Normal));
 }
 
-bool FRoomData::Triangulate()
+void FRoomData::GetLoopVertices(TArray<FVector>& OutVertices) const
 {
-	/** Decomposes the polygon into triangles with a naive ear-clipping algorithm. Does not handle internal holes in the polygon.
-	    Based on the implementation in Engine/Source/Runtime/Engine/Private/GeomTools.cpp, Copyright 1998-2017 Epic Games, Inc. **/
-
-	bool bKeepColinearVertices = true;
-
-	// Can't work if not enough verts for 1 triangle
-	if (Nodes.Num() < 3)
-	{
-		// Return true because poly is already a tri
-		return true;
-	}
-
-	// Vertices of polygon in order - make a copy we are going to modify.
-	TArray<FVector> PolyVerts;
-	TArray<int32> OriginalVertIndices;
-
-	// Only iterate through the walls that form a strict loop, since only those satisfy
-	// this implementation's constraints on polygons.
-	// This would need to be updated to support triangulating polygons with holes.
+	// Only the walls that form a strict loop outline an area; dead ends and walls that are traversed twice don't.
+	OutVertices.Reset(LoopWallIndices.Num());
 	for (int32 LoopWallIndex : LoopWallIndices)
 	{
 		AWall* Wall = WallsOrdered[LoopWallIndex];
 		bool bWallForward = WallDirections[LoopWallIndex];
 		ARoomNode* LoopNode = bWallForward ? Wall->StartNode : Wall->EndNode;
-		PolyVerts.Add(LoopNode->GetActorLocation());
-		OriginalVertIndices.Add(LoopWallIndex);
+		OutVertices.Add(LoopNode->GetActorLocation());
 	}
+}
+
+bool FRoomData::SetHoles(const TArray<const FRoomData*>& HoleRooms)
+{
+	TArray<FVector> NewFloorVertices;
+	GetLoopVertices(NewFloorVertices);
+	TArray<int32> NewFloorLoopSizes = { NewFloorVertices.Num() };
 
-	// Keep iterating while there are still vertices
-	while (true)
+	TArray<FVector> HoleVertices;
+	for (const FRoomData* HoleRoom : HoleRooms)
 	{
-		if (!bKeepColinearVertices)
+		HoleRoom->GetLoopVertices(HoleVertices);
+		if (HoleVertices.Num() >= 3)
 		{
-			// Cull redundant vertex edges from the polygon.
-			for (int32 VertexIndex = 0; VertexIndex < PolyVerts.Num(); VertexIndex++)
-			{
-				const int32 I0 = (VertexIndex + 0) % PolyVerts.Num();
-				const int32 I1 = (VertexIndex + 1) % PolyVerts.Num();
-				const int32 I2 = (VertexIndex + 2) % PolyVerts.Num();
-				if (FGraphUtils::AreEdgesMergeable(PolyVerts[I0], PolyVerts[I1], PolyVerts[I2]))
-				{
-					PolyVerts.RemoveAt(I1);
-					OriginalVertIndices.RemoveAt(I1);
-					VertexIndex--;
-				}
-			}
+			NewFloorVertices.Append(HoleVertices);
+			NewFloorLoopSizes.Add(HoleVertices.Num());
 		}
+	}
+
+	if ((NewFloorVertices == FloorVertices) && (NewFloorLoopSizes == FloorLoopSizes))
+	{
+		return false;
+	}
+
+	FloorVertices = MoveTemp(NewFloorVertices);
+	FloorLoopSizes = MoveTemp(NewFloorLoopSizes);
+	bFloorDirty = true;
+	return true;
+}
 
-		if (PolyVerts.Num() < 3)
+bool FRoomData::TriangulateFloor(FRoomFloorTriangulation& OutTriangulation) const
+{
+	// Runs on worker threads, so it can't use a stage scope, which only times the game thread
+	TRACE_CPUPROFILER_EVENT_SCOPE(Modumate_TriangulateFloor);
+
+	OutTriangulation.TriangleIndices.Reset();
+	OutTriangulation.Area = 0.0f;
+	OutTriangulation.bTriangulated = false;
+	OutTriangulation.bSucceeded = true;
+	OutTriangulation.bCacheHit = false;
+
+	// Can't work if not enough verts for 1 triangle
+	if ((FloorLoopSizes.Num() == 0) || (FloorLoopSizes[0] < 3))
+	{
+		return true;
+	}
+
+	// Rooms are traced again whenever walls near them change, so unchanged floors come straight from the cache
+	OutTriangulation.bTriangulated = true;
+	ModumateCore::FTriangulationCache::FIndexBuffer PolyIndices = ModumateCore::FTriangulationCache::Get().Triangulate(
+		ModumateCore::TVertexArrayAccessor<FVector>(FloorVertices.GetData()), FloorLoopSizes.GetData(), FloorLoopSizes.Num(), ToCore(Normal),
+		&OutTriangulation.bCacheHit);
+	int32 FirstHoleVert = 0;
+	if (PolyIndices)
+	{
+		OutTriangulation.TriangleIndices.Append(PolyIndices->data(), PolyIndices->size());
+	}
+	else
+	{
+		// Rather than leave the room without a floor, ear clip its outer loop, which covers its islands too
+		OutTriangulation.bSucceeded = false;
+		int32 NumOuterVerts = FloorLoopSizes[0];
+		OutTriangulation.TriangleIndices.SetNumUninitialized(ModumateCore::GetMaxTriangleIndices(NumOuterVerts, 1));
+		int32 NumIndices = ModumateCore::TriangulatePolygon(ModumateCore::TVertexArrayAccessor<FVector>(FloorVertices.GetData()), NumOuterVerts,
+			ToCore(Normal), ModumateCore::GetThreadTriangulationScratch(), OutTriangulation.TriangleIndices.GetData());
+		if (NumIndices < 0)
 		{
-			break;
+			OutTriangulation.TriangleIndices.Reset();
+			return false;
 		}
-		else
-		{
-			// Look for an 'ear' triangle
-			bool bFoundEar = false;
-			for (int32 EarVertexIndex = 0; EarVertexIndex < PolyVerts.Num(); EarVertexIndex++)
-			{
-				// Triangle is 'this' vert plus the one before and after it
-				const int32 AIndex = (EarVertexIndex == 0) ? PolyVerts.Num() - 1 : EarVertexIndex - 1;
-				const int32 BIndex = EarVertexIndex;
-				const int32 CIndex = (EarVertexIndex + 1) % PolyVerts.Num();
-
-				// Check that this vertex is convex (cross product must be positive)
-				const FVector ABEdge = PolyVerts[BIndex] - PolyVerts[AIndex];
-				const FVector ACEdge = PolyVerts[CIndex] - PolyVerts[AIndex];
-				const float TriangleDeterminant = (ABEdge ^ ACEdge) | Normal;
-				if (!FMath::IsNegativeFloat(TriangleDeterminant))
-				{
-					continue;
-				}
-
-				bool bFoundVertInside = false;
-				// Look through all verts before this in array to see if any are inside triangle
-				for (int32 VertexIndex = 0; VertexIndex < PolyVerts.Num(); VertexIndex++)
-				{
-					if (VertexIndex != AIndex && VertexIndex != BIndex && VertexIndex != CIndex &&
-						FGraphUtils::PointInTriangle(PolyVerts[AIndex], PolyVerts[BIndex], PolyVerts[CIndex], PolyVerts[VertexIndex]))
-					{
-						bFoundVertInside = true;
-						break;
-					}
-				}
-
-				// Triangle with no verts inside - its an 'ear'! 
-				if (!bFoundVertInside)
-				{
-					// Add to output list..
-					TriangleIndices.Add(OriginalVertIndices[AIndex]);
-					TriangleIndices.Add(OriginalVertIndices[BIndex]);
-					TriangleIndices.Add(OriginalVertIndices[CIndex]);
-
-					// And remove vertex from polygon
-					PolyVerts.RemoveAt(EarVertexIndex);
-					OriginalVertIndices.RemoveAt(EarVertexIndex);
-
-					bFoundEar = true;
-					break;
-				}
-			}
 
-			// If we couldn't find an 'ear' it indicates something is bad with this polygon - discard triangles and return.
-			if (!bFoundEar)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Triangulation of poly failed."));
-				TriangleIndices.Empty();
-				return false;
-			}
+		OutTriangulation.TriangleIndices.SetNum(NumIndices);
+		FirstHoleVert = NumOuterVerts;
+	}
+
+	// Triangles wind clockwise around the normal, so their areas are negative
+	const TArray<int32>& Indices = OutTriangulation.TriangleIndices;
+	for (int32 TriIndex = 0; TriIndex + 2 < Indices.Num(); TriIndex += 3)
+	{
+		const FVector& A = FloorVertices[Indices[TriIndex]];
+		const FVector& B = FloorVertices[Indices[TriIndex + 1]];
+		const FVector& C = FloorVertices[Indices[TriIndex + 2]];
+		OutTriangulation.Area -= 0.5f * (((B - A) ^ (C - A)) | Normal);
+	}
+
+	// Holes that the ear clipped triangles cover anyway still come off of the floor's area, whichever way they wind
+	for (int32 LoopIndex = 1, LoopStart = FirstHoleVert; (FirstHoleVert > 0) && (LoopIndex < FloorLoopSizes.Num()); LoopStart += FloorLoopSizes[LoopIndex++])
+	{
+		float HoleArea = 0.0f;
+		for (int32 LoopVert = 0; LoopVert < FloorLoopSizes[LoopIndex]; ++LoopVert)
+		{
+			const FVector& A = FloorVertices[LoopStart + LoopVert];
+			const FVector& B = FloorVertices[LoopStart + (LoopVert + 1) % FloorLoopSizes[LoopIndex]];
+			HoleArea += 0.5f * ((A ^ B) | Normal);
 		}
+		OutTriangulation.Area -= FMath::Abs(HoleArea);
 	}
 
 	return true;
 }
 
+void FRoomData::CommitFloor(FRoomFloorTriangulation& Triangulation)
+{
+	if (Triangulation.bTriangulated)
+	{
+		FModumateCounters::AddTriangulationCacheLookup(Triangulation.bCacheHit);
+	}
+
+	if (!Triangulation.bSucceeded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Triangulation of room #%d's floor with %d holes failed, %s."), ID, FloorLoopSizes.Num() - 1,
+			(Triangulation.TriangleIndices.Num() > 0) ? TEXT("so it was ear clipped without them") : TEXT("even without them"));
+	}
+
+	// Copied rather than moved, so that both the room's indices and the triangulation's keep their capacity for next time
+	TriangleIndices.Reset();
+	TriangleIndices.Append(Triangulation.TriangleIndices);
+	Area = Triangulation.Area;
+	bFloorDirty = false;
+
+	FModumateCounters::AddTrianglesEmitted(TriangleIndices.Num() / 3);
+}
+
 
 ARoom::ARoom(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, GraphFace(INDEX_NONE)
+	, LoopBounds(ForceInit)
+	, HostRoom(nullptr)
 {
 	PrimaryActorTick.bCanEverTick = false;
 	PrimaryActorTick.bStartWithTickEnabled = false;
@@ -462,6 +471,11 @@ bool ARoom::IsInterior() const
 	return !RoomData.IsClockWise();
 }
 
+float ARoom::GetFloorArea() const
+{
+	return RoomData.Area;
+}
+
 void ARoom::DebugDraw(float Duration) const
 {
 	TArray<FString> DebugWallStrings;
@@ -474,14 +488,9 @@ void ARoom::DebugDraw(float Duration) const
 
 	if (RoomData.TriangleIndices.Num() > 0)
 	{
-		TArray<FVector> DebugVertices;
-		for (ARoomNode* RoomNode : RoomData.Nodes)
-		{
-			DebugVertices.Add(RoomNode->GetActorLocation());
-		}
 		FLinearColor DebugRoomHSVColor(360.0f * FMath::Fmod(PI * RoomData.ID, 1.0f), 1.0f, 1.0f);
 		FColor DebugRoomColor = DebugRoomHSVColor.HSVToLinearRGB().ToFColor(false);
-		DrawDebugMesh(GetWorld(), DebugVertices, RoomData.TriangleIndices, DebugRoomColor, Duration > 0.0f, Duration, 0);
+		DrawDebugMesh(GetWorld(), RoomData.FloorVertices, RoomData.TriangleIndices, DebugRoomColor, Duration > 0.0f, Duration, 0);
 	}
 }
 
@@ -490,6 +499,12 @@ void ARoom::UpdateRoomData(const FRoomData& NewRoomData)
 	RoomData = NewRoomData;
 }
 
+void ARoom::CacheLoop()
+{
+	RoomData.GetLoopVertices(LoopVertices);
+	LoopBounds = FBox(LoopVertices);
+}
+
 TSharedPtr<FJsonObject> ARoom::SerializeToJson() const
 {
 	TSharedPtr<FJsonObject> ResultJson = MakeShareable(new FJsonObject());
@@ -12,6 +12,8 @@
 #include "EditManager.h"
 #include "RoomNode.h"
 #include "Room.h"
+#include "ModumateGeometry.h"
+#include "ModumateCoreConversions.h"
 
 
 FWallIntersection::FWallIntersection()
@@ -24,23 +26,6 @@ void FWallIntersection::Init()
 	FMemory::Memzero(this, sizeof(FWallIntersection));
 }
 
-
-void FWallBox::AddVerts()
-{
-	if (wallVertices.Num() < 1)
-	{
-		wallVertices.Add(b_LeftSideStart);
-		wallVertices.Add(b_RightSideStart);
-		wallVertices.Add(b_RightSideEnd);
-		wallVertices.Add(b_LeftSideEnd);
-		wallVertices.Add(t_LeftSideStart);
-		wallVertices.Add(t_RightSideStart);
-		wallVertices.Add(t_RightSideEnd);
-		wallVertices.Add(t_LeftSideEnd);
-	}
-
-}
-
 AWall::AWall(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, ID(-1)
@@ -68,6 +53,13 @@ AWall::AWall(const FObjectInitializer& ObjectInitializer)
 	, DestRightWall(nullptr)
 	, LeftRoom(nullptr)
 	, RightRoom(nullptr)
+	, GraphEdge(INDEX_NONE)
+	, wallThickness(0.0f)
+	, wallHeight(0.0f)
+	, bPreviewingOpening(false)
+	, PreviewSpanStart(0.0f)
+	, PreviewSpanEnd(0.0f)
+	, GeneratedMesh(nullptr)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
@@ -296,6 +288,12 @@ FVector AWall::GetWallDirFrom(ARoomNode* Node) const
 }
 
 void AWall::SetEndPoint(const FVector& NewEndPoint)
+{
+	DragEndPoint(NewEndPoint);
+	UpdateWallTransform();
+}
+
+void AWall::DragEndPoint(const FVector& NewEndPoint)
 {
 	EndPoint = NewEndPoint;
 	EndPoint.Z = StartPoint.Z;	// for now, assume walls will be on flat floor
@@ -318,19 +316,9 @@ void AWall::SetEndPoint(const FVector& NewEndPoint)
 	}
 
 	FVector WallDir = WallDelta / WallLength;
-	FVector WallRelScale = GetActorRelativeScale3D();
-
-	FQuat WallRot(FRotationMatrix::MakeFromXZ(WallDir, FloorNormal));
 	FVector WallMidPoint = 0.5f * (StartPoint + EndPoint);
 
-	FVector WallScale(WallLength / OriginalBounds.GetSize().X, WallRelScale.Y, WallRelScale.Z);
-
-	SetActorTransform(FTransform(WallRot, WallMidPoint, WallScale), false, nullptr, ETeleportType::TeleportPhysics);
-
-	
-
-
-	FVector WallRight = WallRot.GetRightVector();
+	FVector WallRight = FVector::CrossProduct(FloorNormal, WallDir);
 	//DimensionTextComponent->SetVisibility(true);
 	FVector TextPosition = WallMidPoint + DimensionTextOffset.Y * WallRight + DimensionTextOffset.Z * FloorNormal;
 	FQuat TextRot(FRotationMatrix::MakeFromXZ(FloorNormal, -WallRight));
@@ -340,6 +328,28 @@ void AWall::SetEndPoint(const FVector& NewEndPoint)
 	//DimensionTextComponent->SetText(FText::FromString(FString::Printf(TEXT("%.2f"), 0.01f * WallLength)));
 }
 
+void AWall::UpdateWallTransform()
+{
+	FVector FloorNormal = FVector::UpVector;
+
+	FVector WallDelta = EndPoint - StartPoint;
+	float WallLength = WallDelta.Size();
+	if (WallLength == 0.0f)
+	{
+		return;
+	}
+
+	FVector WallDir = WallDelta / WallLength;
+	FVector WallRelScale = GetActorRelativeScale3D();
+
+	FQuat WallRot(FRotationMatrix::MakeFromXZ(WallDir, FloorNormal));
+	FVector WallMidPoint = 0.5f * (StartPoint + EndPoint);
+
+	FVector WallScale(WallLength / OriginalBounds.GetSize().X, WallRelScale.Y, WallRelScale.Z);
+
+	SetActorTransform(FTransform(WallRot, WallMidPoint, WallScale), false, nullptr, ETeleportType::TeleportPhysics);
+}
+
 void AWall::AttachFixture(AStaticMeshActor* Fixture)
 {
 	
@@ -472,26 +482,6 @@ void AWall::RemovePrevDimStrings()
 	
 }
 
-bool AWall::SortConnectedWalls()
-{
-	bool bChanged = false;
-	if (FindLeftAndRightWalls(true, SourceLeftWall, SourceRightWall))
-	{
-		bChanged = true;
-	}
-	if (FindLeftAndRightWalls(false, DestRightWall, DestLeftWall))
-	{
-		bChanged = true;
-	}
-
-	if (bChanged)
-	{
-		DebugDrawConnectedWalls();
-	}
-
-	return bChanged;
-}
-
 void AWall::DebugDrawConnectedWalls()
 {
 	if (UWorld* World = GetWorld())
@@ -534,66 +524,15 @@ bool AWall::GetWallIntersection2D(AWall* OtherWall, FWallIntersection& WallInter
 {
 	WallIntersection.Init();
 
-	FVector ThisDelta = EndPoint - StartPoint;
-	ThisDelta.Z = 0.0f;
-
-	const FVector& OtherStart = OtherWall->StartPoint;
-	const FVector& OtherEnd = OtherWall->EndPoint;
-	FVector OtherDelta = OtherEnd - OtherStart;
-	OtherDelta.Z = 0.0f;
-
-	float ThisLength = ThisDelta.Size();
-	float OtherLength = OtherDelta.Size();
-	if (FMath::IsNearlyZero(ThisLength, Epsilon) || FMath::IsNearlyZero(OtherLength, Epsilon))
-	{
-		return false;
-	}
-
-	FVector ThisDir = ThisDelta / ThisLength;
-	FVector OtherDir = OtherDelta / OtherLength;
-	if (FVector::Parallel(ThisDir, OtherDir, 1.0f - Epsilon))
-	{
-		return false;
-	}
-
-	FMatrix2x2 DenominatorMatrix(-ThisDelta.X, -ThisDelta.Y, -OtherDelta.X, -OtherDelta.Y);
-	float Denominator = DenominatorMatrix.Determinant();
-	if (FMath::IsNearlyZero(Denominator, Epsilon))
-	{
-		return false;
-	}
-
-	FMatrix2x2 InnerNumeratorMatrixThis(StartPoint.X, StartPoint.Y, EndPoint.X, EndPoint.Y);
-	FMatrix2x2 InnerNumeratorMatrixOther(OtherStart.X, OtherStart.Y, OtherEnd.X, OtherEnd.Y);
-	float InnerNumeratorThis = InnerNumeratorMatrixThis.Determinant();
-	float InnerNumeratorOther = InnerNumeratorMatrixOther.Determinant();
-
-	FMatrix2x2 XNumeratorMatrix(InnerNumeratorThis, -ThisDelta.X, InnerNumeratorOther, -OtherDelta.X);
-	FMatrix2x2 YNumeratorMatrix(InnerNumeratorThis, -ThisDelta.Y, InnerNumeratorOther, -OtherDelta.Y);
-	float XNumerator = XNumeratorMatrix.Determinant();
-	float YNumerator = YNumeratorMatrix.Determinant();
-
-	WallIntersection.Location.Set(XNumerator / Denominator, YNumerator / Denominator, 0.0f);
-
-	FVector ThisToIntersection = WallIntersection.Location - StartPoint;
-	ThisToIntersection.Z = 0.0f;
-	WallIntersection.DistAlongQueryWall = ThisToIntersection | ThisDir;
-	FVector ThisIntersection = StartPoint + WallIntersection.DistAlongQueryWall * ThisDir;
-
-	FVector OtherToIntersection = WallIntersection.Location - OtherStart;
-	OtherToIntersection.Z = 0.0f;
-	WallIntersection.DistAlongHitWall = OtherToIntersection | OtherDir;
-	FVector OtherIntersection = OtherStart + WallIntersection.DistAlongHitWall * OtherDir;
-
-	WallIntersection.Location.Z = 0.5f * (ThisIntersection.Z + OtherIntersection.Z);
-
-	float DistPctAlongThis = WallIntersection.DistAlongQueryWall / ThisLength;
-	float DistPctAlongOther = WallIntersection.DistAlongHitWall / OtherLength;
-
-	bool bHit = (DistPctAlongThis >= Epsilon && DistPctAlongThis <= (1.0f - Epsilon) &&
-				DistPctAlongOther >= Epsilon && DistPctAlongOther <= (1.0f - Epsilon));
+	ModumateCore::FSegmentIntersection Intersection = { ToCore(WallIntersection.Location), WallIntersection.DistAlongQueryWall, WallIntersection.DistAlongHitWall };
+	bool bHit = ModumateCore::IntersectSegments2D(ToCore(StartPoint), ToCore(EndPoint),
+		ToCore(OtherWall->StartPoint), ToCore(OtherWall->EndPoint), Intersection, Epsilon);
 
 	WallIntersection.HitWall = bHit ? OtherWall : nullptr;
+	WallIntersection.Location = FromCore(Intersection.Location);
+	WallIntersection.DistAlongQueryWall = Intersection.DistAlongA;
+	WallIntersection.DistAlongHitWall = Intersection.DistAlongB;
+
 	return bHit;
 }
 
@@ -624,27 +563,14 @@ bool AWall::DeserializeFromJson(const TSharedPtr<FJsonObject>& JsonObject)
 	auto EndPointJson = JsonObject->GetArrayField(GET_MEMBER_NAME_STRING_CHECKED(AWall, EndPoint));
 	EndPoint.Set(EndPointJson[0]->AsNumber(), EndPointJson[1]->AsNumber(), EndPointJson[2]->AsNumber());
 
+	// The start node was spawned with the wall, so move it along with the deserialized start point.
+	if (StartNode)
+	{
+		StartNode->SetActorLocation(StartPoint);
+	}
+
 	SetEndPoint(EndPoint);
 	bPlaced = true;
 
 	return true;
 }
-
-bool AWall::FindLeftAndRightWalls(bool bForward, AWall*& LeftWall, AWall*& RightWall)
-{
-	AWall* NewLeftWall = nullptr;
-	AWall* NewRightWall = nullptr;
-	ARoomNode* AdjacentNode = bForward ? StartNode : EndNode;
-
-	if (ensureAlways(AdjacentNode) && AdjacentNode->FindAdjacentWalls(this, NewLeftWall, NewRightWall))
-	{
-		if ((LeftWall != NewLeftWall) || (RightWall != NewRightWall))
-		{
-			LeftWall = NewLeftWall;
-			RightWall = NewRightWall;
-			return true;
-		}
-	}
-
-	return false;
-}
@@ -0,0 +1,560 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WallCluster.h"
+
+#include "Engine/World.h"
+#include "Materials/MaterialInterface.h"
+#include "ProceduralMeshComponent.h"
+#include "Wall.h"
+#include "ModumateMeshJobs.h"
+#include "ModumateMeshLODs.h"
+#include "ModumateCoreConversions.h"
+#include "ModumateSurfaceKernel.h"
+
+#include <vector>
+
+AWallCluster::AWallCluster(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Mesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("Mesh"));
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RootComponent = Mesh;
+}
+
+namespace
+{
+	// A wall in a cluster, copied so that the cluster can be meshed on a worker thread, along with where its own mesh puts it
+	struct FClusterWallInputs
+	{
+		FVector StartPoint;
+		FVector EndPoint;
+		float HalfThickness;
+		float Height;
+		ModumateCore::FWallOpeningList Openings;
+		FMatrix LocalToWorld;
+	};
+
+	struct FClusterCoreMesh
+	{
+		std::vector<ModumateCore::FVec3> Vertices;
+		std::vector<ModumateCore::FVec3> Normals;
+		std::vector<int32_t> Indices;
+		std::vector<ModumateCore::FVec3> Tangents;
+		std::vector<ModumateCore::FVec2> UVs;
+	};
+
+	thread_local FClusterCoreMesh ThreadClusterCoreMesh;
+
+	// Opening quads sit this far out from their walls' slabs, so that they don't fight with them
+	const float OpeningQuadOffset = 0.5f;
+
+	// Appends a core mesh of the wall to the cluster's, where the wall's own mesh would draw it. It's shaded once it's there,
+	// since the cluster is at the origin, so that its UVs are world-aligned and line up with its neighbors' across the cluster.
+	void AppendCoreMesh(const FClusterWallInputs& Wall, FClusterCoreMesh& CoreMesh, FModumateMeshBuffers& OutBuffers)
+	{
+		size_t NumVertices = CoreMesh.Vertices.size();
+		for (ModumateCore::FVec3& Vertex : CoreMesh.Vertices)
+		{
+			Vertex = ToCore(FVector(Wall.LocalToWorld.TransformPosition(FromCore(Vertex))));
+		}
+
+		CoreMesh.Tangents.resize(NumVertices);
+		CoreMesh.UVs.resize(NumVertices);
+		ModumateCore::ComputeFlatSurface(CoreMesh.Vertices.data(), static_cast<int32_t>(NumVertices), CoreMesh.Indices.data(),
+			static_cast<int32_t>(CoreMesh.Indices.size()), 0.01f, CoreMesh.Normals.data(), CoreMesh.Tangents.data(), CoreMesh.UVs.data());
+
+		int32 FirstVertex = OutBuffers.Vertices.Num();
+		for (size_t i = 0; i < NumVertices; i++)
+		{
+			OutBuffers.Vertices.Add(FromCore(CoreMesh.Vertices[i]));
+			OutBuffers.Normals.Add(FromCore(CoreMesh.Normals[i]));
+			OutBuffers.Tangents.Add(FProcMeshTangent(FromCore(CoreMesh.Tangents[i]), false));
+			OutBuffers.UV0.Add(FromCore(CoreMesh.UVs[i]));
+		}
+
+		for (int32_t Index : CoreMesh.Indices)
+		{
+			OutBuffers.Triangles.Add(FirstVertex + Index);
+		}
+	}
+
+	void AppendWallMesh(const FClusterWallInputs& Wall, FModumateMeshBuffers& OutBuffers)
+	{
+		FClusterCoreMesh& CoreMesh = ThreadClusterCoreMesh;
+		ModumateCore::BuildWallMesh(ToCore(Wall.StartPoint), ToCore(Wall.EndPoint), Wall.HalfThickness, Wall.Height, Wall.Openings,
+			CoreMesh.Vertices, CoreMesh.Normals, CoreMesh.Indices);
+		AppendCoreMesh(Wall, CoreMesh, OutBuffers);
+	}
+
+	void AppendWallSlab(const FClusterWallInputs& Wall, FModumateMeshBuffers& OutBuffers)
+	{
+		FClusterCoreMesh& CoreMesh = ThreadClusterCoreMesh;
+		ModumateCore::BuildWallSlabMesh(ToCore(Wall.StartPoint), ToCore(Wall.EndPoint), Wall.HalfThickness, Wall.Height,
+			CoreMesh.Vertices, CoreMesh.Normals, CoreMesh.Indices);
+		AppendCoreMesh(Wall, CoreMesh, OutBuffers);
+	}
+
+	void AppendWallOpeningQuads(const FClusterWallInputs& Wall, FModumateMeshBuffers& OutBuffers)
+	{
+		FClusterCoreMesh& CoreMesh = ThreadClusterCoreMesh;
+		ModumateCore::BuildWallOpeningQuads(ToCore(Wall.StartPoint), ToCore(Wall.EndPoint), Wall.HalfThickness, Wall.Height, Wall.Openings,
+			OpeningQuadOffset, CoreMesh.Vertices, CoreMesh.Normals, CoreMesh.Indices);
+		AppendCoreMesh(Wall, CoreMesh, OutBuffers);
+	}
+}
+
+FWallClusters::FWallClusters(float InCellSize)
+	: CellSize(InCellSize)
+{
+}
+
+void FWallClusters::SetCellSize(float InCellSize)
+{
+	if (InCellSize == CellSize)
+	{
+		return;
+	}
+
+	CellSize = InCellSize;
+
+	TArray<AWall*> ClusteredWalls;
+	for (auto& WallCellPair : WallCells)
+	{
+		if (AWall* Wall = WallCellPair.Key.Get())
+		{
+			ClusteredWalls.Add(Wall);
+		}
+	}
+
+	for (AWall* Wall : ClusteredWalls)
+	{
+		AddOrUpdateWall(Wall);
+	}
+}
+
+void FWallClusters::Empty(FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs)
+{
+	for (auto& ClusterPair : Clusters)
+	{
+		if (AWallCluster* ClusterActor = ClusterPair.Value.Actor.Get())
+		{
+			MeshJobs.Cancel(ClusterActor->Mesh);
+			MeshLODs.Remove(ClusterActor->Mesh);
+			ClusterActor->Destroy();
+		}
+	}
+
+	for (auto& WallCellPair : WallCells)
+	{
+		AWall* Wall = WallCellPair.Key.Get();
+		if (Wall && Wall->GeneratedMesh)
+		{
+			Wall->GeneratedMesh->SetVisibility(true);
+		}
+	}
+
+	Clusters.Empty();
+	WallCells.Empty();
+	SelectedWalls.Empty();
+	EditingWalls.Empty();
+	DirtyCells.Empty();
+}
+
+void FWallClusters::SetOpeningMaterial(UMaterialInterface* InOpeningMaterial)
+{
+	if (InOpeningMaterial == OpeningMaterial.Get())
+	{
+		return;
+	}
+
+	OpeningMaterial = InOpeningMaterial;
+	for (auto& ClusterPair : Clusters)
+	{
+		ClusterPair.Value.bOpeningsDirty = true;
+		DirtyCells.Add(ClusterPair.Key);
+	}
+}
+
+FIntVector FWallClusters::GetCell(const AWall* Wall) const
+{
+	FVector MidPoint = 0.5f * (Wall->StartPoint + Wall->EndPoint);
+	return FIntVector(
+		FMath::FloorToInt(MidPoint.X / CellSize),
+		FMath::FloorToInt(MidPoint.Y / CellSize),
+		FMath::FloorToInt(MidPoint.Z / CellSize));
+}
+
+void FWallClusters::AddOrUpdateWall(AWall* Wall)
+{
+	FIntVector NewCell = GetCell(Wall);
+	if (FIntVector* OldCell = WallCells.Find(Wall))
+	{
+		if (*OldCell != NewCell)
+		{
+			MarkWallDirty(*OldCell, Wall);
+			Clusters[*OldCell].Walls.Remove(Wall);
+			Clusters.FindOrAdd(NewCell).Walls.Add(Wall);
+			*OldCell = NewCell;
+		}
+	}
+	else
+	{
+		Clusters.FindOrAdd(NewCell).Walls.Add(Wall);
+		WallCells.Add(Wall, NewCell);
+	}
+
+	// The cluster still has the wall as it was, so its own mesh is shown until the cluster catches up
+	if (Wall->GeneratedMesh)
+	{
+		Wall->GeneratedMesh->SetVisibility(true);
+	}
+	MarkWallDirty(NewCell, Wall);
+}
+
+void FWallClusters::RemoveWall(AWall* Wall)
+{
+	FIntVector Cell;
+	if (WallCells.RemoveAndCopyValue(Wall, Cell))
+	{
+		MarkWallDirty(Cell, Wall);
+		Clusters[Cell].Walls.Remove(Wall);
+	}
+
+	SelectedWalls.Remove(Wall);
+	EditingWalls.Remove(Wall);
+}
+
+void FWallClusters::SetWallSelected(AWall* Wall, bool bSelected)
+{
+	SetWallSeparate(Wall, SelectedWalls, bSelected);
+}
+
+void FWallClusters::SetWallEditing(AWall* Wall, bool bEditing)
+{
+	SetWallSeparate(Wall, EditingWalls, bEditing);
+}
+
+void FWallClusters::SetWallSeparate(AWall* Wall, TSet<TWeakObjectPtr<AWall>>& Reasons, bool bReason)
+{
+	bool bWasSeparate = IsSeparate(Wall);
+	if (bReason)
+	{
+		Reasons.Add(Wall);
+	}
+	else
+	{
+		Reasons.Remove(Wall);
+	}
+
+	bool bSeparate = IsSeparate(Wall);
+	if (bSeparate == bWasSeparate)
+	{
+		return;
+	}
+
+	// A wall that leaves its cluster is shown right away, and one that rejoins it stays shown until the cluster has it again
+	if (bSeparate && Wall->GeneratedMesh)
+	{
+		Wall->GeneratedMesh->SetVisibility(true);
+	}
+
+	if (const FIntVector* Cell = WallCells.Find(Wall))
+	{
+		MarkWallDirty(*Cell, Wall);
+	}
+}
+
+void FWallClusters::MarkWallDirty(const FIntVector& Cell, AWall* Wall)
+{
+	FCluster* Cluster = Clusters.Find(Cell);
+	if (!Cluster)
+	{
+		return;
+	}
+
+	// Both the material that the wall was drawn with and the one it has now need their sections remeshed
+	if (const TWeakObjectPtr<UMaterialInterface>* DrawnMaterial = Cluster->DrawnMaterials.Find(Wall))
+	{
+		Cluster->DirtyMaterials.Add(*DrawnMaterial);
+	}
+	if (Wall->GeneratedMesh)
+	{
+		Cluster->DirtyMaterials.Add(Wall->GeneratedMesh->GetMaterial(0));
+	}
+	Cluster->bOpeningsDirty = true;
+	DirtyCells.Add(Cell);
+}
+
+void FWallClusters::RebuildDirtyClusters(UWorld* World, FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs)
+{
+	for (const FIntVector& Cell : DirtyCells)
+	{
+		RebuildCluster(World, MeshJobs, MeshLODs, Cell);
+	}
+
+	DirtyCells.Empty();
+}
+
+void FWallClusters::RemoveStaleWalls(FCluster& Cluster)
+{
+	for (int32 WallIndex = Cluster.Walls.Num() - 1; WallIndex >= 0; --WallIndex)
+	{
+		const TWeakObjectPtr<AWall>& WeakWall = Cluster.Walls[WallIndex];
+		if (!WeakWall.IsValid())
+		{
+			// Stale weak pointers keep their hash, so they still find the walls' other entries
+			WallCells.Remove(WeakWall);
+			SelectedWalls.Remove(WeakWall);
+			EditingWalls.Remove(WeakWall);
+			Cluster.Walls.RemoveAtSwap(WallIndex);
+		}
+	}
+}
+
+void FWallClusters::RebuildCluster(UWorld* World, FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs, const FIntVector& Cell)
+{
+	FCluster* Cluster = Clusters.Find(Cell);
+	if (!Cluster)
+	{
+		return;
+	}
+
+	// Find the walls that are drawn by the cluster, and catch any whose material changed without them being updated
+	RemoveStaleWalls(*Cluster);
+	TMap<TWeakObjectPtr<AWall>, TWeakObjectPtr<UMaterialInterface>> DrawnMaterials;
+	for (const TWeakObjectPtr<AWall>& WeakWall : Cluster->Walls)
+	{
+		AWall* Wall = WeakWall.Get();
+		if (IsSeparate(Wall) || !Wall->GeneratedMesh)
+		{
+			continue;
+		}
+
+		TWeakObjectPtr<UMaterialInterface> Material = Wall->GeneratedMesh->GetMaterial(0);
+		DrawnMaterials.Add(WeakWall, Material);
+		const TWeakObjectPtr<UMaterialInterface>* DrawnMaterial = Cluster->DrawnMaterials.Find(WeakWall);
+		if (!DrawnMaterial || (*DrawnMaterial != Material))
+		{
+			Cluster->DirtyMaterials.Add(Material);
+			Cluster->bOpeningsDirty = true;
+		}
+	}
+	for (auto& DrawnPair : Cluster->DrawnMaterials)
+	{
+		const TWeakObjectPtr<UMaterialInterface>* Material = DrawnMaterials.Find(DrawnPair.Key);
+		if (!Material || (*Material != DrawnPair.Value))
+		{
+			Cluster->DirtyMaterials.Add(DrawnPair.Value);
+			Cluster->bOpeningsDirty = true;
+		}
+	}
+	Cluster->DrawnMaterials = MoveTemp(DrawnMaterials);
+
+	AWallCluster* ClusterActor = Cluster->Actor.Get();
+	if (Cluster->DrawnMaterials.Num() == 0)
+	{
+		if (ClusterActor)
+		{
+			MeshJobs.Cancel(ClusterActor->Mesh);
+			MeshLODs.Remove(ClusterActor->Mesh);
+			ClusterActor->Destroy();
+		}
+
+		if (Cluster->Walls.Num() == 0)
+		{
+			Clusters.Remove(Cell);
+		}
+		else
+		{
+			Cluster->Actor = nullptr;
+			Cluster->Slots.Empty();
+			Cluster->DirtyMaterials.Empty();
+			Cluster->bOpeningsDirty = false;
+			Cluster->bHasOpenings = false;
+			Cluster->DetailSections.Empty();
+			Cluster->SimplifiedSections.Empty();
+		}
+		return;
+	}
+
+	// A new actor has none of the sections yet, so all of them are meshed
+	if (!ClusterActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		ClusterActor = World->SpawnActor<AWallCluster>(AWallCluster::StaticClass(), FTransform::Identity, SpawnParams);
+		Cluster->Actor = ClusterActor;
+		Cluster->Slots.Empty();
+		for (auto& DrawnPair : Cluster->DrawnMaterials)
+		{
+			Cluster->DirtyMaterials.Add(DrawnPair.Value);
+		}
+		Cluster->bOpeningsDirty = true;
+	}
+
+	// Only the sections of the materials whose walls changed are remeshed, and materials without any walls left free theirs
+	for (const TWeakObjectPtr<UMaterialInterface>& Material : Cluster->DirtyMaterials)
+	{
+		TArray<FClusterWallInputs> WallInputs;
+		TArray<TWeakObjectPtr<AWall>> MeshedWalls;
+		for (auto& DrawnPair : Cluster->DrawnMaterials)
+		{
+			AWall* Wall = DrawnPair.Key.Get();
+			if (Wall && (DrawnPair.Value == Material))
+			{
+				FMatrix LocalToWorld = Wall->GeneratedMesh->GetComponentTransform().ToMatrixWithScale();
+				WallInputs.Add({ Wall->StartPoint, Wall->EndPoint, Wall->wallThickness, Wall->wallHeight, Wall->Openings,
+					LocalToWorld });
+				MeshedWalls.Add(Wall);
+			}
+		}
+
+		int32 SlotIndex = Cluster->Slots.IndexOfByPredicate([&Material](const FClusterSlot& Slot) { return Slot.bUsed && (Slot.Material == Material); });
+		if (WallInputs.Num() == 0)
+		{
+			if (SlotIndex != INDEX_NONE)
+			{
+				ClearSlot(ClusterActor, MeshJobs, Cluster->Slots[SlotIndex], SlotIndex);
+			}
+			continue;
+		}
+
+		if (SlotIndex == INDEX_NONE)
+		{
+			SlotIndex = Cluster->Slots.IndexOfByPredicate([](const FClusterSlot& Slot) { return !Slot.bUsed; });
+			if (SlotIndex == INDEX_NONE)
+			{
+				SlotIndex = Cluster->Slots.AddDefaulted();
+			}
+			Cluster->Slots[SlotIndex].Material = Material;
+			Cluster->Slots[SlotIndex].bUsed = true;
+		}
+
+		int32 SimplifiedSection = GetSimplifiedSection(SlotIndex);
+		MeshJobs.Submit(ClusterActor->Mesh, SimplifiedSection, false,
+			[WallInputs](FModumateMeshBuffers& OutBuffers)
+			{
+				for (const FClusterWallInputs& Wall : WallInputs)
+				{
+					AppendWallSlab(Wall, OutBuffers);
+				}
+			},
+			[this, &MeshLODs, Cell, SimplifiedSection, Material](UProceduralMeshComponent* ClusterMesh, const FModumateMeshBuffers& Buffers)
+			{
+				ClusterMesh->SetMaterial(SimplifiedSection, Material.Get());
+				ShowClusterLOD(MeshLODs, ClusterMesh, Cell);
+			});
+
+		int32 DetailSection = GetDetailSection(SlotIndex);
+		MeshJobs.Submit(ClusterActor->Mesh, DetailSection, false,
+			[WallInputs = MoveTemp(WallInputs)](FModumateMeshBuffers& OutBuffers)
+			{
+				for (const FClusterWallInputs& Wall : WallInputs)
+				{
+					AppendWallMesh(Wall, OutBuffers);
+				}
+			},
+			[this, &MeshLODs, Cell, DetailSection, Material, MeshedWalls = MoveTemp(MeshedWalls)](UProceduralMeshComponent* ClusterMesh, const FModumateMeshBuffers& Buffers)
+			{
+				ClusterMesh->SetMaterial(DetailSection, Material.Get());
+				ShowClusterLOD(MeshLODs, ClusterMesh, Cell);
+
+				// Only hide the walls that are still drawn by this cluster, as they were when it was meshed
+				for (const TWeakObjectPtr<AWall>& WeakWall : MeshedWalls)
+				{
+					AWall* Wall = WeakWall.Get();
+					const FIntVector* WallCell = Wall ? WallCells.Find(Wall) : nullptr;
+					if (WallCell && (*WallCell == Cell) && !IsSeparate(Wall) && !DirtyCells.Contains(Cell) && Wall->GeneratedMesh)
+					{
+						Wall->GeneratedMesh->SetVisibility(false);
+					}
+				}
+			});
+	}
+	Cluster->DirtyMaterials.Empty();
+
+	// The opening quads of every material's walls share one section, since they all have the same material
+	if (Cluster->bOpeningsDirty)
+	{
+		TArray<FClusterWallInputs> WallInputs;
+		if (OpeningMaterial.IsValid())
+		{
+			for (auto& DrawnPair : Cluster->DrawnMaterials)
+			{
+				AWall* Wall = DrawnPair.Key.Get();
+				if (Wall && (Wall->Openings.Num() > 0))
+				{
+					FMatrix LocalToWorld = Wall->GeneratedMesh->GetComponentTransform().ToMatrixWithScale();
+					WallInputs.Add({ Wall->StartPoint, Wall->EndPoint, Wall->wallThickness, Wall->wallHeight, Wall->Openings,
+						LocalToWorld });
+				}
+			}
+		}
+
+		Cluster->bHasOpenings = (WallInputs.Num() > 0);
+		if (Cluster->bHasOpenings)
+		{
+			MeshJobs.Submit(ClusterActor->Mesh, GetOpeningSection(), false,
+				[WallInputs = MoveTemp(WallInputs)](FModumateMeshBuffers& OutBuffers)
+				{
+					for (const FClusterWallInputs& Wall : WallInputs)
+					{
+						AppendWallOpeningQuads(Wall, OutBuffers);
+					}
+				},
+				[this, &MeshLODs, Cell, Material = OpeningMaterial](UProceduralMeshComponent* ClusterMesh, const FModumateMeshBuffers& Buffers)
+				{
+					ClusterMesh->SetMaterial(GetOpeningSection(), Material.Get());
+					ShowClusterLOD(MeshLODs, ClusterMesh, Cell);
+				});
+		}
+		else
+		{
+			MeshJobs.Cancel(ClusterActor->Mesh, GetOpeningSection());
+			ClusterActor->Mesh->ClearMeshSection(GetOpeningSection());
+		}
+		Cluster->bOpeningsDirty = false;
+	}
+
+	// Sections that are added are shown as they're uploaded, which switches the cluster back to its LOD then,
+	// but a section that's been freed or emptied has to be taken out of its LODs now
+	TArray<int32> DetailSections, SimplifiedSections;
+	if (Cluster->bHasOpenings)
+	{
+		SimplifiedSections.Add(GetOpeningSection());
+	}
+	for (int32 SlotIndex = 0; SlotIndex < Cluster->Slots.Num(); ++SlotIndex)
+	{
+		if (Cluster->Slots[SlotIndex].bUsed)
+		{
+			DetailSections.Add(GetDetailSection(SlotIndex));
+			SimplifiedSections.Add(GetSimplifiedSection(SlotIndex));
+		}
+	}
+	if ((DetailSections != Cluster->DetailSections) || (SimplifiedSections != Cluster->SimplifiedSections))
+	{
+		Cluster->DetailSections = MoveTemp(DetailSections);
+		Cluster->SimplifiedSections = MoveTemp(SimplifiedSections);
+		MeshLODs.SetLODSections(ClusterActor->Mesh, Cluster->DetailSections, Cluster->SimplifiedSections);
+	}
+}
+
+void FWallClusters::ClearSlot(AWallCluster* ClusterActor, FModumateMeshJobQueue& MeshJobs, FClusterSlot& Slot, int32 SlotIndex)
+{
+	for (int32 SectionIndex : { GetDetailSection(SlotIndex), GetSimplifiedSection(SlotIndex) })
+	{
+		MeshJobs.Cancel(ClusterActor->Mesh, SectionIndex);
+		ClusterActor->Mesh->ClearMeshSection(SectionIndex);
+	}
+	Slot.Material = nullptr;
+	Slot.bUsed = false;
+}
+
+void FWallClusters::ShowClusterLOD(FModumateMeshLODs& MeshLODs, UProceduralMeshComponent* ClusterMesh, const FIntVector& Cell) const
+{
+	// The cluster's sections are looked up when each one is uploaded, since they may have changed since it was submitted
+	if (const FCluster* Cluster = Clusters.Find(Cell))
+	{
+		MeshLODs.SetLODSections(ClusterMesh, Cluster->DetailSections, Cluster->SimplifiedSections);
+	}
+}
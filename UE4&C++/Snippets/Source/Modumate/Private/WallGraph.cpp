@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WallGraph.h"
+
+void FWallGraph::Empty()
+{
+	Vertices.Empty();
+	HalfEdges.Empty();
+	EdgeWalls.Empty();
+	Faces.Empty();
+	FreeVertices.Empty();
+	FreeEdges.Empty();
+	FreeFaces.Empty();
+}
+
+int32 FWallGraph::AddVertex(ARoomNode* Node, const FVector2D& Position)
+{
+	int32 Vertex = (FreeVertices.Num() > 0) ? FreeVertices.Pop(false) : Vertices.AddDefaulted();
+
+	FWallGraphVertex& NewVertex = Vertices[Vertex];
+	NewVertex.Position = Position;
+	NewVertex.Node = Node;
+	NewVertex.OutgoingHalfEdges.Reset();
+	NewVertex.bValid = true;
+
+	return Vertex;
+}
+
+void FWallGraph::RemoveVertex(int32 Vertex)
+{
+	if (!Vertices.IsValidIndex(Vertex) || !Vertices[Vertex].bValid)
+	{
+		return;
+	}
+
+	FWallGraphVertex& OldVertex = Vertices[Vertex];
+	ensureAlwaysMsgf(OldVertex.OutgoingHalfEdges.Num() == 0, TEXT("Removing vertex #%d that still has %d edges!"), Vertex, OldVertex.OutgoingHalfEdges.Num());
+
+	OldVertex.Node = nullptr;
+	OldVertex.OutgoingHalfEdges.Reset();
+	OldVertex.bValid = false;
+	FreeVertices.Add(Vertex);
+}
+
+int32 FWallGraph::AddEdge(AWall* Wall, int32 StartVertex, int32 EndVertex)
+{
+	int32 Edge;
+	if (FreeEdges.Num() > 0)
+	{
+		Edge = FreeEdges.Pop(false);
+	}
+	else
+	{
+		Edge = EdgeWalls.AddDefaulted();
+		HalfEdges.AddDefaulted(2);
+	}
+
+	EdgeWalls[Edge] = Wall;
+
+	// Until the vertices are sorted, each half-edge just turns around onto its twin, like a dead end
+	int32 Forward = GetHalfEdge(Edge, true);
+	int32 Backward = GetHalfEdge(Edge, false);
+	HalfEdges[Forward] = { StartVertex, Backward, Backward, INDEX_NONE };
+	HalfEdges[Backward] = { EndVertex, Forward, Forward, INDEX_NONE };
+
+	Vertices[StartVertex].OutgoingHalfEdges.Add(Forward);
+	Vertices[EndVertex].OutgoingHalfEdges.Add(Backward);
+
+	return Edge;
+}
+
+void FWallGraph::RemoveEdge(int32 Edge)
+{
+	if (!EdgeWalls.IsValidIndex(Edge) || (EdgeWalls[Edge] == nullptr))
+	{
+		return;
+	}
+
+	int32 RemovedHalfEdges[] = { GetHalfEdge(Edge, true), GetHalfEdge(Edge, false) };
+	int32 OldOrigins[] = { HalfEdges[RemovedHalfEdges[0]].Origin, HalfEdges[RemovedHalfEdges[1]].Origin };
+
+	for (int32 HalfEdge : RemovedHalfEdges)
+	{
+		FWallGraphHalfEdge& OldHalfEdge = HalfEdges[HalfEdge];
+		Vertices[OldHalfEdge.Origin].OutgoingHalfEdges.Remove(HalfEdge);
+
+		if (Faces.IsValidIndex(OldHalfEdge.Face) && (Faces[OldHalfEdge.Face].HalfEdge == HalfEdge))
+		{
+			Faces[OldHalfEdge.Face].HalfEdge = INDEX_NONE;
+		}
+
+		OldHalfEdge = { INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE };
+	}
+
+	EdgeWalls[Edge] = nullptr;
+	FreeEdges.Add(Edge);
+
+	// Relink the remaining half-edges around the vertices that the edge left
+	for (int32 OldOrigin : OldOrigins)
+	{
+		SortVertex(OldOrigin);
+	}
+}
+
+void FWallGraph::MergeVertices(int32 IntoVertex, int32 FromVertex)
+{
+	if (IntoVertex == FromVertex)
+	{
+		return;
+	}
+
+	for (int32 HalfEdge : Vertices[FromVertex].OutgoingHalfEdges)
+	{
+		HalfEdges[HalfEdge].Origin = IntoVertex;
+		Vertices[IntoVertex].OutgoingHalfEdges.Add(HalfEdge);
+	}
+
+	Vertices[FromVertex].OutgoingHalfEdges.Reset();
+	RemoveVertex(FromVertex);
+	SortVertex(IntoVertex);
+}
+
+void FWallGraph::SortVertex(int32 Vertex)
+{
+	if (!Vertices.IsValidIndex(Vertex) || !Vertices[Vertex].bValid)
+	{
+		return;
+	}
+
+	FWallGraphVertex& SortedVertex = Vertices[Vertex];
+	auto& Outgoing = SortedVertex.OutgoingHalfEdges;
+	int32 NumOutgoing = Outgoing.Num();
+
+	// Sort by the angle of each half-edge leaving the vertex, which is also the order of the node's SortedWalls
+	TArray<TPair<float, int32>, TInlineAllocator<8>> OutgoingAngles;
+	for (int32 HalfEdge : Outgoing)
+	{
+		FVector2D Dir = Vertices[GetDestination(HalfEdge)].Position - SortedVertex.Position;
+		OutgoingAngles.Emplace(FMath::Atan2(Dir.Y, Dir.X), HalfEdge);
+	}
+
+	OutgoingAngles.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) {
+		return (A.Key < B.Key) || ((A.Key == B.Key) && (A.Value < B.Value));
+	});
+
+	for (int32 OutgoingIndex = 0; OutgoingIndex < NumOutgoing; ++OutgoingIndex)
+	{
+		Outgoing[OutgoingIndex] = OutgoingAngles[OutgoingIndex].Value;
+	}
+
+	// A half-edge arriving at the vertex continues along the next outgoing half-edge counter-clockwise from its twin,
+	// which traces each face counter-clockwise; a dead end turns back around onto its own twin.
+	for (int32 OutgoingIndex = 0; OutgoingIndex < NumOutgoing; ++OutgoingIndex)
+	{
+		int32 Incoming = GetTwin(Outgoing[OutgoingIndex]);
+		int32 NextOutgoing = Outgoing[(OutgoingIndex + 1) % NumOutgoing];
+
+		HalfEdges[Incoming].Next = NextOutgoing;
+		HalfEdges[NextOutgoing].Prev = Incoming;
+	}
+}
+
+int32 FWallGraph::AddFace(ARoom* Room)
+{
+	int32 Face = (FreeFaces.Num() > 0) ? FreeFaces.Pop(false) : Faces.AddDefaulted();
+	Faces[Face] = { Room, INDEX_NONE, true };
+	return Face;
+}
+
+void FWallGraph::RemoveFace(int32 Face)
+{
+	if (Faces.IsValidIndex(Face) && Faces[Face].bValid)
+	{
+		// Half-edges are expected to have been cleared from the face already, when its room was invalidated
+		Faces[Face] = { nullptr, INDEX_NONE, false };
+		FreeFaces.Add(Face);
+	}
+}
+
+void FWallGraph::SetFace(int32 HalfEdge, int32 Face)
+{
+	HalfEdges[HalfEdge].Face = Face;
+	if (Faces.IsValidIndex(Face) && (Faces[Face].HalfEdge == INDEX_NONE))
+	{
+		Faces[Face].HalfEdge = HalfEdge;
+	}
+}
+
+ARoom* FWallGraph::GetRoom(int32 HalfEdge) const
+{
+	int32 Face = HalfEdges[HalfEdge].Face;
+	return Faces.IsValidIndex(Face) ? Faces[Face].Room : nullptr;
+}
+
+int32 FWallGraph::FindOutgoingIndex(int32 HalfEdge) const
+{
+	int32 Origin = HalfEdges[HalfEdge].Origin;
+	return Vertices.IsValidIndex(Origin) ? Vertices[Origin].OutgoingHalfEdges.Find(HalfEdge) : INDEX_NONE;
+}
+
+bool FWallGraph::GetCycle(int32 HalfEdge, TArray<int32>& OutHalfEdges) const
+{
+	int32 CurHalfEdge = HalfEdge;
+	for (int32 NumVisited = 0; NumVisited < HalfEdges.Num(); ++NumVisited)
+	{
+		OutHalfEdges.Add(CurHalfEdge);
+		CurHalfEdge = HalfEdges[CurHalfEdge].Next;
+
+		if (CurHalfEdge == HalfEdge)
+		{
+			return true;
+		}
+		if (CurHalfEdge == INDEX_NONE)
+		{
+			break;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WallIntersectionKernel.h"
+
+#include "Math/TransformCalculus2D.h"
+#include "Wall.h"
+
+namespace
+{
+	// Query terms that are shared by every wall, splatted across all lanes.
+	// These mirror the values that AWall::GetWallIntersection2D computes for the query wall.
+	struct FQueryTerms
+	{
+		VectorRegister StartX;
+		VectorRegister StartY;
+		VectorRegister NegDeltaX;
+		VectorRegister NegDeltaY;
+		VectorRegister DirX;
+		VectorRegister DirY;
+		VectorRegister Length;
+		VectorRegister Cross;
+		VectorRegister Epsilon;
+		VectorRegister OneMinusEpsilon;
+		float StartZ;
+
+		bool Init(const FVector& QueryStart, const FVector& QueryEnd, float InEpsilon)
+		{
+			FVector QueryDelta = QueryEnd - QueryStart;
+			QueryDelta.Z = 0.0f;
+
+			float QueryLength = QueryDelta.Size();
+			if (FMath::IsNearlyZero(QueryLength, InEpsilon))
+			{
+				return false;
+			}
+
+			FVector QueryDir = QueryDelta / QueryLength;
+			FMatrix2x2 CrossMatrix(QueryStart.X, QueryStart.Y, QueryEnd.X, QueryEnd.Y);
+
+			StartX = VectorSetFloat1(QueryStart.X);
+			StartY = VectorSetFloat1(QueryStart.Y);
+			NegDeltaX = VectorSetFloat1(-QueryDelta.X);
+			NegDeltaY = VectorSetFloat1(-QueryDelta.Y);
+			DirX = VectorSetFloat1(QueryDir.X);
+			DirY = VectorSetFloat1(QueryDir.Y);
+			Length = VectorSetFloat1(QueryLength);
+			Cross = VectorSetFloat1(CrossMatrix.Determinant());
+			Epsilon = VectorSetFloat1(InEpsilon);
+			OneMinusEpsilon = VectorSetFloat1(1.0f - InEpsilon);
+			StartZ = QueryStart.Z;
+			return true;
+		}
+	};
+
+	// One group of wall lanes, loaded from the table's SoA arrays.
+	struct FWallLanes
+	{
+		VectorRegister StartX;
+		VectorRegister StartY;
+		VectorRegister DeltaX;
+		VectorRegister DeltaY;
+		VectorRegister DirX;
+		VectorRegister DirY;
+		VectorRegister Length;
+		VectorRegister Cross;
+	};
+
+	int32 IntersectLanes(const FQueryTerms& Query, const FWallLanes& Lanes, const int32* LaneSlots, const FWallSegmentTable& Table,
+		TArray<FWallIntersection>& OutIntersections, const AWall* IgnoreWall)
+	{
+		// Degenerate walls, including the table padding, never intersect
+		VectorRegister Valid = VectorCompareGT(Lanes.Length, Query.Epsilon);
+
+		// Reject (nearly) parallel walls, like FVector::Parallel does in the scalar path
+		VectorRegister DirDot = VectorMultiplyAdd(Query.DirY, Lanes.DirY, VectorMultiply(Query.DirX, Lanes.DirX));
+		Valid = VectorBitwiseAnd(Valid, VectorCompareLT(VectorAbs(DirDot), Query.OneMinusEpsilon));
+
+		// Same 2x2 determinants as the scalar path, in the same order, so that the rounding matches
+		VectorRegister NegDeltaX = VectorNegate(Lanes.DeltaX);
+		VectorRegister NegDeltaY = VectorNegate(Lanes.DeltaY);
+		VectorRegister Denominator = VectorSubtract(VectorMultiply(Query.NegDeltaX, NegDeltaY), VectorMultiply(Query.NegDeltaY, NegDeltaX));
+		Valid = VectorBitwiseAnd(Valid, VectorCompareGT(VectorAbs(Denominator), Query.Epsilon));
+
+		VectorRegister XNumerator = VectorSubtract(VectorMultiply(Query.Cross, NegDeltaX), VectorMultiply(Query.NegDeltaX, Lanes.Cross));
+		VectorRegister YNumerator = VectorSubtract(VectorMultiply(Query.Cross, NegDeltaY), VectorMultiply(Query.NegDeltaY, Lanes.Cross));
+		VectorRegister LocationX = VectorDivide(XNumerator, Denominator);
+		VectorRegister LocationY = VectorDivide(YNumerator, Denominator);
+
+		VectorRegister DistAlongQuery = VectorMultiplyAdd(VectorSubtract(LocationY, Query.StartY), Query.DirY,
+			VectorMultiply(VectorSubtract(LocationX, Query.StartX), Query.DirX));
+		VectorRegister DistAlongHit = VectorMultiplyAdd(VectorSubtract(LocationY, Lanes.StartY), Lanes.DirY,
+			VectorMultiply(VectorSubtract(LocationX, Lanes.StartX), Lanes.DirX));
+
+		VectorRegister PctAlongQuery = VectorDivide(DistAlongQuery, Query.Length);
+		VectorRegister PctAlongHit = VectorDivide(DistAlongHit, Lanes.Length);
+		VectorRegister Hit = VectorBitwiseAnd(
+			VectorBitwiseAnd(VectorCompareGE(PctAlongQuery, Query.Epsilon), VectorCompareLE(PctAlongQuery, Query.OneMinusEpsilon)),
+			VectorBitwiseAnd(VectorCompareGE(PctAlongHit, Query.Epsilon), VectorCompareLE(PctAlongHit, Query.OneMinusEpsilon)));
+		Hit = VectorBitwiseAnd(Hit, Valid);
+
+		uint32 HitMask = VectorMaskBits(Hit);
+		if (HitMask == 0)
+		{
+			return 0;
+		}
+
+		MS_ALIGN(16) float LocationXs[FWallSegmentTable::LaneCount] GCC_ALIGN(16);
+		MS_ALIGN(16) float LocationYs[FWallSegmentTable::LaneCount] GCC_ALIGN(16);
+		MS_ALIGN(16) float DistsAlongQuery[FWallSegmentTable::LaneCount] GCC_ALIGN(16);
+		MS_ALIGN(16) float DistsAlongHit[FWallSegmentTable::LaneCount] GCC_ALIGN(16);
+		VectorStoreAligned(LocationX, LocationXs);
+		VectorStoreAligned(LocationY, LocationYs);
+		VectorStoreAligned(DistAlongQuery, DistsAlongQuery);
+		VectorStoreAligned(DistAlongHit, DistsAlongHit);
+
+		int32 NumAdded = 0;
+		for (int32 Lane = 0; Lane < FWallSegmentTable::LaneCount; ++Lane)
+		{
+			int32 Slot = LaneSlots[Lane];
+			if ((HitMask & (1 << Lane)) == 0 || Slot >= Table.Num())
+			{
+				continue;
+			}
+
+			AWall* HitWall = Table.GetWall(Slot);
+			if (HitWall == IgnoreWall)
+			{
+				continue;
+			}
+
+			FWallIntersection& Intersection = OutIntersections.AddDefaulted_GetRef();
+			Intersection.Init();
+			Intersection.HitWall = HitWall;
+			Intersection.DistAlongQueryWall = DistsAlongQuery[Lane];
+			Intersection.DistAlongHitWall = DistsAlongHit[Lane];
+			Intersection.Location.Set(LocationXs[Lane], LocationYs[Lane], 0.5f * (Query.StartZ + Table.GetStartZ(Slot)));
+			++NumAdded;
+		}
+
+		return NumAdded;
+	}
+}
+
+void FWallSegmentTable::AddOrUpdateWall(AWall* Wall)
+{
+	if (!ensureAlways(Wall))
+	{
+		return;
+	}
+
+	int32 Slot;
+	if (int32* ExistingSlot = WallSlots.Find(Wall))
+	{
+		Slot = *ExistingSlot;
+	}
+	else
+	{
+		Slot = Walls.Add(Wall);
+		WallSlots.Add(Wall, Slot);
+
+		// Grow the lanes by a whole group at a time; the new padding slots stay degenerate until they are written.
+		if (Slot >= NumPadded())
+		{
+			for (auto* Lanes : { &StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross })
+			{
+				Lanes->AddZeroed(LaneCount);
+			}
+		}
+
+		StartZ.Add(0.0f);
+	}
+
+	WriteSlot(Slot, Wall->StartPoint, Wall->EndPoint);
+}
+
+void FWallSegmentTable::RemoveWall(AWall* Wall)
+{
+	int32 Slot;
+	if (!WallSlots.RemoveAndCopyValue(Wall, Slot))
+	{
+		return;
+	}
+
+	// Keep the slots dense by moving the last wall into the removed one's slot
+	int32 LastSlot = Walls.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		AWall* MovedWall = Walls[LastSlot];
+		Walls[Slot] = MovedWall;
+		WallSlots[MovedWall] = Slot;
+
+		for (auto* Lanes : { &StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross })
+		{
+			(*Lanes)[Slot] = (*Lanes)[LastSlot];
+		}
+		StartZ[Slot] = StartZ[LastSlot];
+	}
+
+	ClearSlot(LastSlot);
+	Walls.RemoveAt(LastSlot, 1, false);
+	StartZ.RemoveAt(LastSlot, 1, false);
+
+	// Drop the last group once it only holds padding
+	int32 OldNumPadded = NumPadded();
+	if (OldNumPadded - Walls.Num() >= LaneCount)
+	{
+		for (auto* Lanes : { &StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross })
+		{
+			Lanes->RemoveAt(OldNumPadded - LaneCount, LaneCount, false);
+		}
+	}
+}
+
+void FWallSegmentTable::Empty()
+{
+	for (auto* Lanes : { &StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross })
+	{
+		Lanes->Empty();
+	}
+
+	StartZ.Empty();
+	Walls.Empty();
+	WallSlots.Empty();
+}
+
+int32 FWallSegmentTable::FindSlot(const AWall* Wall) const
+{
+	const int32* Slot = WallSlots.Find(Wall);
+	return Slot ? *Slot : INDEX_NONE;
+}
+
+void FWallSegmentTable::WriteSlot(int32 Slot, const FVector& Start, const FVector& End)
+{
+	// Same terms as AWall::GetWallIntersection2D computes for the other wall
+	FVector Delta = End - Start;
+	Delta.Z = 0.0f;
+
+	float WallLength = Delta.Size();
+	FVector Dir = (WallLength > 0.0f) ? (Delta / WallLength) : FVector::ZeroVector;
+	FMatrix2x2 CrossMatrix(Start.X, Start.Y, End.X, End.Y);
+
+	StartX[Slot] = Start.X;
+	StartY[Slot] = Start.Y;
+	DeltaX[Slot] = Delta.X;
+	DeltaY[Slot] = Delta.Y;
+	DirX[Slot] = Dir.X;
+	DirY[Slot] = Dir.Y;
+	Length[Slot] = WallLength;
+	StartCross[Slot] = CrossMatrix.Determinant();
+	StartZ[Slot] = Start.Z;
+}
+
+void FWallSegmentTable::ClearSlot(int32 Slot)
+{
+	for (auto* Lanes : { &StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross })
+	{
+		(*Lanes)[Slot] = 0.0f;
+	}
+}
+
+void FWallSlotGather::Gather(const FWallSegmentTable& Table, const TArray<int32>& InSlots)
+{
+	int32 NumSlots = InSlots.Num();
+	int32 NumPadded = Align(NumSlots, FWallSegmentTable::LaneCount);
+
+	Slots.Reset(NumPadded);
+	Slots.Append(InSlots);
+	Slots.SetNumUninitialized(NumPadded, false);
+	for (int32 Index = NumSlots; Index < NumPadded; ++Index)
+	{
+		Slots[Index] = MAX_int32;
+	}
+
+	// One field at a time, so that each pass reads from one source array and writes one contiguous destination
+	const TArray<float, TAlignedHeapAllocator<16>>* Sources[] = {
+		&Table.StartX, &Table.StartY, &Table.DeltaX, &Table.DeltaY, &Table.DirX, &Table.DirY, &Table.Length, &Table.StartCross };
+	TArray<float, TAlignedHeapAllocator<16>>* Destinations[] = {
+		&StartX, &StartY, &DeltaX, &DeltaY, &DirX, &DirY, &Length, &StartCross };
+
+	for (int32 Field = 0; Field < ARRAY_COUNT(Sources); ++Field)
+	{
+		const float* SourceData = Sources[Field]->GetData();
+		Destinations[Field]->SetNumUninitialized(NumPadded, false);
+		float* DestinationData = Destinations[Field]->GetData();
+
+		for (int32 Index = 0; Index < NumSlots; ++Index)
+		{
+			DestinationData[Index] = SourceData[InSlots[Index]];
+		}
+		for (int32 Index = NumSlots; Index < NumPadded; ++Index)
+		{
+			DestinationData[Index] = 0.0f;
+		}
+	}
+}
+
+int32 FWallIntersectionKernel::IntersectAll(const FWallSegmentTable& Table, const FVector& QueryStart, const FVector& QueryEnd,
+	TArray<FWallIntersection>& OutIntersections, const AWall* IgnoreWall, float Epsilon)
+{
+	FQueryTerms Query;
+	if (!Query.Init(QueryStart, QueryEnd, Epsilon))
+	{
+		return 0;
+	}
+
+	// The table is padded to whole groups, so the lanes can be loaded straight from the aligned arrays
+	int32 NumAdded = 0;
+	int32 LaneSlots[FWallSegmentTable::LaneCount];
+	for (int32 FirstSlot = 0; FirstSlot < Table.Num(); FirstSlot += FWallSegmentTable::LaneCount)
+	{
+		FWallLanes Lanes;
+		Lanes.StartX = VectorLoadAligned(&Table.StartX[FirstSlot]);
+		Lanes.StartY = VectorLoadAligned(&Table.StartY[FirstSlot]);
+		Lanes.DeltaX = VectorLoadAligned(&Table.DeltaX[FirstSlot]);
+		Lanes.DeltaY = VectorLoadAligned(&Table.DeltaY[FirstSlot]);
+		Lanes.DirX = VectorLoadAligned(&Table.DirX[FirstSlot]);
+		Lanes.DirY = VectorLoadAligned(&Table.DirY[FirstSlot]);
+		Lanes.Length = VectorLoadAligned(&Table.Length[FirstSlot]);
+		Lanes.Cross = VectorLoadAligned(&Table.StartCross[FirstSlot]);
+
+		for (int32 Lane = 0; Lane < FWallSegmentTable::LaneCount; ++Lane)
+		{
+			LaneSlots[Lane] = FirstSlot + Lane;
+		}
+
+		NumAdded += IntersectLanes(Query, Lanes, LaneSlots, Table, OutIntersections, IgnoreWall);
+	}
+
+	return NumAdded;
+}
+
+int32 FWallIntersectionKernel::IntersectSlots(const FWallSegmentTable& Table, const TArray<int32>& Slots, FWallSlotGather& Scratch,
+	const FVector& QueryStart, const FVector& QueryEnd, TArray<FWallIntersection>& OutIntersections, const AWall* IgnoreWall, float Epsilon)
+{
+	FQueryTerms Query;
+	if (!Query.Init(QueryStart, QueryEnd, Epsilon))
+	{
+		return 0;
+	}
+
+	Scratch.Gather(Table, Slots);
+
+	int32 NumAdded = 0;
+	for (int32 FirstIndex = 0; FirstIndex < Scratch.Slots.Num(); FirstIndex += FWallSegmentTable::LaneCount)
+	{
+		FWallLanes Lanes;
+		Lanes.StartX = VectorLoadAligned(&Scratch.StartX[FirstIndex]);
+		Lanes.StartY = VectorLoadAligned(&Scratch.StartY[FirstIndex]);
+		Lanes.DeltaX = VectorLoadAligned(&Scratch.DeltaX[FirstIndex]);
+		Lanes.DeltaY = VectorLoadAligned(&Scratch.DeltaY[FirstIndex]);
+		Lanes.DirX = VectorLoadAligned(&Scratch.DirX[FirstIndex]);
+		Lanes.DirY = VectorLoadAligned(&Scratch.DirY[FirstIndex]);
+		Lanes.Length = VectorLoadAligned(&Scratch.Length[FirstIndex]);
+		Lanes.Cross = VectorLoadAligned(&Scratch.StartCross[FirstIndex]);
+
+		NumAdded += IntersectLanes(Query, Lanes, &Scratch.Slots[FirstIndex], Table, OutIntersections, IgnoreWall);
+	}
+
+	return NumAdded;
+}
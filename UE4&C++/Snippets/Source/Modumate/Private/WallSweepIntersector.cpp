@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WallSweepIntersector.h"
+
+#include "ModumateCoreConversions.h"
+#include "ModumateSweepIntersection.h"
+
+void FWallSweepIntersector::FindAllCrossings(const TArray<AWall*>& InWalls, TArray<FWallCrossing>& OutCrossings, float Epsilon)
+{
+	OutCrossings.Reset();
+
+	std::vector<ModumateCore::FWallSegment> Segments;
+	Segments.reserve(InWalls.Num());
+	for (const AWall* Wall : InWalls)
+	{
+		Segments.push_back({ ToCore(Wall->StartPoint), ToCore(Wall->EndPoint) });
+	}
+
+	std::vector<ModumateCore::FSegmentCrossing> SegmentCrossings;
+	ModumateCore::FindSegmentCrossings(Segments.data(), static_cast<int32>(Segments.size()), SegmentCrossings, Epsilon);
+
+	// Same values that WallA->GetWallIntersection2D(WallB) would have filled in, since it wraps the same test
+	OutCrossings.Reserve(static_cast<int32>(SegmentCrossings.size()));
+	for (const ModumateCore::FSegmentCrossing& SegmentCrossing : SegmentCrossings)
+	{
+		FWallCrossing& Crossing = OutCrossings.AddDefaulted_GetRef();
+		Crossing.WallIndexA = SegmentCrossing.SegmentIndexA;
+		Crossing.WallIndexB = SegmentCrossing.SegmentIndexB;
+		Crossing.Intersection.HitWall = InWalls[SegmentCrossing.SegmentIndexB];
+		Crossing.Intersection.Location = FromCore(SegmentCrossing.Intersection.Location);
+		Crossing.Intersection.DistAlongQueryWall = SegmentCrossing.Intersection.DistAlongA;
+		Crossing.Intersection.DistAlongHitWall = SegmentCrossing.Intersection.DistAlongB;
+	}
+}
@@ -4,18 +4,44 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Tickable.h"
+#include "ModumateSpatialIndex.h"
+#include "WallIntersectionKernel.h"
+#include "Wall.h"
+#include "WallGraph.h"
+#include "ModumateWallOpenings.h"
+#include "ModumateMeshJobs.h"
+#include "WallCluster.h"
+#include "ModumateCollisionQueue.h"
+#include "ModumateMeshLODs.h"
+#include "Room.h"
 #include "EditManager.generated.h"
 
 /**
  * 
  */
 UCLASS(Blueprintable)
-class MODUMATE_API UEditManager : public UObject
+class MODUMATE_API UEditManager : public UObject, public FTickableGameObject
 {
 	GENERATED_UCLASS_BODY()
 
 public:
 	virtual class UWorld* GetWorld() const override;
+	virtual void PostInitProperties() override;
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	// Wall, floor and casework meshes are built on worker threads and uploaded in a later frame, and their collision is cooked
+	// once editing is idle; this waits for all of them
+	UFUNCTION(BlueprintCallable)
+	void FlushMeshBuilds();
+
+	// Destroys the actors that placed walls are merged into, along with their pending builds, and shows each wall's own mesh again
+	void DestroyWallClusters();
 	//walls
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TSubclassOf<class AWall> WallClass;
@@ -28,6 +54,11 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	void RemoveWall(class AWall* Wall);
+
+	/** Places many walls at once (e.g. when pasting), finding all crossings in a single sweep and updating rooms once.
+	    Like FinishWall, walls that would cross an existing wall or an earlier wall in the batch are not placed. */
+	UFUNCTION(BlueprintCallable)
+	TArray<class AWall*> PlaceWalls(const TArray<FVector>& WallStarts, const TArray<FVector>& WallEnds);
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	TArray<class AWall*> Walls;
@@ -35,6 +66,33 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	class AWall* PendingWall;
 
+	// The pending wall's mesh, while it's being dragged
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UProceduralMeshComponent* PendingWallMesh;
+
+	// The pending wall's direction when its mesh's normals, UVs and tangents were last sent while dragging it
+	FVector PendingWallSurfaceDir;
+
+	// Size (in cm) of the grid cells used to look up walls for intersection tests
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float WallGridCellSize;
+
+	// Size (in cm) of the grid cells that placed walls are merged into one mesh for
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float WallClusterCellSize;
+
+	// Screen size (as a fraction of the view's width) below which wall clusters, floors and casework are drawn simplified
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SimplifiedMeshScreenSize;
+
+	// Material of the quads that stand in for openings in simplified walls, which are solid without it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	class UMaterialInterface* WallOpeningLODMaterial;
+
+	/** Selected walls are drawn with their own meshes, rather than as part of their wall cluster. */
+	UFUNCTION(BlueprintCallable)
+	void SetWallSelected(class AWall* Wall, bool bSelected);
+
 	//Floors
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TSubclassOf<class AFloor> FloorClass;
@@ -119,16 +177,32 @@ public:
 	
 	//other
 	UFUNCTION(BlueprintCallable)
-	TArray<int32> Triangulate(TArray<FVector> vertices);
+	TArray<int32> Triangulate(const TArray<FVector>& vertices);
 
 	UFUNCTION(BlueprintCallable)
 	void GenterateWall(UProceduralMeshComponent* WallMesh, float height, float thickness, AWall* PendingWallActor);
 
+	/** Starts dragging the pending wall's end, which streams its mesh into WallMesh without collision until FinishWall. */
 	UFUNCTION(BlueprintCallable)
-	void CutWindowIntoWall(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, FVector Origin, FVector BoxExtend, bool bIsDoor, bool isPreview);
-	
+	void BeginWallDrag(UProceduralMeshComponent* WallMesh, float height, float thickness);
+
+	/** Moves the pending wall's end while it's dragged, without moving the actor, only updating its mesh's vertex positions when its triangles are unchanged. */
 	UFUNCTION(BlueprintCallable)
-	void TriangulateWallBoxes(int i_currentWallVertSize, int i_currentLocalVertSize, TArray<int> &Triangle);
+	void DragWall(const FVector& WallEnd);
+
+	// Adds an opening to the wall and remeshes it, returning the opening's ID, or INDEX_NONE if it doesn't fit or is a preview
+	UFUNCTION(BlueprintCallable)
+	int32 CutWindowIntoWall(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, FVector Origin, FVector BoxExtend, bool bIsDoor, bool isPreview);
+
+	UFUNCTION(BlueprintCallable)
+	bool MoveWallOpening(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, int32 OpeningID, FVector Origin, FVector BoxExtend, bool bIsDoor);
+
+	UFUNCTION(BlueprintCallable)
+	bool RemoveWallOpening(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor, int32 OpeningID);
+
+	// Puts back the wall's committed mesh, if CutWindowIntoWall is previewing an opening in it
+	UFUNCTION(BlueprintCallable)
+	void ClearWallOpeningPreview(UProceduralMeshComponent* WallMesh, AWall* CurrentWallActor);
 
 	UFUNCTION(BlueprintCallable)
 		bool IsWithinBoxBounds(FVector origin, FVector bounds, AWall *CurrentWall);
@@ -149,17 +223,83 @@ protected:
 	class ACaseWorkLine* SpawnCaseWorkLine(const FVector& Origin = FVector::ZeroVector);
 
 	bool GetIntersectingWalls(class AWall* QueryWall, TArray<struct FWallIntersection>& OutIntersections);
+	void CommitWallBatch(const TArray<class AWall*>& NewWalls, bool bRejectCrossingWalls, TArray<class AWall*>& OutPlacedWalls);
+	void DestroyUnplacedWall(class AWall* Wall);
 	void OnWallMoved(class AWall* ChangedWall);
 	bool ResetWallConnectivity(class AWall* ChangedWall);
+	bool SyncWallFromGraph(class AWall* Wall);
+	void SyncNodeFromGraph(class ARoomNode* Node);
+	void SetWallSideRoom(int32 HalfEdge, class ARoom* Room);
+	ModumateCore::FWallOpening MakeWallOpening(const class AWall* Wall, const FVector& Origin, const FVector& BoxExtend, bool bIsDoor) const;
+	void UpdateWallMesh(UProceduralMeshComponent* WallMesh, class AWall* Wall);
+	void UpdateWallPreview(UProceduralMeshComponent* WallMesh, class AWall* Wall, const ModumateCore::FWallOpening& Opening);
+	void EndWallDrag(class AWall* Wall);
 	void UpdateRoomsFromWalls();
+	void UpdateRoomsFromWalls(const TArray<class AWall*>& ChangedWalls);
+	bool TraceRoomsFromWalls(const TArray<class AWall*>& SeedWalls, TSet<class ARoom*>& DirtyRooms, TArray<class ARoom*>& OutTracedRooms);
+	void UpdateRoomHoles(const TArray<class ARoom*>& TracedRooms, TArray<class ARoom*>& OutDirtyFloorRooms);
+	class ARoom* FindIslandHost(const class ARoom* IslandRoom) const;
+	void DetachRoomHoles(class ARoom* Room);
+	void TriangulateDirtyRooms(const TArray<class ARoom*>& DirtyFloorRooms);
 	void UpdateDimensionStringsForInteriorWalls();
 	void UpdateGrounded(AWall * Wall);
 	void UpdateGrounded(ARoomNode * Node);
 	
 	class ARoom* CreateRoomFromData(const struct FRoomData& RoomData);
+	void UpdateRoomFromData(class ARoom* Room, const struct FRoomData& RoomData);
+	void DestroyRoom(class ARoom* Room);
+	void RegisterRoom(class ARoom* Room);
+	void UnregisterRoom(class ARoom* Room);
 	class ARoom* FindRoomFromData(const struct FRoomData& RoomData, bool bCreateIfNotFound = false);
 	class ARoom* FindMostSimilarRoom(const struct FRoomData& RoomData, int32& NumSharedWalls);
 	class ARoomNode* CreateNodeAtPoint(const FVector& Position);
 	class ARoomNode* FindNodeAtPoint(const FVector& Position, class ARoomNode* IgnoreNode = nullptr);
 	class ARoomNode* FindOrCreateNodeAtPoint(const FVector& Position);
+
+	// Spatial index of all placed walls, kept in sync by OnWallMoved and RemoveWall
+	FWallSpatialGrid WallGrid;
+
+	// Half-edge topology of the walls, nodes and rooms; the actors' connectivity properties are views of it
+	FWallGraph WallGraph;
+
+	// Never reused, unlike Rooms.Num(), so that room IDs stay unique after rooms are destroyed and order rooms by age
+	int32 NextRoomID;
+
+	// All rooms, keyed by FRoomData::WallLoopHash, kept in sync whenever rooms are created, updated or destroyed
+	TMultiMap<uint32, class ARoom*> RoomsByWallLoop;
+
+	// The rooms that use each wall in each direction (true for forwards), kept in sync along with RoomsByWallLoop
+	TMap<TPair<class AWall*, bool>, TArray<class ARoom*, TInlineAllocator<2>>> RoomsByWallSide;
+
+	// Packed copy of the placed wall segments for the vectorized intersection kernel, kept in sync along with WallGrid
+	FWallSegmentTable WallTable;
+
+	// GetIntersectingWalls' scratch, and FinishWall's results from it, reused so that placing a wall doesn't allocate
+	TArray<class AWall*> CandidateWalls;
+	TArray<int32> CandidateSlots;
+	FWallSlotGather CandidateLanes;
+	TArray<FWallIntersection> PendingWallIntersections;
+
+	// Exterior rooms with a loop of their own, and the ones that UpdateRoomHoles still has to find a room for or cut holes into
+	TSet<class ARoom*> IslandRooms;
+	TSet<class ARoom*> IslandsToPlace;
+	TSet<class ARoom*> RoomsWithDirtyHoles;
+
+	// Spatial hash of all room nodes, kept in sync whenever nodes are created, moved, merged or destroyed
+	FRoomNodeSpatialHash RoomNodeHash;
+
+	// TriangulateDirtyRooms' results, which are only ever added to, so their index buffers keep their capacity between edits
+	TArray<FRoomFloorTriangulation> FloorTriangulations;
+
+	// Wall, floor and casework meshes that are being built on worker threads, uploaded as they finish on Tick
+	FModumateMeshJobQueue MeshJobs;
+
+	// Placed walls, merged into a mesh per grid cell, kept in sync as each wall's own mesh is uploaded
+	FWallClusters WallClusters;
+
+	// Collision for uploaded meshes, cooked in batches once nothing has been submitted for a moment
+	FModumateCollisionQueue CollisionQueue;
+
+	// Wall clusters, floors and casework, switched between their detailed and simplified sections by their screen size on Tick
+	FModumateMeshLODs MeshLODs;
 };
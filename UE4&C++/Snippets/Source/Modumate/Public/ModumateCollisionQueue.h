@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+
+/**
+ * Defers collision for generated meshes until editing has been idle for IdleDelay seconds, rather than cooking it on every rebuild,
+ * and then cooks the components that are waiting in batches of up to MaxCooksPerFrame.
+ * Components with a convex decomposition, like walls' boxes, only cook those; others cook their sections' triangles.
+ * Whichever of the two was submitted last for a component replaces the other.
+ * Convexes turn off bUseComplexAsSimpleCollision, and their sections' triangles are never cooked, so complex traces don't hit
+ * walls, or any other component with convexes, at all; pick them with simple traces, which hit the convexes, instead.
+ * Components are referenced weakly, and any that have been destroyed are dropped.
+ */
+class MODUMATE_API FModumateCollisionQueue
+{
+public:
+	FModumateCollisionQueue(float InIdleDelay = 0.5f, int32 InMaxCooksPerFrame = 16);
+
+	/** Replaces the component's simple collision with these convex hulls, in component space, dropping any collision waiting for it. */
+	void SubmitConvexes(UProceduralMeshComponent* Mesh, const TArray<TArray<FVector>>& Convexes);
+
+	/** Cooks collision from the section's triangles, along with any other sections waiting for the component, dropping any convexes waiting for it. */
+	void SubmitTrimesh(UProceduralMeshComponent* Mesh, int32 SectionIndex);
+
+	/** Cooks the next batch, if nothing has been submitted for IdleDelay seconds. Call once per frame on the game thread. */
+	void CookIdle();
+
+	/** Cooks everything that's waiting, right away. */
+	void Flush();
+
+	bool HasWork() const { return PendingCollision.Num() > 0; }
+
+	float IdleDelay;
+	int32 MaxCooksPerFrame;
+
+private:
+	struct FPendingCollision
+	{
+		bool bConvexes = false;
+		TArray<TArray<FVector>> Convexes;
+		TArray<int32> TrimeshSections;
+	};
+
+	static void Cook(UProceduralMeshComponent* Mesh, FPendingCollision& Collision);
+
+	TMap<TWeakObjectPtr<UProceduralMeshComponent>, FPendingCollision> PendingCollision;
+	double LastSubmitTime;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModumateCoreTypes.h"
+
+// Conversions between engine math types and the plain types used by the ModumateCore module
+
+inline ModumateCore::FVec2 ToCore(const FVector2D& Vector)
+{
+	return { Vector.X, Vector.Y };
+}
+
+inline ModumateCore::FVec3 ToCore(const FVector& Vector)
+{
+	return { Vector.X, Vector.Y, Vector.Z };
+}
+
+inline FVector2D FromCore(const ModumateCore::FVec2& Vector)
+{
+	return FVector2D(Vector.X, Vector.Y);
+}
+
+inline FVector FromCore(const ModumateCore::FVec3& Vector)
+{
+	return FVector(Vector.X, Vector.Y, Vector.Z);
+}
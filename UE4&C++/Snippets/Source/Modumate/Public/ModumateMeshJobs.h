@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "ProceduralMeshComponent.h"
+
+/** The buffers of one procedural mesh section, as they're passed to CreateMeshSection_LinearColor. */
+struct MODUMATE_API FModumateMeshBuffers
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UV0;
+	TArray<FLinearColor> VertexColors;
+	TArray<FProcMeshTangent> Tangents;
+
+	/** Empties every buffer, keeping its capacity. */
+	void Reset();
+
+	/**
+	 * Fills in Normals, Tangents and UV0 from Vertices and Triangles with ModumateCore::ComputeFlatSurface, as flat faces with
+	 * UVs aligned to the component's space, UVScale per centimeter. Faces that point different ways mustn't share vertices.
+	 * Safe to call from any thread.
+	 */
+	void ComputeFlatSurface(float UVScale = 0.01f);
+};
+
+/**
+ * Builds procedural mesh sections on worker threads, so that only uploading them happens on the game thread.
+ * Each section has two sets of buffers: a build fills the back one while the front one holds the last upload,
+ * and they're swapped once it's done, so that both keep their capacity from one build to the next.
+ * A section has at most one build in flight; a newer one waits for it, replacing any older one that was waiting,
+ * so that a burst of edits to the same mesh only builds the first and the last of them.
+ * Components are referenced weakly, and builds for any that have been destroyed are dropped.
+ */
+class MODUMATE_API FModumateMeshJobQueue
+{
+public:
+	/** Fills the buffers on a worker thread, so it must only use what it captured, and thread-safe shared state. */
+	typedef TFunction<void(FModumateMeshBuffers&)> FBuildFunction;
+
+	/** Runs on the game thread right after the buffers have been uploaded, and mustn't submit builds of its own. */
+	typedef TFunction<void(UProceduralMeshComponent*, const FModumateMeshBuffers&)> FUploadedFunction;
+
+	~FModumateMeshJobQueue();
+
+	/** Starts building the section, or queues it up behind the build that's in flight for it. */
+	void Submit(UProceduralMeshComponent* Mesh, int32 SectionIndex, bool bCreateCollision, FBuildFunction Build, FUploadedFunction OnUploaded = nullptr);
+
+	/**
+	 * Drops the builds of one of the component's sections, or all of them with INDEX_NONE, that haven't been uploaded yet,
+	 * for when they're about to be updated directly, returning whether there were any.
+	 */
+	bool Cancel(UProceduralMeshComponent* Mesh, int32 SectionIndex = INDEX_NONE);
+
+	/** Uploads every build that's done, and starts the ones that were waiting for them. Call once per frame on the game thread. */
+	void UploadFinished();
+
+	/** Waits for every build, including ones that were waiting, and uploads them. */
+	void Flush();
+
+	bool HasWork() const { return SectionJobs.Num() > 0; }
+
+private:
+	struct FJob
+	{
+		bool bCreateCollision;
+		FBuildFunction Build;
+		FUploadedFunction OnUploaded;
+	};
+
+	typedef TPair<TWeakObjectPtr<UProceduralMeshComponent>, int32> FSectionKey;
+
+	struct FSectionJobs
+	{
+		TWeakObjectPtr<UProceduralMeshComponent> Mesh;
+		int32 SectionIndex = 0;
+		FModumateMeshBuffers Buffers[2];
+		int32 FrontIndex = 0;
+
+		bool bBuilding = false;
+		bool bCancelled = false;
+		FJob Building;
+		TFuture<void> BuildTask;
+
+		bool bWaiting = false;
+		FJob Waiting;
+	};
+
+	void StartBuild(FSectionJobs& Jobs, FJob&& Job);
+
+	// Returns whether the section still has work to do afterwards
+	bool FinishBuild(FSectionJobs& Jobs);
+
+	// The jobs are boxed, so that their buffers stay put while worker threads fill them
+	TMap<FSectionKey, TUniquePtr<FSectionJobs>> SectionJobs;
+};
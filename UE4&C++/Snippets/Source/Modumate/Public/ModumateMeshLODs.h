@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+
+/**
+ * Switches generated meshes between their detailed sections and their simplified ones by how big they are on screen,
+ * since procedural meshes don't have LODs of their own. Screen size is the diameter of the mesh's bounds over the width
+ * of the view, as for static meshes' LODs, so the number of detailed meshes drawn scales with what's in view rather than
+ * with the size of the project. Components are referenced weakly, and any that have been destroyed are dropped.
+ */
+class MODUMATE_API FModumateMeshLODs
+{
+public:
+	FModumateMeshLODs(float InSimplifiedScreenSize = 0.25f);
+
+	/**
+	 * Has the mesh draw DetailSections while it's at least SimplifiedScreenSize, and SimplifiedSections otherwise,
+	 * switching them right away. Call it again whenever its sections are recreated, since that shows them.
+	 */
+	void SetLODSections(UProceduralMeshComponent* Mesh, const TArray<int32>& DetailSections, const TArray<int32>& SimplifiedSections);
+	void Remove(UProceduralMeshComponent* Mesh);
+
+	/** Switches the meshes whose screen size has crossed SimplifiedScreenSize since the last update. */
+	void Update(const FVector& ViewOrigin, float FOVAngle);
+
+	bool HasMeshes() const { return MeshLODs.Num() > 0; }
+
+	float SimplifiedScreenSize;
+
+private:
+	struct FMeshLODs
+	{
+		TArray<int32> DetailSections;
+		TArray<int32> SimplifiedSections;
+		bool bSimplified = false;
+	};
+
+	bool ShouldSimplify(const UProceduralMeshComponent* Mesh) const;
+	static void ShowLOD(UProceduralMeshComponent* Mesh, const FMeshLODs& LODs);
+
+	TMap<TWeakObjectPtr<UProceduralMeshComponent>, FMeshLODs> MeshLODs;
+
+	// Where the meshes were last seen from, where ScreenScale is the inverse of the tangent of half of the horizontal FOV
+	FVector ViewOrigin;
+	float ScreenScale;
+	bool bHasView;
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Unreal Insights CPU scopes only exist in newer engine versions, so they compile away without them
+#if defined(__has_include)
+#if __has_include("ProfilingDebugging/CpuProfilerTrace.h")
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+#endif
+
+#ifndef TRACE_CPUPROFILER_EVENT_SCOPE
+#define TRACE_CPUPROFILER_EVENT_SCOPE(Name)
+#endif
+
+DECLARE_STATS_GROUP(TEXT("Modumate"), STATGROUP_Modumate, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FinishWall"), STAT_Modumate_FinishWall, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CommitWallBatch"), STAT_Modumate_CommitWallBatch, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("OnWallMoved"), STAT_Modumate_OnWallMoved, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateRoomsFromWalls"), STAT_Modumate_UpdateRooms, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateDimensionStrings"), STAT_Modumate_UpdateDimensionStrings, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CutWindowIntoWall"), STAT_Modumate_CutWindowIntoWall, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateWall"), STAT_Modumate_GenerateWall, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateFloorBase"), STAT_Modumate_GenerateFloorBase, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangulate"), STAT_Modumate_Triangulate, STATGROUP_Modumate, MODUMATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UploadMeshSections"), STAT_Modumate_UploadMeshSections, STATGROUP_Modumate, MODUMATE_API);
+
+/** The stages of the edit pipeline that are timed. Stages can nest; for example, FinishWall includes UpdateRooms. */
+enum class EModumateStage : uint8
+{
+	FinishWall,
+	CommitWallBatch,
+	OnWallMoved,
+	UpdateRooms,
+	UpdateDimensionStrings,
+	CutWindowIntoWall,
+	GenerateWall,
+	GenerateFloorBase,
+	Triangulate,
+	UploadMeshSections,
+	Num
+};
+
+/** Times a stage with its STATGROUP_Modumate cycle counter, an Unreal Insights CPU scope, and an FModumateStageScope. */
+#define MODUMATE_STAGE_SCOPE(StageName) \
+	SCOPE_CYCLE_COUNTER(STAT_Modumate_##StageName); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Modumate_##StageName); \
+	FModumateStageScope ModumateStageScope(EModumateStage::StageName)
+
+MODUMATE_API const TCHAR* GetModumateStageName(EModumateStage Stage);
+
+struct MODUMATE_API FModumateStageStats
+{
+	int32 NumSamples = 0;
+	double TotalSeconds = 0.0;
+	double MeanSeconds = 0.0;
+	double P50Seconds = 0.0;
+	double P90Seconds = 0.0;
+	double P99Seconds = 0.0;
+	double MaxSeconds = 0.0;
+	int64 NumAllocations = 0;
+};
+
+/**
+ * Collects the latency and game thread allocation count of every stage sample between BeginRecording and EndRecording.
+ * Allocations are counted by wrapping GMalloc while recording, so this is meant for benchmarks rather than normal play.
+ */
+class MODUMATE_API FModumateStageRecorder
+{
+public:
+	static void BeginRecording();
+	static void EndRecording();
+	static bool IsRecording() { return bRecording; }
+
+	static void AddSample(EModumateStage Stage, double Seconds, int64 NumAllocations);
+	static FModumateStageStats GetStats(EModumateStage Stage);
+
+	/** Number of allocations made on the game thread since recording began. */
+	static int64 GetNumAllocations();
+
+private:
+	static bool bRecording;
+	static TArray<double> StageSamples[(int32)EModumateStage::Num];
+	static int64 StageAllocations[(int32)EModumateStage::Num];
+};
+
+/**
+ * Times one sample of a stage, which always goes into the stage's rolling history for Modumate.DumpStageHistograms,
+ * and also into FModumateStageRecorder while it's recording. Nested scopes of the same stage only count once.
+ */
+class MODUMATE_API FModumateStageScope
+{
+public:
+	FModumateStageScope(EModumateStage InStage);
+	~FModumateStageScope();
+
+private:
+	EModumateStage Stage;
+	bool bOutermost;
+	bool bWasRecording;
+	double StartTime;
+	int64 StartAllocations;
+
+	static int32 StageDepths[(int32)EModumateStage::Num];
+};
+
+/** Scene size and output counters, reported both as STATGROUP_Modumate stats and Unreal Insights counters. */
+namespace FModumateCounters
+{
+	MODUMATE_API void SetSceneCounts(int32 NumWalls, int32 NumNodes, int32 NumRooms);
+	MODUMATE_API void AddTrianglesEmitted(int32 NumTriangles);
+	MODUMATE_API void AddDimensionStringsSpawned(int32 NumStrings);
+	MODUMATE_API void AddTriangulationCacheLookup(bool bHit);
+};
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AWall;
+class ARoomNode;
+
+/**
+ * Uniform 2D grid over the XY bounds of placed walls, used to narrow down the candidates
+ * for wall intersection queries instead of testing against every wall.
+ * Walls are referenced weakly; the owner is responsible for keeping the grid in sync
+ * whenever a wall is placed, moved or removed.
+ */
+class MODUMATE_API FWallSpatialGrid
+{
+public:
+	FWallSpatialGrid(float InCellSize = 250.0f);
+
+	/** Changes the cell size, re-inserting every indexed wall if it differs from the current one. */
+	void SetCellSize(float InCellSize);
+	void Empty();
+
+	/** Inserts the wall, or moves it to the cells covered by its current start and end points. */
+	void AddOrUpdateWall(AWall* Wall);
+	void RemoveWall(AWall* Wall);
+	bool ContainsWall(const AWall* Wall) const { return WallCells.Contains(Wall); }
+	int32 Num() const { return WallCells.Num(); }
+
+	/** Gathers every indexed wall that shares a cell with the segment from Start to End, without duplicates. */
+	void QuerySegment(const FVector& Start, const FVector& End, TArray<AWall*>& OutWalls) const;
+
+protected:
+	FIntRect GetCellBounds(const FVector& Start, const FVector& End) const;
+	bool SegmentOverlapsCell(const FVector2D& Start, const FVector2D& End, const FIntPoint& Cell) const;
+	void AddToCells(AWall* Wall, const FIntRect& CellBounds);
+	void RemoveFromCells(AWall* Wall, const FIntRect& CellBounds);
+
+	float CellSize;
+	TMap<FIntPoint, TArray<AWall*>> Cells;
+	TMap<const AWall*, FIntRect> WallCells;
+};
+
+/**
+ * Hashed grid of room nodes, keyed on their XY position quantized by the node epsilon.
+ * Any node within epsilon of a query position lies in the query's cell or one of its 8 neighbors,
+ * so lookups only need to probe a constant number of cells.
+ */
+class MODUMATE_API FRoomNodeSpatialHash
+{
+public:
+	FRoomNodeSpatialHash(float InEpsilon = 0.1f);
+
+	/** Changes the epsilon used for quantization and matching, re-inserting every indexed node if it differs. */
+	void SetEpsilon(float InEpsilon);
+	void Empty();
+
+	/** Inserts the node, or moves it to the cell of its current location. */
+	void AddOrUpdateNode(ARoomNode* Node);
+	void RemoveNode(ARoomNode* Node);
+	int32 Num() const { return NodeCells.Num(); }
+
+	/** Returns the closest indexed node within epsilon of Position, other than IgnoreNode. */
+	ARoomNode* FindNode(const FVector& Position, const ARoomNode* IgnoreNode = nullptr) const;
+
+protected:
+	FIntPoint GetCell(const FVector& Position) const;
+
+	float Epsilon;
+	TMap<FIntPoint, TArray<ARoomNode*, TInlineAllocator<2>>> Cells;
+	TMap<const ARoomNode*, FIntPoint> NodeCells;
+};
@@ -19,6 +19,16 @@ namespace FGraphUtils
 	MODUMATE_API bool PointInTriangle(const FVector& A, const FVector& B, const FVector& C, const FVector& P);
 };
 
+/** A room's floor triangulation, computed off of the game thread by FRoomData::TriangulateFloor and then committed back to it. */
+struct MODUMATE_API FRoomFloorTriangulation
+{
+	TArray<int32> TriangleIndices;
+	float Area = 0.0f;
+	bool bTriangulated = false;
+	bool bSucceeded = true;
+	bool bCacheHit = false;
+};
+
 USTRUCT()
 struct MODUMATE_API FRoomData
 {
@@ -58,12 +68,33 @@ public:
 	UPROPERTY()
 	TMap<class AWall*, int32> BackwardWallIndices;
 
+	// The floor's outline, from the strict loop of walls, followed by the outlines of any islands of walls inside of the room
+	UPROPERTY()
+	TArray<FVector> FloorVertices;
+
+	// The number of FloorVertices in each loop; the first is the room's own loop, and the rest are holes
+	UPROPERTY()
+	TArray<int32> FloorLoopSizes;
+
+	// Constrained Delaunay triangulation of the floor, as indices into FloorVertices
 	UPROPERTY()
 	TArray<int32> TriangleIndices;
 
+	// Floor area, without the holes, in square centimeters
+	UPROPERTY()
+	float Area;
+
+	// Whether the floor's loops have changed since TriangleIndices were last committed
+	UPROPERTY(Transient)
+	bool bFloorDirty;
+
 	UPROPERTY()
 	int32 MinWallIDIndex;
 
+	// Hash of the walls and directions in order, starting from MinWallIDIndex, so that it doesn't depend on where tracing started
+	UPROPERTY()
+	uint32 WallLoopHash;
+
 	bool AddWall(class AWall* NewWall, bool bWallForward);
 	bool Close();
 	bool ContainsWall(class AWall* Wall, bool bWallForward, int32& WallIndex) const;
@@ -71,9 +102,16 @@ public:
 	int32 CompareWalls(const FRoomData& Other) const;
 	bool Equals(const FRoomData& Other, bool bCompareIDs = false) const;
 	float GetWinding(const FVector& FromDir, const FVector& ToDir) const;
+	void GetLoopVertices(TArray<FVector>& OutVertices) const;
+
+	/** Cuts the loops of the given rooms out of the floor, marking it dirty if they or this room's own loop have changed. */
+	bool SetHoles(const TArray<const FRoomData*>& HoleRooms);
 
-protected:
-	bool Triangulate();
+	/** Triangulates the floor without modifying the room, so that it's safe to call for many rooms in parallel. */
+	bool TriangulateFloor(FRoomFloorTriangulation& OutTriangulation) const;
+
+	/** Takes the result of TriangulateFloor, on the game thread. */
+	void CommitFloor(FRoomFloorTriangulation& Triangulation);
 };
 
 /**
@@ -92,13 +130,32 @@ public:
 	UPROPERTY()
 	FRoomData RoomData;
 
+	// This room's face in UEditManager's FWallGraph
+	UPROPERTY()
+	int32 GraphFace;
+
+	// The room's strict loop of nodes and its bounds, cached by CacheLoop each time the room is traced
+	TArray<FVector> LoopVertices;
+	FBox LoopBounds;
+
+	// For islands, the interior room whose floor they're cut out of; for interior rooms, the islands cut out of their floor
+	UPROPERTY(Transient)
+	ARoom* HostRoom;
+
+	UPROPERTY(Transient)
+	TArray<ARoom*> HoleRooms;
+
 	UFUNCTION(BlueprintPure)
 	bool IsInterior() const;
 
+	UFUNCTION(BlueprintPure)
+	float GetFloorArea() const;
+
 	UFUNCTION(BlueprintCallable)
 	void DebugDraw(float Duration = 2.0f) const;
 
 	void UpdateRoomData(const FRoomData& NewRoomData);
+	void CacheLoop();
 
 	// Begin serialization interface
 	TSharedPtr<class FJsonObject> SerializeToJson() const;
@@ -32,6 +32,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	bool bConnectionsDirty;
 
+	// This node's vertex in UEditManager's FWallGraph, which SortedWalls is copied from
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 GraphVertex;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 		bool bGrounded;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
@@ -49,18 +53,9 @@ public:
 
 	/* UFUNCTIONs */
 
-	UFUNCTION(BlueprintCallable)
-	bool ConnectWall(AWall* Wall, bool bAutoUpdate = false);
-
-	UFUNCTION(BlueprintCallable)
-	void SortConnectedWalls();
-
 	UFUNCTION(BlueprintPure)
 	bool IsConnectedToWall(AWall* Wall) const { return WallIndexMap.Contains(Wall); }
 
-	bool FindAdjacentWalls(const AWall* SourceWall, AWall*& LeftWall, AWall*& RightWall) const;
-	bool MergeNode(class ARoomNode* NodeToMerge);
-
 	// Begin serialization interface
 	TSharedPtr<class FJsonObject> SerializeToJson() const;
 	bool DeserializeFromJson(const TSharedPtr<class FJsonObject>& JsonValue);
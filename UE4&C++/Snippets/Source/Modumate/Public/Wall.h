@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/StaticMeshActor.h"
+#include "ModumateWallOpenings.h"
 #include "Wall.generated.h"
 
 USTRUCT(Blueprintable)
@@ -55,38 +56,6 @@ public:
 		FVector t_RightSideEnd;
 };
 
-USTRUCT()
-struct FWallBox
-{
-	GENERATED_BODY()
-
-public:
-
-	UPROPERTY()
-		FVector b_LeftSideStart;
-	UPROPERTY()
-		FVector b_RightSideStart;
-	UPROPERTY()
-		FVector b_LeftSideEnd;
-	UPROPERTY()
-		FVector b_RightSideEnd;
-	UPROPERTY()
-		FVector t_LeftSideStart;
-	UPROPERTY()
-		FVector t_RightSideStart;
-	UPROPERTY()
-		FVector t_LeftSideEnd;
-	UPROPERTY()
-		FVector t_RightSideEnd;
-
-	UPROPERTY()
-		TArray<FVector> wallVertices;
-	UPROPERTY()
-		TArray<int> Triangles;
-
-		void AddVerts();
-	
-};
 /**
  *
  */
@@ -190,17 +159,37 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 		class ARoom* RightRoom;
 
+	// This wall's edge in UEditManager's FWallGraph, which the connectivity and rooms above are copied from
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+		int32 GraphEdge;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 		TArray<FVector> wallVertices;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 		float wallThickness;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+		float wallHeight;
+
 	UPROPERTY()
 		TArray<FIntersectionPoints> intersections;
 
-	UPROPERTY()
-		TArray<FWallBox> WallBoxes;
+	// Windows and doors, as intervals along the wall that its mesh is generated from
+	ModumateCore::FWallOpeningList Openings;
+
+	// While an opening is previewed, the gap between openings that it's in is meshed in a separate section of the wall's mesh
+	UPROPERTY(Transient)
+		bool bPreviewingOpening;
+	UPROPERTY(Transient)
+		float PreviewSpanStart;
+	UPROPERTY(Transient)
+		float PreviewSpanEnd;
+
+	// The procedural mesh that the wall was last meshed into, which is hidden while its UEditManager wall cluster draws it
+	UPROPERTY(Transient)
+		class UProceduralMeshComponent* GeneratedMesh;
+
 	/* UFUNCTIONs */
 
 	UFUNCTION(BlueprintPure)
@@ -218,6 +207,12 @@ public:
 	UFUNCTION(BlueprintCallable)
 		void SetEndPoint(const FVector& NewEndPoint);
 
+	// Moves the end point, the end node and the dimension text, but not the actor, for while the wall is dragged
+	void DragEndPoint(const FVector& NewEndPoint);
+
+	// Fits the actor's transform between the wall's start and end points
+	void UpdateWallTransform();
+
 	UFUNCTION(BlueprintCallable)
 		void AttachFixture(AStaticMeshActor* Fixture);
 
@@ -227,9 +222,6 @@ public:
 	UFUNCTION(BlueprintCallable)
 		void RemovePrevDimStrings();
 
-	UFUNCTION(BlueprintCallable)
-		bool SortConnectedWalls();
-
 	UFUNCTION(BlueprintCallable)
 		void DebugDrawConnectedWalls();
 
@@ -240,7 +232,4 @@ public:
 	TSharedPtr<class FJsonObject> SerializeToJson() const;
 	bool DeserializeFromJson(const TSharedPtr<class FJsonObject>& JsonValue);
 	// End serialization interface
-
-protected:
-	bool FindLeftAndRightWalls(bool bForward, class AWall*& LeftWall, class AWall*& RightWall);
 };
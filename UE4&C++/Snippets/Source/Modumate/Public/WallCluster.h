@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WallCluster.generated.h"
+
+class AWall;
+class FModumateMeshJobQueue;
+class FModumateMeshLODs;
+class UProceduralMeshComponent;
+
+/**
+ * The merged mesh of the placed walls in one cell of FWallClusters. Section 0 has the quads that stand in for their openings,
+ * if it has any, and then each material has a detailed section and a simplified section, where walls are slabs.
+ * It has no collision, since its walls keep theirs on their own, hidden, meshes.
+ */
+UCLASS()
+class MODUMATE_API AWallCluster : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+		class UProceduralMeshComponent* Mesh;
+};
+
+/**
+ * Groups placed walls by the grid cell that their midpoint is in, and draws each group as one AWallCluster,
+ * so that a large project has a primitive per cell rather than per wall. Only the sections of the materials whose walls
+ * changed are remeshed, on worker threads, and each wall's own mesh is only hidden once its section has been uploaded with it.
+ * Selected walls and walls that are being edited are drawn with their own meshes, and left out of their cluster.
+ * Walls are referenced weakly; the owner is responsible for adding them once they're meshed, and removing them,
+ * and any that are destroyed without being removed are dropped when their cluster is next rebuilt.
+ * Clustered walls keep their actors, which are what's edited, and their own meshes' collision, but their hidden meshes
+ * aren't added to the scene, so it's the number of primitives that's per cell rather than the number of actors.
+ */
+class MODUMATE_API FWallClusters
+{
+public:
+	FWallClusters(float InCellSize = 2000.0f);
+
+	/** Changes the cell size, moving every wall into its new cluster if it differs from the current one. */
+	void SetCellSize(float InCellSize);
+
+	/** Forgets every wall, showing its own mesh again, and destroys the cluster actors along with their builds and LODs. */
+	void Empty(FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs);
+
+	/** Sets the material of the quads that stand in for openings in simplified clusters, which have none without it. */
+	void SetOpeningMaterial(class UMaterialInterface* InOpeningMaterial);
+
+	/** Puts the wall into the cluster of its cell, or moves it there, showing its own mesh until the cluster is remeshed. */
+	void AddOrUpdateWall(AWall* Wall);
+	void RemoveWall(AWall* Wall);
+	bool ContainsWall(AWall* Wall) const { return WallCells.Contains(Wall); }
+
+	void SetWallSelected(AWall* Wall, bool bSelected);
+	void SetWallEditing(AWall* Wall, bool bEditing);
+
+	bool HasDirtyClusters() const { return DirtyCells.Num() > 0; }
+	int32 NumClusters() const { return Clusters.Num(); }
+
+	/** Submits a remesh of every cluster whose walls changed, spawning or destroying their actors as needed, and switching their LODs with MeshLODs. */
+	void RebuildDirtyClusters(UWorld* World, FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs);
+
+protected:
+	// A material's detailed and simplified sections in a cluster, which are reused by the next material once it has no walls left
+	struct FClusterSlot
+	{
+		TWeakObjectPtr<class UMaterialInterface> Material;
+		bool bUsed = false;
+	};
+
+	struct FCluster
+	{
+		TWeakObjectPtr<AWallCluster> Actor;
+		TArray<TWeakObjectPtr<AWall>> Walls;
+
+		// The material that each wall drawn by the cluster was last meshed with
+		TMap<TWeakObjectPtr<AWall>, TWeakObjectPtr<class UMaterialInterface>> DrawnMaterials;
+		TArray<FClusterSlot> Slots;
+
+		// Materials whose walls changed since the cluster was last rebuilt, and whether its opening quads did too
+		TSet<TWeakObjectPtr<class UMaterialInterface>> DirtyMaterials;
+		bool bOpeningsDirty = false;
+		bool bHasOpenings = false;
+
+		TArray<int32> DetailSections;
+		TArray<int32> SimplifiedSections;
+	};
+
+	static int32 GetOpeningSection() { return 0; }
+	static int32 GetDetailSection(int32 SlotIndex) { return 1 + 2 * SlotIndex; }
+	static int32 GetSimplifiedSection(int32 SlotIndex) { return 2 + 2 * SlotIndex; }
+
+	FIntVector GetCell(const AWall* Wall) const;
+	bool IsSeparate(AWall* Wall) const { return SelectedWalls.Contains(Wall) || EditingWalls.Contains(Wall); }
+	void SetWallSeparate(AWall* Wall, TSet<TWeakObjectPtr<AWall>>& Reasons, bool bReason);
+	void MarkWallDirty(const FIntVector& Cell, AWall* Wall);
+	void RemoveStaleWalls(FCluster& Cluster);
+	void RebuildCluster(UWorld* World, FModumateMeshJobQueue& MeshJobs, FModumateMeshLODs& MeshLODs, const FIntVector& Cell);
+	void ClearSlot(AWallCluster* ClusterActor, FModumateMeshJobQueue& MeshJobs, FClusterSlot& Slot, int32 SlotIndex);
+	void ShowClusterLOD(FModumateMeshLODs& MeshLODs, UProceduralMeshComponent* ClusterMesh, const FIntVector& Cell) const;
+
+	float CellSize;
+	TWeakObjectPtr<class UMaterialInterface> OpeningMaterial;
+	TMap<FIntVector, FCluster> Clusters;
+	TMap<TWeakObjectPtr<AWall>, FIntVector> WallCells;
+	TSet<TWeakObjectPtr<AWall>> SelectedWalls;
+	TSet<TWeakObjectPtr<AWall>> EditingWalls;
+	TSet<FIntVector> DirtyCells;
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AWall;
+class ARoomNode;
+class ARoom;
+
+struct FWallGraphVertex
+{
+	FVector2D Position;
+	ARoomNode* Node;
+
+	// Outgoing half-edges, sorted counter-clockwise by angle
+	TArray<int32, TInlineAllocator<4>> OutgoingHalfEdges;
+
+	bool bValid;
+};
+
+struct FWallGraphHalfEdge
+{
+	int32 Origin;
+	int32 Next;
+	int32 Prev;
+	int32 Face;
+};
+
+struct FWallGraphFace
+{
+	ARoom* Room;
+	int32 HalfEdge;
+	bool bValid;
+};
+
+/**
+ * Index-based half-edge (DCEL) representation of the walls' planar graph.
+ * Each wall is an edge made of two half-edges: 2 * Edge runs from the wall's start to its end, and 2 * Edge + 1 runs back,
+ * so the twin of a half-edge is always HalfEdge ^ 1. A half-edge's face is the region on its left, matching AWall::LeftRoom
+ * for forward half-edges and AWall::RightRoom for backward ones.
+ * Vertices, edges and faces keep their indices for their whole lifetime; removed indices are reused by later additions.
+ * The wall and room node actors are views of this graph, and UEditManager copies the connectivity into them when it changes.
+ */
+class MODUMATE_API FWallGraph
+{
+public:
+	void Empty();
+
+	int32 AddVertex(ARoomNode* Node, const FVector2D& Position);
+	void RemoveVertex(int32 Vertex);
+	void SetVertexPosition(int32 Vertex, const FVector2D& Position) { Vertices[Vertex].Position = Position; }
+
+	/** Adds an edge for the wall between two vertices, without sorting them; returns the edge index. */
+	int32 AddEdge(AWall* Wall, int32 StartVertex, int32 EndVertex);
+	void RemoveEdge(int32 Edge);
+
+	/** Moves every half-edge leaving FromVertex so that it leaves IntoVertex instead, and removes FromVertex. */
+	void MergeVertices(int32 IntoVertex, int32 FromVertex);
+
+	/** Sorts the vertex's outgoing half-edges by angle, and links each incoming half-edge to the next outgoing one counter-clockwise. */
+	void SortVertex(int32 Vertex);
+
+	int32 AddFace(ARoom* Room);
+	void RemoveFace(int32 Face);
+	void SetFace(int32 HalfEdge, int32 Face);
+
+	static int32 GetTwin(int32 HalfEdge) { return HalfEdge ^ 1; }
+	static int32 GetHalfEdge(int32 Edge, bool bForward) { return 2 * Edge + (bForward ? 0 : 1); }
+	static int32 GetEdge(int32 HalfEdge) { return HalfEdge >> 1; }
+	static bool IsForward(int32 HalfEdge) { return (HalfEdge & 1) == 0; }
+
+	int32 GetNext(int32 HalfEdge) const { return HalfEdges[HalfEdge].Next; }
+	int32 GetPrev(int32 HalfEdge) const { return HalfEdges[HalfEdge].Prev; }
+	int32 GetOrigin(int32 HalfEdge) const { return HalfEdges[HalfEdge].Origin; }
+	int32 GetDestination(int32 HalfEdge) const { return HalfEdges[GetTwin(HalfEdge)].Origin; }
+	int32 GetFace(int32 HalfEdge) const { return HalfEdges[HalfEdge].Face; }
+	AWall* GetWall(int32 HalfEdge) const { return EdgeWalls[GetEdge(HalfEdge)]; }
+	ARoom* GetRoom(int32 HalfEdge) const;
+
+	const FWallGraphVertex& GetVertex(int32 Vertex) const { return Vertices[Vertex]; }
+	const FWallGraphFace& GetFaceData(int32 Face) const { return Faces[Face]; }
+
+	/** Finds the position of the half-edge among its origin's outgoing half-edges, or INDEX_NONE. */
+	int32 FindOutgoingIndex(int32 HalfEdge) const;
+
+	/** Gathers the half-edges of the cycle that HalfEdge belongs to, following Next. Returns false if the cycle doesn't close. */
+	bool GetCycle(int32 HalfEdge, TArray<int32>& OutHalfEdges) const;
+
+protected:
+	TArray<FWallGraphVertex> Vertices;
+	TArray<FWallGraphHalfEdge> HalfEdges;
+	TArray<AWall*> EdgeWalls;
+	TArray<FWallGraphFace> Faces;
+
+	TArray<int32> FreeVertices;
+	TArray<int32> FreeEdges;
+	TArray<int32> FreeFaces;
+};
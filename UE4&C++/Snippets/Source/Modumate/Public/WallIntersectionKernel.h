@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AWall;
+struct FWallIntersection;
+
+/**
+ * Packed structure-of-arrays copy of the 2D wall segments, laid out so that FWallIntersectionKernel
+ * can test one query segment against several walls per vector instruction.
+ * Each wall owns one slot; slots are kept dense by swapping the last wall into a removed slot,
+ * and the arrays are padded with degenerate (zero length) segments up to a multiple of the vector width.
+ * Like FWallSpatialGrid, the owner is responsible for updating the table whenever a wall is placed, moved or removed.
+ */
+class MODUMATE_API FWallSegmentTable
+{
+public:
+	static constexpr int32 LaneCount = 4;
+
+	/** Inserts the wall, or refreshes its slot from its current start and end points. */
+	void AddOrUpdateWall(AWall* Wall);
+	void RemoveWall(AWall* Wall);
+	void Empty();
+
+	int32 Num() const { return Walls.Num(); }
+	int32 NumPadded() const { return StartX.Num(); }
+	int32 FindSlot(const AWall* Wall) const;
+	AWall* GetWall(int32 Slot) const { return Walls[Slot]; }
+	float GetStartZ(int32 Slot) const { return StartZ[Slot]; }
+
+protected:
+	friend class FWallIntersectionKernel;
+	friend class FWallSlotGather;
+
+	void WriteSlot(int32 Slot, const FVector& Start, const FVector& End);
+	void ClearSlot(int32 Slot);
+
+	// The kernel only needs each wall's start, delta and direction, along with the terms of the
+	// scalar intersection math that only depend on the wall, so those are computed once here.
+	TArray<float, TAlignedHeapAllocator<16>> StartX;
+	TArray<float, TAlignedHeapAllocator<16>> StartY;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaX;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaY;
+	TArray<float, TAlignedHeapAllocator<16>> DirX;
+	TArray<float, TAlignedHeapAllocator<16>> DirY;
+	TArray<float, TAlignedHeapAllocator<16>> Length;
+	TArray<float, TAlignedHeapAllocator<16>> StartCross;
+
+	TArray<float> StartZ;
+	TArray<AWall*> Walls;
+	TMap<const AWall*, int32> WallSlots;
+};
+
+/**
+ * Contiguous copy of some of a table's slots, in the same padded SoA layout as the table itself,
+ * so that FWallIntersectionKernel::IntersectSlots can test scattered candidates with aligned loads.
+ * Keep one around between queries, so that its arrays keep their capacity.
+ */
+class MODUMATE_API FWallSlotGather
+{
+public:
+	/** Copies each field of the given (valid) slots into its own contiguous array, padded with degenerate segments. */
+	void Gather(const FWallSegmentTable& Table, const TArray<int32>& InSlots);
+
+protected:
+	friend class FWallIntersectionKernel;
+
+	// Table slot of each gathered lane, or MAX_int32 for padding
+	TArray<int32> Slots;
+
+	TArray<float, TAlignedHeapAllocator<16>> StartX;
+	TArray<float, TAlignedHeapAllocator<16>> StartY;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaX;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaY;
+	TArray<float, TAlignedHeapAllocator<16>> DirX;
+	TArray<float, TAlignedHeapAllocator<16>> DirY;
+	TArray<float, TAlignedHeapAllocator<16>> Length;
+	TArray<float, TAlignedHeapAllocator<16>> StartCross;
+};
+
+/**
+ * Vectorized version of AWall::GetWallIntersection2D, testing one query segment against LaneCount walls at a time.
+ * It follows the same operations as the scalar path, so hits and intersection distances match it.
+ */
+class MODUMATE_API FWallIntersectionKernel
+{
+public:
+	/** Tests the query segment against every wall in the table. Returns the number of intersections added. */
+	static int32 IntersectAll(const FWallSegmentTable& Table, const FVector& QueryStart, const FVector& QueryEnd,
+		TArray<FWallIntersection>& OutIntersections, const AWall* IgnoreWall = nullptr, float Epsilon = 0.01f);
+
+	/** Tests the query segment against the walls in the given table slots, e.g. candidates from a spatial query,
+	    gathering them into Scratch first. */
+	static int32 IntersectSlots(const FWallSegmentTable& Table, const TArray<int32>& Slots, FWallSlotGather& Scratch,
+		const FVector& QueryStart, const FVector& QueryEnd, TArray<FWallIntersection>& OutIntersections,
+		const AWall* IgnoreWall = nullptr, float Epsilon = 0.01f);
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Wall.h"
+
+/** A pair of crossing walls found by FWallSweepIntersector, indexing into the array of walls that was swept. */
+struct MODUMATE_API FWallCrossing
+{
+	int32 WallIndexA;
+	int32 WallIndexB;
+
+	// Intersection as reported by WallA->GetWallIntersection2D(WallB)
+	FWallIntersection Intersection;
+};
+
+/**
+ * Finds every pair of crossing walls in one pass, with the Bentley-Ottmann sweep in ModumateCore::FindSegmentCrossings,
+ * in O((N + K) log N) for N walls and K crossings, instead of testing every pair.
+ * Crossings follow exactly the same epsilon semantics as AWall::GetWallIntersection2D, which wraps the same test.
+ */
+class MODUMATE_API FWallSweepIntersector
+{
+public:
+	/** Finds all pairs of walls in InWalls that cross each other, sorted by wall indices. */
+	static void FindAllCrossings(const TArray<AWall*>& InWalls, TArray<FWallCrossing>& OutCrossings, float Epsilon = 0.01f);
+};
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+// Engine-independent geometry and topology algorithms, shared by the Modumate module.
+// The same sources also build outside of the engine with Benchmarks/CMakeLists.txt, for headless benchmarking.
+public class ModumateCore : ModuleRules
+{
+	public ModumateCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] {
+			"Core",
+		});
+	}
+}
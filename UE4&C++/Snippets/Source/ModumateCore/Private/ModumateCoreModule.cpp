@@ -0,0 +1,6 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Only built by UnrealBuildTool; the standalone CMake build compiles the rest of the module's sources without the engine.
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, ModumateCore);
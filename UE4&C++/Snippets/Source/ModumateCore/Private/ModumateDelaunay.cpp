@@ -0,0 +1,828 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateDelaunay.h"
+
+#include "ModumateTriangulationBuffers.h"
+
+#include <algorithm>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		typedef FDelaunayPoint FPoint;
+		typedef FDelaunayTriangle FTriangle;
+		typedef FDelaunayEdge FEdge;
+
+		// Twice the signed area of ABC, which is positive when it winds counter-clockwise in the projected plane
+		double Orient(const FPoint& A, const FPoint& B, const FPoint& C)
+		{
+			return (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+		}
+
+		// A little looser than Shewchuk's bound on the rounding error of InCircle's determinant, relative to its permanent
+		const double InCircleErrorBound = 1.0e-14;
+
+		// Positive when D is strictly inside the circumcircle of the counter-clockwise triangle ABC, and 0 when it's too close
+		// to the circle to tell, as the corners of rectangles are, so that neither diagonal of a cocircular quad is ever flipped
+		double InCircle(const FPoint& A, const FPoint& B, const FPoint& C, const FPoint& D)
+		{
+			double ADX = A.X - D.X, ADY = A.Y - D.Y;
+			double BDX = B.X - D.X, BDY = B.Y - D.Y;
+			double CDX = C.X - D.X, CDY = C.Y - D.Y;
+
+			double ALift = ADX * ADX + ADY * ADY;
+			double BLift = BDX * BDX + BDY * BDY;
+			double CLift = CDX * CDX + CDY * CDY;
+
+			double Det = ALift * (BDX * CDY - CDX * BDY) + BLift * (CDX * ADY - ADX * CDY) + CLift * (ADX * BDY - BDX * ADY);
+			double Permanent = ALift * (std::abs(BDX * CDY) + std::abs(CDX * BDY)) + BLift * (std::abs(CDX * ADY) + std::abs(ADX * CDY)) +
+				CLift * (std::abs(ADX * BDY) + std::abs(BDX * ADY));
+
+			return (std::abs(Det) > InCircleErrorBound * Permanent) ? Det : 0.0;
+		}
+
+		// Whether the segments cross at a point that is strictly inside of both of them
+		bool SegmentsCross(const FPoint& A, const FPoint& B, const FPoint& C, const FPoint& D)
+		{
+			return ((Orient(A, B, C) * Orient(A, B, D)) < 0.0) && ((Orient(C, D, A) * Orient(C, D, B)) < 0.0);
+		}
+
+		// Interleaves the bits of the coordinates, quantized to 16 bits within the points' bounds
+		uint32_t ZOrder(const FPoint& Point, double MinX, double MinY, double InvSize)
+		{
+			uint32_t QX = static_cast<uint32_t>((Point.X - MinX) * InvSize);
+			uint32_t QY = static_cast<uint32_t>((Point.Y - MinY) * InvSize);
+
+			QX = (QX | (QX << 8)) & 0x00FF00FF;
+			QX = (QX | (QX << 4)) & 0x0F0F0F0F;
+			QX = (QX | (QX << 2)) & 0x33333333;
+			QX = (QX | (QX << 1)) & 0x55555555;
+
+			QY = (QY | (QY << 8)) & 0x00FF00FF;
+			QY = (QY | (QY << 4)) & 0x0F0F0F0F;
+			QY = (QY | (QY << 2)) & 0x33333333;
+			QY = (QY | (QY << 1)) & 0x55555555;
+
+			return QX | (QY << 1);
+		}
+
+		int32_t NextCorner(int32_t Corner) { return (Corner == 2) ? 0 : (Corner + 1); }
+		int32_t PrevCorner(int32_t Corner) { return (Corner == 0) ? 2 : (Corner - 1); }
+
+		class FDelaunayTriangulator
+		{
+		public:
+			// Triangulates the buffers' points, which the super triangle's vertices are added to
+			FDelaunayTriangulator(FDelaunayBuffers& Buffers)
+				: Points(Buffers.Points)
+				, NumInputPoints(static_cast<int32_t>(Buffers.Points.size()))
+				, Triangles(Buffers.Triangles)
+				, VertTriangles(Buffers.VertTriangles)
+				, SortedPoints(Buffers.SortedPoints)
+				, LegalizeStack(Buffers.LegalizeStack)
+				, CrossedEdges(Buffers.CrossedEdges)
+				, NewEdges(Buffers.NewEdges)
+				, Fan(Buffers.Fan)
+				, Depths(Buffers.Depths)
+				, CurrentTriangles(Buffers.CurrentTriangles)
+				, DeeperTriangles(Buffers.DeeperTriangles)
+			{
+				// Start from a triangle that is large enough to contain every point, and whose vertices are discarded at the end
+				double MinX = Points[0].X, MinY = Points[0].Y, MaxX = MinX, MaxY = MinY;
+				for (const FPoint& Point : Points)
+				{
+					MinX = std::min(MinX, Point.X);
+					MinY = std::min(MinY, Point.Y);
+					MaxX = std::max(MaxX, Point.X);
+					MaxY = std::max(MaxY, Point.Y);
+				}
+
+				double CenterX = 0.5 * (MinX + MaxX), CenterY = 0.5 * (MinY + MaxY);
+				double Size = std::max(std::max(MaxX - MinX, MaxY - MinY), 1.0);
+				Points.push_back({ CenterX - 20.0 * Size, CenterY - 10.0 * Size });
+				Points.push_back({ CenterX + 20.0 * Size, CenterY - 10.0 * Size });
+				Points.push_back({ CenterX, CenterY + 20.0 * Size });
+
+				Triangles.clear();
+				Triangles.reserve(2 * Points.size());
+				Triangles.push_back({ { NumInputPoints, NumInputPoints + 1, NumInputPoints + 2 }, { -1, -1, -1 }, { 0, 0, 0 } });
+				VertTriangles.assign(Points.size(), 0);
+			}
+
+			bool InsertPoints()
+			{
+				double MinX = Points[0].X, MinY = Points[0].Y, MaxX = MinX, MaxY = MinY;
+				for (int32_t PointIndex = 0; PointIndex < NumInputPoints; ++PointIndex)
+				{
+					MinX = std::min(MinX, Points[PointIndex].X);
+					MinY = std::min(MinY, Points[PointIndex].Y);
+					MaxX = std::max(MaxX, Points[PointIndex].X);
+					MaxY = std::max(MaxY, Points[PointIndex].Y);
+				}
+				double Size = std::max(MaxX - MinX, MaxY - MinY);
+				double InvSize = (Size > 0.0) ? (32767.0 / Size) : 0.0;
+
+				// Inserting in z-order keeps each point close to the last one, so locating it only walks a few triangles
+				SortedPoints.resize(NumInputPoints);
+				for (int32_t PointIndex = 0; PointIndex < NumInputPoints; ++PointIndex)
+				{
+					SortedPoints[PointIndex] = { ZOrder(Points[PointIndex], MinX, MinY, InvSize), PointIndex };
+				}
+				std::sort(SortedPoints.begin(), SortedPoints.end());
+
+				int32_t LastTriangle = 0;
+				for (const auto& SortedPoint : SortedPoints)
+				{
+					if (!InsertPoint(SortedPoint.second, LastTriangle))
+					{
+						return false;
+					}
+					LastTriangle = VertTriangles[SortedPoint.second];
+				}
+
+				return true;
+			}
+
+			bool InsertConstraint(int32_t A, int32_t B)
+			{
+				// Each pass constrains the part of AB up to the first vertex on it
+				for (int32_t Pass = 0; A != B; ++Pass)
+				{
+					int32_t Tri, Corner;
+					if (FindEdge(A, B, Tri, Corner))
+					{
+						MarkConstraint(Tri, Corner);
+						return true;
+					}
+
+					int32_t Hit = B;
+					CrossedEdges.clear();
+					if ((Pass > NumInputPoints) || !FindCrossedEdges(A, B, Hit))
+					{
+						return false;
+					}
+
+					if (!CrossedEdges.empty() && !RemoveCrossedEdges(A, Hit))
+					{
+						return false;
+					}
+
+					if (!FindEdge(A, Hit, Tri, Corner))
+					{
+						return false;
+					}
+					MarkConstraint(Tri, Corner);
+					A = Hit;
+				}
+
+				return true;
+			}
+
+			// Writes the triangles that are inside of an odd number of constraint loops, clockwise, returning the number of indices,
+			// or -1 if there are more than MaxIndices of them, which only happens when the loops aren't a valid polygon
+			int32_t GetInteriorTriangles(const int32_t* PointVerts, int32_t MaxIndices, int32_t* OutIndices)
+			{
+				// Flood fill from the outside, where crossing a constraint edge goes one level deeper
+				std::vector<int32_t>& Current = CurrentTriangles;
+				std::vector<int32_t>& Deeper = DeeperTriangles;
+				Depths.assign(Triangles.size(), -1);
+				Current.assign(1, VertTriangles[NumInputPoints]);
+				Deeper.clear();
+				Depths[Current[0]] = 0;
+
+				for (int32_t Depth = 0; !Current.empty(); ++Depth)
+				{
+					while (!Current.empty())
+					{
+						int32_t Tri = Current.back();
+						Current.pop_back();
+
+						const FTriangle& Triangle = Triangles[Tri];
+						for (int32_t Corner = 0; Corner < 3; ++Corner)
+						{
+							int32_t Neighbor = Triangle.Neighbors[Corner];
+							if ((Neighbor < 0) || (Depths[Neighbor] >= 0))
+							{
+								continue;
+							}
+
+							if ((Triangle.Constraints[Corner] & 1) != 0)
+							{
+								Deeper.push_back(Neighbor);
+							}
+							else
+							{
+								Depths[Neighbor] = Depth;
+								Current.push_back(Neighbor);
+							}
+						}
+					}
+
+					for (int32_t Tri : Deeper)
+					{
+						if (Depths[Tri] < 0)
+						{
+							Depths[Tri] = Depth + 1;
+							Current.push_back(Tri);
+						}
+					}
+					Deeper.clear();
+				}
+
+				// Reverse the counter-clockwise triangles, so that they wind clockwise around the normal
+				int32_t NumIndices = 0;
+				for (size_t Tri = 0; Tri < Triangles.size(); ++Tri)
+				{
+					const FTriangle& Triangle = Triangles[Tri];
+					if (((Depths[Tri] & 1) != 0) && (Triangle.Verts[0] < NumInputPoints) &&
+						(Triangle.Verts[1] < NumInputPoints) && (Triangle.Verts[2] < NumInputPoints))
+					{
+						if (NumIndices + 3 > MaxIndices)
+						{
+							return -1;
+						}
+
+						OutIndices[NumIndices++] = PointVerts[Triangle.Verts[0]];
+						OutIndices[NumIndices++] = PointVerts[Triangle.Verts[2]];
+						OutIndices[NumIndices++] = PointVerts[Triangle.Verts[1]];
+					}
+				}
+
+				return NumIndices;
+			}
+
+		private:
+			bool InsertPoint(int32_t Point, int32_t StartTriangle)
+			{
+				int32_t Corner = -1;
+				int32_t Tri = Locate(Points[Point], StartTriangle, Corner);
+				if (Tri < 0)
+				{
+					return false;
+				}
+
+				if (Corner < 0)
+				{
+					SplitTriangle(Tri, Point);
+				}
+				else
+				{
+					SplitEdge(Tri, Corner, Point);
+				}
+
+				return Legalize();
+			}
+
+			// Finds the triangle containing the point by walking towards it, and which edge it's on, if any
+			int32_t Locate(const FPoint& Point, int32_t Tri, int32_t& OutCorner) const
+			{
+				// Rotating which edge is tested first keeps the walk from cycling
+				int32_t MaxSteps = static_cast<int32_t>(Triangles.size()) + 3;
+				for (int32_t Step = 0; (Step < MaxSteps) && (Tri >= 0); ++Step)
+				{
+					const FTriangle& Triangle = Triangles[Tri];
+					int32_t NextTri = -1;
+					for (int32_t Offset = 0; Offset < 3; ++Offset)
+					{
+						int32_t Corner = (Step + Offset) % 3;
+						if (Orient(Points[Triangle.Verts[NextCorner(Corner)]], Points[Triangle.Verts[PrevCorner(Corner)]], Point) < 0.0)
+						{
+							NextTri = Triangle.Neighbors[Corner];
+							break;
+						}
+					}
+
+					if (NextTri == -1)
+					{
+						return ContainsPoint(Tri, Point, OutCorner) ? Tri : -1;
+					}
+					Tri = NextTri;
+				}
+
+				for (int32_t ScanTri = 0; ScanTri < static_cast<int32_t>(Triangles.size()); ++ScanTri)
+				{
+					if (ContainsPoint(ScanTri, Point, OutCorner))
+					{
+						return ScanTri;
+					}
+				}
+
+				return -1;
+			}
+
+			bool ContainsPoint(int32_t Tri, const FPoint& Point, int32_t& OutCorner) const
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				int32_t NumOnEdges = 0;
+				OutCorner = -1;
+				for (int32_t Corner = 0; Corner < 3; ++Corner)
+				{
+					double Side = Orient(Points[Triangle.Verts[NextCorner(Corner)]], Points[Triangle.Verts[PrevCorner(Corner)]], Point);
+					if (Side < 0.0)
+					{
+						return false;
+					}
+					if (Side == 0.0)
+					{
+						OutCorner = Corner;
+						++NumOnEdges;
+					}
+				}
+
+				// A point on two edges is on a vertex, which only happens for points that should have been merged
+				return NumOnEdges < 2;
+			}
+
+			void SplitTriangle(int32_t Tri, int32_t Point)
+			{
+				FTriangle Old = Triangles[Tri];
+				int32_t Tri1 = static_cast<int32_t>(Triangles.size());
+				int32_t Tri2 = Tri1 + 1;
+
+				Triangles[Tri] = { { Point, Old.Verts[1], Old.Verts[2] }, { Old.Neighbors[0], Tri1, Tri2 }, { Old.Constraints[0], 0, 0 } };
+				Triangles.push_back({ { Point, Old.Verts[2], Old.Verts[0] }, { Old.Neighbors[1], Tri2, Tri }, { Old.Constraints[1], 0, 0 } });
+				Triangles.push_back({ { Point, Old.Verts[0], Old.Verts[1] }, { Old.Neighbors[2], Tri, Tri1 }, { Old.Constraints[2], 0, 0 } });
+
+				ReplaceNeighbor(Old.Neighbors[1], Tri, Tri1);
+				ReplaceNeighbor(Old.Neighbors[2], Tri, Tri2);
+				UpdateVertTriangles(Tri);
+				UpdateVertTriangles(Tri1);
+				UpdateVertTriangles(Tri2);
+
+				LegalizeStack.push_back({ Tri, 0 });
+				LegalizeStack.push_back({ Tri1, 0 });
+				LegalizeStack.push_back({ Tri2, 0 });
+			}
+
+			void SplitEdge(int32_t Tri, int32_t Corner, int32_t Point)
+			{
+				// Split the edge AB, between the triangles CAB and DBA, into four triangles around the point
+				FTriangle Old = Triangles[Tri];
+				int32_t Opp = Old.Neighbors[Corner];
+				FTriangle OldOpp = Triangles[Opp];
+				int32_t OppCorner = FindNeighborCorner(Opp, Tri);
+
+				int32_t C = Old.Verts[Corner], A = Old.Verts[NextCorner(Corner)], B = Old.Verts[PrevCorner(Corner)];
+				int32_t D = OldOpp.Verts[OppCorner];
+				uint8_t EdgeConstraints = Old.Constraints[Corner];
+
+				int32_t NeighborBC = Old.Neighbors[NextCorner(Corner)], NeighborCA = Old.Neighbors[PrevCorner(Corner)];
+				uint8_t ConstraintsBC = Old.Constraints[NextCorner(Corner)], ConstraintsCA = Old.Constraints[PrevCorner(Corner)];
+				int32_t NeighborAD = OldOpp.Neighbors[NextCorner(OppCorner)], NeighborDB = OldOpp.Neighbors[PrevCorner(OppCorner)];
+				uint8_t ConstraintsAD = OldOpp.Constraints[NextCorner(OppCorner)], ConstraintsDB = OldOpp.Constraints[PrevCorner(OppCorner)];
+
+				int32_t Tri1 = static_cast<int32_t>(Triangles.size());
+				int32_t Tri3 = Tri1 + 1;
+
+				Triangles[Tri] = { { C, A, Point }, { Tri3, Tri1, NeighborCA }, { EdgeConstraints, 0, ConstraintsCA } };
+				Triangles.push_back({ { C, Point, B }, { Opp, NeighborBC, Tri }, { EdgeConstraints, ConstraintsBC, 0 } });
+				Triangles[Opp] = { { D, B, Point }, { Tri1, Tri3, NeighborDB }, { EdgeConstraints, 0, ConstraintsDB } };
+				Triangles.push_back({ { D, Point, A }, { Tri, NeighborAD, Opp }, { EdgeConstraints, ConstraintsAD, 0 } });
+
+				ReplaceNeighbor(NeighborBC, Tri, Tri1);
+				ReplaceNeighbor(NeighborAD, Opp, Tri3);
+				UpdateVertTriangles(Tri);
+				UpdateVertTriangles(Tri1);
+				UpdateVertTriangles(Opp);
+				UpdateVertTriangles(Tri3);
+
+				LegalizeStack.push_back({ Tri, 2 });
+				LegalizeStack.push_back({ Tri1, 1 });
+				LegalizeStack.push_back({ Opp, 2 });
+				LegalizeStack.push_back({ Tri3, 1 });
+			}
+
+			// Flips edges opposite of the new point until they're all locally Delaunay again
+			bool Legalize()
+			{
+				int32_t MaxFlips = 8 * static_cast<int32_t>(Triangles.size()) + 64;
+				for (int32_t NumFlips = 0; !LegalizeStack.empty(); )
+				{
+					FEdge Entry = LegalizeStack.back();
+					LegalizeStack.pop_back();
+
+					int32_t Tri = Entry.first, Corner = Entry.second;
+					if (!ShouldFlip(Tri, Corner))
+					{
+						continue;
+					}
+
+					if (++NumFlips > MaxFlips)
+					{
+						LegalizeStack.clear();
+						return false;
+					}
+
+					int32_t Opp = Triangles[Tri].Neighbors[Corner];
+					FlipEdge(Tri, Corner);
+					LegalizeStack.push_back({ Tri, 0 });
+					LegalizeStack.push_back({ Opp, 0 });
+				}
+
+				return true;
+			}
+
+			bool ShouldFlip(int32_t Tri, int32_t Corner) const
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				int32_t Opp = Triangle.Neighbors[Corner];
+				if ((Opp < 0) || (Triangle.Constraints[Corner] != 0))
+				{
+					return false;
+				}
+
+				int32_t D = Triangles[Opp].Verts[FindNeighborCorner(Opp, Tri)];
+				return (InCircle(Points[Triangle.Verts[0]], Points[Triangle.Verts[1]], Points[Triangle.Verts[2]], Points[D]) > 0.0) &&
+					CanFlip(Tri, Corner);
+			}
+
+			// Whether the two triangles on the edge opposite of the corner make a strictly convex quad
+			bool CanFlip(int32_t Tri, int32_t Corner) const
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				int32_t Opp = Triangle.Neighbors[Corner];
+				const FPoint& P = Points[Triangle.Verts[Corner]];
+				const FPoint& D = Points[Triangles[Opp].Verts[FindNeighborCorner(Opp, Tri)]];
+				return (Orient(P, D, Points[Triangle.Verts[NextCorner(Corner)]]) * Orient(P, D, Points[Triangle.Verts[PrevCorner(Corner)]])) < 0.0;
+			}
+
+			// Replaces the edge AB, between PAB and DBA, with PD, leaving PAD in Tri and PDB in its neighbor
+			void FlipEdge(int32_t Tri, int32_t Corner)
+			{
+				FTriangle Old = Triangles[Tri];
+				int32_t Opp = Old.Neighbors[Corner];
+				FTriangle OldOpp = Triangles[Opp];
+				int32_t OppCorner = FindNeighborCorner(Opp, Tri);
+
+				int32_t P = Old.Verts[Corner], A = Old.Verts[NextCorner(Corner)], B = Old.Verts[PrevCorner(Corner)];
+				int32_t D = OldOpp.Verts[OppCorner];
+
+				int32_t NeighborBP = Old.Neighbors[NextCorner(Corner)], NeighborPA = Old.Neighbors[PrevCorner(Corner)];
+				uint8_t ConstraintsBP = Old.Constraints[NextCorner(Corner)], ConstraintsPA = Old.Constraints[PrevCorner(Corner)];
+				int32_t NeighborAD = OldOpp.Neighbors[NextCorner(OppCorner)], NeighborDB = OldOpp.Neighbors[PrevCorner(OppCorner)];
+				uint8_t ConstraintsAD = OldOpp.Constraints[NextCorner(OppCorner)], ConstraintsDB = OldOpp.Constraints[PrevCorner(OppCorner)];
+
+				Triangles[Tri] = { { P, A, D }, { NeighborAD, Opp, NeighborPA }, { ConstraintsAD, 0, ConstraintsPA } };
+				Triangles[Opp] = { { P, D, B }, { NeighborDB, NeighborBP, Tri }, { ConstraintsDB, ConstraintsBP, 0 } };
+
+				ReplaceNeighbor(NeighborAD, Opp, Tri);
+				ReplaceNeighbor(NeighborBP, Tri, Opp);
+				UpdateVertTriangles(Tri);
+				UpdateVertTriangles(Opp);
+			}
+
+			// Collects the edges that AB crosses, walking from A until it reaches B or runs into another vertex on AB
+			bool FindCrossedEdges(int32_t A, int32_t B, int32_t& OutHit)
+			{
+				const FPoint& PointA = Points[A];
+				const FPoint& PointB = Points[B];
+				auto IsAhead = [&PointA, &PointB](const FPoint& Point) {
+					return ((Point.X - PointA.X) * (PointB.X - PointA.X) + (Point.Y - PointA.Y) * (PointB.Y - PointA.Y)) > 0.0;
+				};
+
+				int32_t Tri = -1, Corner = -1;
+				GetTrianglesAround(A);
+				for (int32_t FanTri : Fan)
+				{
+					const FTriangle& Triangle = Triangles[FanTri];
+					int32_t ACorner = FindVertCorner(FanTri, A);
+					int32_t Left = Triangle.Verts[NextCorner(ACorner)], Right = Triangle.Verts[PrevCorner(ACorner)];
+					double LeftSide = Orient(PointA, PointB, Points[Left]);
+					double RightSide = Orient(PointA, PointB, Points[Right]);
+
+					if ((LeftSide == 0.0) && IsAhead(Points[Left]))
+					{
+						OutHit = Left;
+						return true;
+					}
+					if ((RightSide == 0.0) && IsAhead(Points[Right]))
+					{
+						OutHit = Right;
+						return true;
+					}
+					if ((LeftSide < 0.0) && (RightSide > 0.0))
+					{
+						Tri = FanTri;
+						Corner = ACorner;
+						break;
+					}
+				}
+
+				if (Tri < 0)
+				{
+					return false;
+				}
+
+				for (int32_t Step = 0; Step < static_cast<int32_t>(Triangles.size()); ++Step)
+				{
+					const FTriangle& Triangle = Triangles[Tri];
+					if (Triangle.Constraints[Corner] != 0)
+					{
+						// Constraints can only meet at vertices
+						return false;
+					}
+					CrossedEdges.push_back({ Triangle.Verts[NextCorner(Corner)], Triangle.Verts[PrevCorner(Corner)] });
+
+					int32_t Opp = Triangle.Neighbors[Corner];
+					if (Opp < 0)
+					{
+						return false;
+					}
+
+					const FTriangle& OppTriangle = Triangles[Opp];
+					int32_t OppCorner = FindNeighborCorner(Opp, Tri);
+					int32_t Far = OppTriangle.Verts[OppCorner];
+					if (Far == B)
+					{
+						OutHit = B;
+						return true;
+					}
+
+					double FarSide = Orient(PointA, PointB, Points[Far]);
+					if (FarSide == 0.0)
+					{
+						OutHit = Far;
+						return true;
+					}
+
+					// Leave through the edge between the far vertex and whichever crossed vertex is on the other side of AB
+					double NextSide = Orient(PointA, PointB, Points[OppTriangle.Verts[NextCorner(OppCorner)]]);
+					Corner = ((NextSide < 0.0) != (FarSide < 0.0)) ? PrevCorner(OppCorner) : NextCorner(OppCorner);
+					Tri = Opp;
+				}
+
+				return false;
+			}
+
+			// Flips the crossed edges until AB is an edge, then restores the Delaunay condition around it
+			bool RemoveCrossedEdges(int32_t A, int32_t B)
+			{
+				NewEdges.clear();
+				size_t MaxFlips = 4 * (CrossedEdges.size() + 1) * (CrossedEdges.size() + 1) + 64;
+				size_t NumFlips = 0;
+
+				for (size_t Head = 0; Head < CrossedEdges.size(); ++Head)
+				{
+					if (++NumFlips > MaxFlips)
+					{
+						return false;
+					}
+
+					FEdge Edge = CrossedEdges[Head];
+					int32_t Tri, Corner;
+					if (!FindEdge(Edge.first, Edge.second, Tri, Corner))
+					{
+						return false;
+					}
+
+					// Edges whose quad isn't convex yet get another try once their neighbors have been flipped
+					if (!CanFlip(Tri, Corner))
+					{
+						CrossedEdges.push_back(Edge);
+						continue;
+					}
+
+					int32_t P = Triangles[Tri].Verts[Corner];
+					int32_t Opp = Triangles[Tri].Neighbors[Corner];
+					int32_t D = Triangles[Opp].Verts[FindNeighborCorner(Opp, Tri)];
+					FlipEdge(Tri, Corner);
+
+					bool bSharesEndpoint = (P == A) || (P == B) || (D == A) || (D == B);
+					if (!bSharesEndpoint && SegmentsCross(Points[P], Points[D], Points[A], Points[B]))
+					{
+						CrossedEdges.push_back({ P, D });
+					}
+					else
+					{
+						NewEdges.push_back({ P, D });
+					}
+				}
+
+				// Only edges that are clearly not Delaunay get flipped, and never the constraints, so this can't flip an edge back and forth
+				for (bool bFlipped = true; bFlipped; )
+				{
+					bFlipped = false;
+					for (FEdge& Edge : NewEdges)
+					{
+						bool bIsConstraint = ((Edge.first == A) && (Edge.second == B)) || ((Edge.first == B) && (Edge.second == A));
+						int32_t Tri, Corner;
+						if (bIsConstraint || !FindEdge(Edge.first, Edge.second, Tri, Corner) || !ShouldFlip(Tri, Corner))
+						{
+							continue;
+						}
+
+						if (++NumFlips > MaxFlips)
+						{
+							return false;
+						}
+
+						int32_t P = Triangles[Tri].Verts[Corner];
+						int32_t Opp = Triangles[Tri].Neighbors[Corner];
+						int32_t D = Triangles[Opp].Verts[FindNeighborCorner(Opp, Tri)];
+						FlipEdge(Tri, Corner);
+						Edge = { P, D };
+						bFlipped = true;
+					}
+				}
+
+				return true;
+			}
+
+			void MarkConstraint(int32_t Tri, int32_t Corner)
+			{
+				FTriangle& Triangle = Triangles[Tri];
+				++Triangle.Constraints[Corner];
+
+				int32_t Opp = Triangle.Neighbors[Corner];
+				if (Opp >= 0)
+				{
+					++Triangles[Opp].Constraints[FindNeighborCorner(Opp, Tri)];
+				}
+			}
+
+			// Finds a triangle with the edge UV, and the corner opposite of it
+			bool FindEdge(int32_t U, int32_t V, int32_t& OutTri, int32_t& OutCorner)
+			{
+				GetTrianglesAround(U);
+				for (int32_t Tri : Fan)
+				{
+					const FTriangle& Triangle = Triangles[Tri];
+					int32_t UCorner = FindVertCorner(Tri, U);
+					if (Triangle.Verts[NextCorner(UCorner)] == V)
+					{
+						OutTri = Tri;
+						OutCorner = PrevCorner(UCorner);
+						return true;
+					}
+					if (Triangle.Verts[PrevCorner(UCorner)] == V)
+					{
+						OutTri = Tri;
+						OutCorner = NextCorner(UCorner);
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			void GetTrianglesAround(int32_t Vert)
+			{
+				Fan.clear();
+				int32_t Start = VertTriangles[Vert];
+				int32_t Tri = Start;
+				do
+				{
+					Fan.push_back(Tri);
+					Tri = Triangles[Tri].Neighbors[NextCorner(FindVertCorner(Tri, Vert))];
+				} while ((Tri != Start) && (Tri >= 0) && (Fan.size() <= Triangles.size()));
+
+				// Only the super triangle's vertices are on the hull, but go back the other way in case the fan is open
+				if (Tri < 0)
+				{
+					for (Tri = Triangles[Start].Neighbors[PrevCorner(FindVertCorner(Start, Vert))]; Tri >= 0;
+						Tri = Triangles[Tri].Neighbors[PrevCorner(FindVertCorner(Tri, Vert))])
+					{
+						Fan.push_back(Tri);
+					}
+				}
+			}
+
+			int32_t FindVertCorner(int32_t Tri, int32_t Vert) const
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				return (Triangle.Verts[0] == Vert) ? 0 : ((Triangle.Verts[1] == Vert) ? 1 : 2);
+			}
+
+			int32_t FindNeighborCorner(int32_t Tri, int32_t Neighbor) const
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				return (Triangle.Neighbors[0] == Neighbor) ? 0 : ((Triangle.Neighbors[1] == Neighbor) ? 1 : 2);
+			}
+
+			void ReplaceNeighbor(int32_t Tri, int32_t OldNeighbor, int32_t NewNeighbor)
+			{
+				if (Tri >= 0)
+				{
+					FTriangle& Triangle = Triangles[Tri];
+					Triangle.Neighbors[FindNeighborCorner(Tri, OldNeighbor)] = NewNeighbor;
+				}
+			}
+
+			void UpdateVertTriangles(int32_t Tri)
+			{
+				const FTriangle& Triangle = Triangles[Tri];
+				VertTriangles[Triangle.Verts[0]] = VertTriangles[Triangle.Verts[1]] = VertTriangles[Triangle.Verts[2]] = Tri;
+			}
+
+			std::vector<FPoint>& Points;
+			int32_t NumInputPoints;
+			std::vector<FTriangle>& Triangles;
+			std::vector<int32_t>& VertTriangles;
+
+			std::vector<std::pair<uint32_t, int32_t>>& SortedPoints;
+			std::vector<FEdge>& LegalizeStack;
+			std::vector<FEdge>& CrossedEdges;
+			std::vector<FEdge>& NewEdges;
+			std::vector<int32_t>& Fan;
+			std::vector<int32_t>& Depths;
+			std::vector<int32_t>& CurrentTriangles;
+			std::vector<int32_t>& DeeperTriangles;
+		};
+	}
+
+	int32_t TriangulateProjectedPolygonDelaunay(const int32_t* LoopSizes, int32_t NumLoops, FTriangulationScratch& Scratch, int32_t* OutIndices)
+	{
+		if ((NumLoops < 1) || (LoopSizes[0] < 3))
+		{
+			return 0;
+		}
+
+		int32_t NumVerts = 0;
+		for (int32_t LoopIndex = 0; LoopIndex < NumLoops; ++LoopIndex)
+		{
+			NumVerts += LoopSizes[LoopIndex];
+		}
+
+		const std::vector<FVec2>& Projected = Scratch.Projected;
+		FDelaunayBuffers& Buffers = Scratch.GetDelaunayBuffers();
+
+		// Merge coincident vertices, keeping the first index of each for the output
+		std::vector<int32_t>& SortedVerts = Buffers.SortedVerts;
+		SortedVerts.resize(NumVerts);
+		for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+		{
+			SortedVerts[VertIndex] = VertIndex;
+		}
+		std::sort(SortedVerts.begin(), SortedVerts.end(), [&Projected](int32_t A, int32_t B) {
+			const FVec2& VertA = Projected[A];
+			const FVec2& VertB = Projected[B];
+			return (VertA.X < VertB.X) || ((VertA.X == VertB.X) && ((VertA.Y < VertB.Y) || ((VertA.Y == VertB.Y) && (A < B))));
+		});
+
+		std::vector<FPoint>& Points = Buffers.Points;
+		std::vector<int32_t>& PointVerts = Buffers.PointVerts;
+		std::vector<int32_t>& VertPoints = Buffers.VertPoints;
+		Points.clear();
+		PointVerts.clear();
+		VertPoints.resize(NumVerts);
+		for (int32_t SortedIndex = 0; SortedIndex < NumVerts; ++SortedIndex)
+		{
+			int32_t VertIndex = SortedVerts[SortedIndex];
+			const FVec2& Vert = Projected[VertIndex];
+			if ((SortedIndex > 0) && (Projected[SortedVerts[SortedIndex - 1]].X == Vert.X) && (Projected[SortedVerts[SortedIndex - 1]].Y == Vert.Y))
+			{
+				VertPoints[VertIndex] = VertPoints[SortedVerts[SortedIndex - 1]];
+				continue;
+			}
+
+			VertPoints[VertIndex] = static_cast<int32_t>(Points.size());
+			Points.push_back({ Vert.X, Vert.Y });
+			PointVerts.push_back(VertIndex);
+		}
+
+		if (Points.size() < 3)
+		{
+			return 0;
+		}
+
+		FDelaunayTriangulator Triangulator(Buffers);
+		if (!Triangulator.InsertPoints())
+		{
+			return -1;
+		}
+
+		for (int32_t LoopIndex = 0, LoopStart = 0; LoopIndex < NumLoops; LoopStart += LoopSizes[LoopIndex++])
+		{
+			for (int32_t LoopVert = 0; LoopVert < LoopSizes[LoopIndex]; ++LoopVert)
+			{
+				int32_t A = VertPoints[LoopStart + LoopVert];
+				int32_t B = VertPoints[LoopStart + (LoopVert + 1) % LoopSizes[LoopIndex]];
+				if ((A != B) && !Triangulator.InsertConstraint(A, B))
+				{
+					return -1;
+				}
+			}
+		}
+
+		return Triangulator.GetInteriorTriangles(PointVerts.data(), GetMaxTriangleIndices(NumVerts, NumLoops), OutIndices);
+	}
+
+	bool TriangulatePolygonDelaunay(const FVec3* Verts, const int32_t* LoopSizes, int32_t NumLoops, const FVec3& Normal,
+		std::vector<int32_t>& OutIndices)
+	{
+		int32_t NumVerts = 0;
+		for (int32_t LoopIndex = 0; LoopIndex < NumLoops; ++LoopIndex)
+		{
+			NumVerts += LoopSizes[LoopIndex];
+		}
+
+		size_t NumStartingIndices = OutIndices.size();
+		OutIndices.resize(NumStartingIndices + GetMaxTriangleIndices(NumVerts, NumLoops));
+
+		int32_t NumIndices = TriangulatePolygonDelaunay(TVertexArrayAccessor<FVec3>(Verts), LoopSizes, NumLoops, Normal, GetThreadTriangulationScratch(),
+			OutIndices.data() + NumStartingIndices);
+		OutIndices.resize(NumStartingIndices + std::max(NumIndices, 0));
+		return NumIndices >= 0;
+	}
+}
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateFloorPlans.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		// Small xorshift generator, so that plans are identical on every platform and standard library
+		class FPlanRandom
+		{
+		public:
+			FPlanRandom(uint32_t Seed) : State((Seed != 0) ? Seed : 0x9E3779B9u) { }
+
+			uint32_t Next()
+			{
+				State ^= State << 13;
+				State ^= State >> 17;
+				State ^= State << 5;
+				return State;
+			}
+
+			// Uniform in [Min, Max], inclusive
+			int32_t RandRange(int32_t Min, int32_t Max)
+			{
+				return Min + static_cast<int32_t>(Next() % static_cast<uint32_t>(Max - Min + 1));
+			}
+
+		private:
+			uint32_t State;
+		};
+
+		struct FRect
+		{
+			int32_t MinX, MinY, MaxX, MaxY;
+
+			int32_t Width() const { return MaxX - MinX; }
+			int32_t Height() const { return MaxY - MinY; }
+		};
+
+		FWallSegment MakeWall(int32_t StartX, int32_t StartY, int32_t EndX, int32_t EndY, float CellSize)
+		{
+			return { { StartX * CellSize, StartY * CellSize, 0.0f }, { EndX * CellSize, EndY * CellSize, 0.0f } };
+		}
+	}
+
+	void GenerateGridPlan(int32_t NumRoomsX, int32_t NumRoomsY, float RoomSize, std::vector<FWallSegment>& OutWalls)
+	{
+		OutWalls.reserve(OutWalls.size() + NumRoomsX + NumRoomsY + 2 * NumRoomsX * NumRoomsY);
+
+		// In raster order, each room is closed by its right and top walls
+		for (int32_t Y = 0; Y < NumRoomsY; ++Y)
+		{
+			for (int32_t X = 0; X < NumRoomsX; ++X)
+			{
+				if (Y == 0)
+				{
+					OutWalls.push_back(MakeWall(X, Y, X + 1, Y, RoomSize));
+				}
+				if (X == 0)
+				{
+					OutWalls.push_back(MakeWall(X, Y, X, Y + 1, RoomSize));
+				}
+
+				OutWalls.push_back(MakeWall(X + 1, Y, X + 1, Y + 1, RoomSize));
+				OutWalls.push_back(MakeWall(X, Y + 1, X + 1, Y + 1, RoomSize));
+			}
+		}
+	}
+
+	void GenerateRectilinearPlan(int32_t NumRooms, float CellSize, uint32_t Seed, std::vector<FWallSegment>& OutWalls)
+	{
+		FPlanRandom Random(Seed);
+
+		// Leave enough cells that the largest room can always be split again
+		int32_t Side = 2 * static_cast<int32_t>(std::ceil(std::sqrt(static_cast<float>(std::max(NumRooms, 1)))));
+		std::vector<FRect> Rooms = { { 0, 0, Side, Side } };
+
+		while (static_cast<int32_t>(Rooms.size()) < NumRooms)
+		{
+			size_t LargestIndex = 0;
+			for (size_t RoomIndex = 1; RoomIndex < Rooms.size(); ++RoomIndex)
+			{
+				const FRect& Room = Rooms[RoomIndex];
+				const FRect& Largest = Rooms[LargestIndex];
+				if (Room.Width() * Room.Height() > Largest.Width() * Largest.Height())
+				{
+					LargestIndex = RoomIndex;
+				}
+			}
+
+			// Split across the longer side, at a random cell
+			FRect Room = Rooms[LargestIndex];
+			FRect NewRoom = Room;
+			if (Room.Width() >= Room.Height())
+			{
+				int32_t SplitX = Random.RandRange(Room.MinX + 1, Room.MaxX - 1);
+				Rooms[LargestIndex].MaxX = SplitX;
+				NewRoom.MinX = SplitX;
+			}
+			else
+			{
+				int32_t SplitY = Random.RandRange(Room.MinY + 1, Room.MaxY - 1);
+				Rooms[LargestIndex].MaxY = SplitY;
+				NewRoom.MinY = SplitY;
+			}
+			Rooms.push_back(NewRoom);
+		}
+
+		// Mark the unit-length edges of every room side; HorizontalEdges[Y][X] is (X, Y) to (X + 1, Y), and VerticalEdges[X][Y] is (X, Y) to (X, Y + 1)
+		std::vector<std::vector<bool>> HorizontalEdges(Side + 1, std::vector<bool>(Side, false));
+		std::vector<std::vector<bool>> VerticalEdges(Side + 1, std::vector<bool>(Side, false));
+		for (const FRect& Room : Rooms)
+		{
+			for (int32_t X = Room.MinX; X < Room.MaxX; ++X)
+			{
+				HorizontalEdges[Room.MinY][X] = true;
+				HorizontalEdges[Room.MaxY][X] = true;
+			}
+			for (int32_t Y = Room.MinY; Y < Room.MaxY; ++Y)
+			{
+				VerticalEdges[Room.MinX][Y] = true;
+				VerticalEdges[Room.MaxX][Y] = true;
+			}
+		}
+
+		auto HasVerticalEdge = [&VerticalEdges, Side](int32_t X, int32_t Y) {
+			return ((Y < Side) && VerticalEdges[X][Y]) || ((Y > 0) && VerticalEdges[X][Y - 1]);
+		};
+		auto HasHorizontalEdge = [&HorizontalEdges, Side](int32_t X, int32_t Y) {
+			return ((X < Side) && HorizontalEdges[Y][X]) || ((X > 0) && HorizontalEdges[Y][X - 1]);
+		};
+
+		// Merge runs of unit edges into walls, ending them wherever another wall meets the line
+		std::vector<FWallSegment> PlanWalls;
+		for (int32_t Line = 0; Line <= Side; ++Line)
+		{
+			int32_t HorizontalStart = -1;
+			int32_t VerticalStart = -1;
+			for (int32_t Cell = 0; Cell < Side; ++Cell)
+			{
+				if (HorizontalEdges[Line][Cell])
+				{
+					HorizontalStart = (HorizontalStart < 0) ? Cell : HorizontalStart;
+					if ((Cell + 1 == Side) || !HorizontalEdges[Line][Cell + 1] || HasVerticalEdge(Cell + 1, Line))
+					{
+						PlanWalls.push_back(MakeWall(HorizontalStart, Line, Cell + 1, Line, CellSize));
+						HorizontalStart = -1;
+					}
+				}
+
+				if (VerticalEdges[Line][Cell])
+				{
+					VerticalStart = (VerticalStart < 0) ? Cell : VerticalStart;
+					if ((Cell + 1 == Side) || !VerticalEdges[Line][Cell + 1] || HasHorizontalEdge(Line, Cell + 1))
+					{
+						PlanWalls.push_back(MakeWall(Line, VerticalStart, Line, Cell + 1, CellSize));
+						VerticalStart = -1;
+					}
+				}
+			}
+		}
+
+		// Place the walls in rows spreading out from the origin, so that rooms close steadily as walls are added
+		auto PlacementKey = [](const FWallSegment& Wall) {
+			return std::make_tuple(std::max(Wall.Start.Y, Wall.End.Y), std::max(Wall.Start.X, Wall.End.X), Wall.Start.Y, Wall.Start.X);
+		};
+		std::sort(PlanWalls.begin(), PlanWalls.end(), [&PlacementKey](const FWallSegment& A, const FWallSegment& B) {
+			return PlacementKey(A) < PlacementKey(B);
+		});
+
+		OutWalls.insert(OutWalls.end(), PlanWalls.begin(), PlanWalls.end());
+	}
+
+	void GenerateDiagonalPlan(int32_t NumRoomsX, int32_t NumRoomsY, float RoomSize, uint32_t Seed, std::vector<FWallSegment>& OutWalls)
+	{
+		FPlanRandom Random(Seed);
+
+		// Work in half-room cells, so that every room side has a node at its midpoint for the T-junctions to meet
+		float CellSize = 0.5f * RoomSize;
+		for (int32_t Y = 0; Y < NumRoomsY; ++Y)
+		{
+			for (int32_t X = 0; X < NumRoomsX; ++X)
+			{
+				int32_t MinX = 2 * X, MidX = MinX + 1, MaxX = MinX + 2;
+				int32_t MinY = 2 * Y, MidY = MinY + 1, MaxY = MinY + 2;
+
+				if (Y == 0)
+				{
+					OutWalls.push_back(MakeWall(MinX, MinY, MidX, MinY, CellSize));
+					OutWalls.push_back(MakeWall(MidX, MinY, MaxX, MinY, CellSize));
+				}
+				if (X == 0)
+				{
+					OutWalls.push_back(MakeWall(MinX, MinY, MinX, MidY, CellSize));
+					OutWalls.push_back(MakeWall(MinX, MidY, MinX, MaxY, CellSize));
+				}
+
+				OutWalls.push_back(MakeWall(MaxX, MinY, MaxX, MidY, CellSize));
+				OutWalls.push_back(MakeWall(MaxX, MidY, MaxX, MaxY, CellSize));
+				OutWalls.push_back(MakeWall(MinX, MaxY, MidX, MaxY, CellSize));
+				OutWalls.push_back(MakeWall(MidX, MaxY, MaxX, MaxY, CellSize));
+
+				// At most one interior wall per room, so that they never cross
+				switch (Random.RandRange(0, 5))
+				{
+				case 0:
+					OutWalls.push_back(MakeWall(MinX, MinY, MaxX, MaxY, CellSize));
+					break;
+				case 1:
+					OutWalls.push_back(MakeWall(MaxX, MinY, MinX, MaxY, CellSize));
+					break;
+				case 2:
+					OutWalls.push_back(MakeWall(MinX, MidY, MaxX, MidY, CellSize));
+					break;
+				case 3:
+					OutWalls.push_back(MakeWall(MidX, MinY, MidX, MaxY, CellSize));
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateGeometry.h"
+
+namespace ModumateCore
+{
+	namespace
+	{
+		// Same values as the engine's constants of the same names
+		const float Pi = 3.1415926535897932f;
+		const float Delta = 0.00001f;
+		const float ThreshPointsAreSame = 0.00002f;
+
+		float Sign(float Value)
+		{
+			return (Value > 0.0f) ? 1.0f : ((Value < 0.0f) ? -1.0f : 0.0f);
+		}
+
+		// 2x2 determinant, in the same order as FMatrix2x2::Determinant
+		float Determinant(float A, float B, float C, float D)
+		{
+			return A * D - B * C;
+		}
+
+		int32_t GreatestCommonDivisor(int32_t A, int32_t B)
+		{
+			while (B != 0)
+			{
+				int32_t T = B;
+				B = A % B;
+				A = T;
+			}
+
+			return A;
+		}
+	}
+
+	bool IntersectSegments2D(const FVec3& StartA, const FVec3& EndA, const FVec3& StartB, const FVec3& EndB,
+		FSegmentIntersection& OutIntersection, float Epsilon)
+	{
+		FVec3 DeltaA = EndA - StartA;
+		DeltaA.Z = 0.0f;
+
+		FVec3 DeltaB = EndB - StartB;
+		DeltaB.Z = 0.0f;
+
+		float LengthA = DeltaA.Size();
+		float LengthB = DeltaB.Size();
+		if ((std::fabs(LengthA) <= Epsilon) || (std::fabs(LengthB) <= Epsilon))
+		{
+			return false;
+		}
+
+		FVec3 DirA = DeltaA / LengthA;
+		FVec3 DirB = DeltaB / LengthB;
+		if (std::fabs(DirA | DirB) >= (1.0f - Epsilon))
+		{
+			return false;
+		}
+
+		float Denominator = Determinant(-DeltaA.X, -DeltaA.Y, -DeltaB.X, -DeltaB.Y);
+		if (std::fabs(Denominator) <= Epsilon)
+		{
+			return false;
+		}
+
+		float InnerNumeratorA = Determinant(StartA.X, StartA.Y, EndA.X, EndA.Y);
+		float InnerNumeratorB = Determinant(StartB.X, StartB.Y, EndB.X, EndB.Y);
+		float XNumerator = Determinant(InnerNumeratorA, -DeltaA.X, InnerNumeratorB, -DeltaB.X);
+		float YNumerator = Determinant(InnerNumeratorA, -DeltaA.Y, InnerNumeratorB, -DeltaB.Y);
+
+		FVec3 Location = { XNumerator / Denominator, YNumerator / Denominator, 0.0f };
+
+		FVec3 AToIntersection = Location - StartA;
+		AToIntersection.Z = 0.0f;
+		float DistAlongA = AToIntersection | DirA;
+		FVec3 IntersectionOnA = StartA + DistAlongA * DirA;
+
+		FVec3 BToIntersection = Location - StartB;
+		BToIntersection.Z = 0.0f;
+		float DistAlongB = BToIntersection | DirB;
+		FVec3 IntersectionOnB = StartB + DistAlongB * DirB;
+
+		Location.Z = 0.5f * (IntersectionOnA.Z + IntersectionOnB.Z);
+
+		float DistPctAlongA = DistAlongA / LengthA;
+		float DistPctAlongB = DistAlongB / LengthB;
+
+		OutIntersection.Location = Location;
+		OutIntersection.DistAlongA = DistAlongA;
+		OutIntersection.DistAlongB = DistAlongB;
+
+		return (DistPctAlongA >= Epsilon && DistPctAlongA <= (1.0f - Epsilon) &&
+			DistPctAlongB >= Epsilon && DistPctAlongB <= (1.0f - Epsilon));
+	}
+
+	bool AreEdgesMergeable(const FVec3& V0, const FVec3& V1, const FVec3& V2)
+	{
+		const FVec3 MergedEdgeVector = V2 - V0;
+		const float MergedEdgeLengthSquared = MergedEdgeVector.SizeSquared();
+		if (MergedEdgeLengthSquared > Delta)
+		{
+			// Find the vertex closest to A1/B0 that is on the hypothetical merged edge formed by A0-B1.
+			const float IntermediateVertexEdgeFraction = ((V2 - V0) | (V1 - V0)) / MergedEdgeLengthSquared;
+			const FVec3 InterpolatedVertex = V0 + IntermediateVertexEdgeFraction * (V2 - V0);
+
+			// The edges are merge-able if the interpolated vertex is close enough to the intermediate vertex.
+			return InterpolatedVertex.Equals(V1, ThreshPointsAreSame);
+		}
+		else
+		{
+			return true;
+		}
+	}
+
+	bool VectorsOnSameSide(const FVec3& Vec, const FVec3& A, const FVec3& B)
+	{
+		const FVec3 CrossA = Vec ^ A;
+		const FVec3 CrossB = Vec ^ B;
+		return !std::signbit(CrossA | CrossB);
+	}
+
+	bool PointInTriangle(const FVec3& A, const FVec3& B, const FVec3& C, const FVec3& P)
+	{
+		// Cross product indicates which 'side' of the vector the point is on
+		// If its on the same side as the remaining vert for all edges, then its inside.
+		return VectorsOnSameSide(B - A, P - A, C - A) &&
+			VectorsOnSameSide(C - B, P - B, A - B) &&
+			VectorsOnSameSide(A - C, P - C, B - C);
+	}
+
+	bool PointInPolygon2D(const FVec3* Verts, int32_t NumVerts, const FVec3& P)
+	{
+		// Count the edges that cross a ray from the point towards +X
+		bool bInside = false;
+		for (int32_t VertIndex = 0, PrevIndex = NumVerts - 1; VertIndex < NumVerts; PrevIndex = VertIndex++)
+		{
+			const FVec3& A = Verts[VertIndex];
+			const FVec3& B = Verts[PrevIndex];
+			if (((A.Y > P.Y) != (B.Y > P.Y)) && (P.X < A.X + (P.Y - A.Y) * (B.X - A.X) / (B.Y - A.Y)))
+			{
+				bInside = !bInside;
+			}
+		}
+
+		return bInside;
+	}
+
+	float GetWinding(const FVec3& FromDir, const FVec3& ToDir, const FVec3& Normal)
+	{
+		FVec3 Cross = FromDir ^ ToDir;
+		float AbsAngle = std::acos(FromDir | ToDir) * (180.0f / Pi);
+		return AbsAngle * Sign(Cross | Normal);
+	}
+
+	float GetLoopWinding(const FVec3* LoopDirs, int32_t NumDirs, const FVec3& Normal)
+	{
+		float Winding = 0.0f;
+		for (int32_t DirIndex = 0; DirIndex < NumDirs; ++DirIndex)
+		{
+			int32_t PrevDirIndex = (DirIndex == 0) ? (NumDirs - 1) : (DirIndex - 1);
+			Winding += GetWinding(LoopDirs[PrevDirIndex], LoopDirs[DirIndex], Normal);
+		}
+
+		return Winding;
+	}
+
+	void GetPlaneBasis(const FVec3& Normal, FVec3& OutU, FVec3& OutV)
+	{
+		FVec3 UnitNormal = Normal / Normal.Size();
+		FVec3 Axis = (std::fabs(UnitNormal.Z) < 0.9f) ? FVec3{ 0.0f, 0.0f, 1.0f } : FVec3{ 1.0f, 0.0f, 0.0f };
+		OutU = Axis - (Axis | UnitNormal) * UnitNormal;
+		OutU = OutU / OutU.Size();
+		OutV = UnitNormal ^ OutU;
+	}
+
+	void ProjectToPlane(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, FVec2* OutVerts)
+	{
+		FVec3 U, V;
+		GetPlaneBasis(Normal, U, V);
+		for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+		{
+			OutVerts[VertIndex] = { Verts[VertIndex] | U, Verts[VertIndex] | V };
+		}
+	}
+
+	bool TriangulatePolygonNaive(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		// Based on the implementation in Engine/Source/Runtime/Engine/Private/GeomTools.cpp, Copyright 1998-2017 Epic Games, Inc.
+		if (NumVerts < 3)
+		{
+			return true;
+		}
+
+		// Vertices of polygon in order - make a copy we are going to modify.
+		std::vector<FVec3> PolyVerts(Verts, Verts + NumVerts);
+		std::vector<int32_t> OriginalVertIndices(NumVerts);
+		for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+		{
+			OriginalVertIndices[VertIndex] = VertIndex;
+		}
+
+		size_t NumStartingIndices = OutIndices.size();
+		OutIndices.reserve(NumStartingIndices + 3 * (NumVerts - 2));
+
+		// Keep iterating while there are still vertices
+		while (PolyVerts.size() >= 3)
+		{
+			const int32_t NumPolyVerts = static_cast<int32_t>(PolyVerts.size());
+
+			// Look for an 'ear' triangle
+			bool bFoundEar = false;
+			for (int32_t EarVertexIndex = 0; EarVertexIndex < NumPolyVerts; EarVertexIndex++)
+			{
+				// Triangle is 'this' vert plus the one before and after it
+				const int32_t AIndex = (EarVertexIndex == 0) ? NumPolyVerts - 1 : EarVertexIndex - 1;
+				const int32_t BIndex = EarVertexIndex;
+				const int32_t CIndex = (EarVertexIndex + 1) % NumPolyVerts;
+
+				// Check that this vertex is convex (cross product must be positive)
+				const FVec3 ABEdge = PolyVerts[BIndex] - PolyVerts[AIndex];
+				const FVec3 ACEdge = PolyVerts[CIndex] - PolyVerts[AIndex];
+				const float TriangleDeterminant = (ABEdge ^ ACEdge) | Normal;
+				if (!std::signbit(TriangleDeterminant))
+				{
+					continue;
+				}
+
+				bool bFoundVertInside = false;
+				// Look through all verts before this in array to see if any are inside triangle
+				for (int32_t VertexIndex = 0; VertexIndex < NumPolyVerts; VertexIndex++)
+				{
+					if (VertexIndex != AIndex && VertexIndex != BIndex && VertexIndex != CIndex &&
+						PointInTriangle(PolyVerts[AIndex], PolyVerts[BIndex], PolyVerts[CIndex], PolyVerts[VertexIndex]))
+					{
+						bFoundVertInside = true;
+						break;
+					}
+				}
+
+				// Triangle with no verts inside - its an 'ear'!
+				if (!bFoundVertInside)
+				{
+					// Add to output list..
+					OutIndices.push_back(OriginalVertIndices[AIndex]);
+					OutIndices.push_back(OriginalVertIndices[BIndex]);
+					OutIndices.push_back(OriginalVertIndices[CIndex]);
+
+					// And remove vertex from polygon
+					PolyVerts.erase(PolyVerts.begin() + EarVertexIndex);
+					OriginalVertIndices.erase(OriginalVertIndices.begin() + EarVertexIndex);
+
+					bFoundEar = true;
+					break;
+				}
+			}
+
+			// If we couldn't find an 'ear' it indicates something is bad with this polygon - discard triangles and return.
+			if (!bFoundEar)
+			{
+				OutIndices.resize(NumStartingIndices);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	int32_t CentimetersToImperialInches(float Centimeters, int32_t OutImperial[4])
+	{
+		float Inches = Centimeters / 2.54f;
+		int32_t NonDecimal = static_cast<int32_t>(Inches);
+		float Decimal = std::fabs(Inches - NonDecimal);
+		OutImperial[0] = NonDecimal / 12;
+		OutImperial[1] = NonDecimal % 12;
+
+		if (Decimal >= 0.875)
+		{
+			OutImperial[0] = OutImperial[0] + (OutImperial[1] + 1) / 12;
+			OutImperial[1] = (OutImperial[1] + 1) % 12;
+			return 2;
+		}
+		else if (Decimal <= 0.125)
+		{
+			return 2;
+		}
+
+		// Round to the nearest eighth, and reduce the fraction
+		for (int32_t Num = 1; Num < 8; Num++)
+		{
+			if ((float)Num / 8 <= Decimal && Decimal <= (float)(Num + 1) / 8)
+			{
+				float DistFromLowToDec = std::fabs((float)Num / 8 - Decimal);
+				float DistFromDecToHigh = std::fabs((float)(Num + 1) / 8 - Decimal);
+				int32_t Numerator = (DistFromLowToDec < DistFromDecToHigh) ? Num : (Num + 1);
+
+				int32_t Gcd = GreatestCommonDivisor(Numerator, 8);
+				OutImperial[2] = Numerator / Gcd;
+				OutImperial[3] = 8 / Gcd;
+				return 4;
+			}
+		}
+
+		return 2;
+	}
+}
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateMeshBuilder.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		struct FVertexKey
+		{
+			int32_t Values[6];
+		};
+
+		// Open addressing table from quantized vertices to their indices, which only grows, so that welding rarely allocates
+		struct FWeldTable
+		{
+			struct FSlot
+			{
+				int32_t Index;
+				FVertexKey Key;
+			};
+
+			std::vector<FSlot> Slots;
+			int32_t NumKeys = 0;
+			uint32_t Mask = 0;
+
+			void Reset()
+			{
+				for (FSlot& Slot : Slots)
+				{
+					Slot.Index = -1;
+				}
+				NumKeys = 0;
+			}
+
+			static uint32_t Hash(const FVertexKey& Key)
+			{
+				// FNV-1a over the quantized values, then mixed down, since only the low bits pick the slot
+				uint32_t Hash = 2166136261u;
+				for (int32_t Value : Key.Values)
+				{
+					Hash ^= static_cast<uint32_t>(Value);
+					Hash *= 16777619u;
+				}
+
+				Hash ^= Hash >> 16;
+				Hash *= 0x85ebca6bu;
+				Hash ^= Hash >> 13;
+				return Hash;
+			}
+
+			void Grow()
+			{
+				std::vector<FSlot> OldSlots(Slots.empty() ? 1024 : 2 * Slots.size());
+				OldSlots.swap(Slots);
+				Mask = static_cast<uint32_t>(Slots.size() - 1);
+				Reset();
+
+				for (const FSlot& OldSlot : OldSlots)
+				{
+					if (OldSlot.Index != -1)
+					{
+						Insert(OldSlot.Key, OldSlot.Index);
+					}
+				}
+			}
+
+			// Returns the index of the matching key, or adds it with NewIndex
+			int32_t Insert(const FVertexKey& Key, int32_t NewIndex)
+			{
+				uint32_t SlotIndex = Hash(Key) & Mask;
+				while (Slots[SlotIndex].Index != -1)
+				{
+					if (std::memcmp(&Slots[SlotIndex].Key, &Key, sizeof(FVertexKey)) == 0)
+					{
+						return Slots[SlotIndex].Index;
+					}
+					SlotIndex = (SlotIndex + 1) & Mask;
+				}
+
+				Slots[SlotIndex].Index = NewIndex;
+				Slots[SlotIndex].Key = Key;
+				++NumKeys;
+				return NewIndex;
+			}
+
+			int32_t FindOrAdd(const FVertexKey& Key, int32_t NewIndex)
+			{
+				if (2 * static_cast<size_t>(NumKeys + 1) > Slots.size())
+				{
+					Grow();
+				}
+
+				return Insert(Key, NewIndex);
+			}
+		};
+
+		thread_local FWeldTable WeldTable;
+
+		int32_t Quantize(float Value, float Scale)
+		{
+			return static_cast<int32_t>(std::floor(Value * Scale + 0.5f));
+		}
+	}
+
+	const float FMeshBuilder::WeldSize = 0.01f;
+
+	FMeshBuilder::FMeshBuilder(std::vector<FVec3>& InVertices, std::vector<FVec3>& InNormals, std::vector<int32_t>& InIndices, bool bInWeldVertices)
+		: Vertices(InVertices)
+		, Normals(InNormals)
+		, Indices(InIndices)
+		, bWeldVertices(bInWeldVertices)
+	{
+		Vertices.clear();
+		Normals.clear();
+		Indices.clear();
+
+		if (bWeldVertices)
+		{
+			WeldTable.Reset();
+		}
+	}
+
+	int32_t FMeshBuilder::AddVertex(const FVec3& Position, const FVec3& Normal)
+	{
+		int32_t NewIndex = NumVertices();
+		if (bWeldVertices)
+		{
+			const float Scale = 1.0f / WeldSize;
+			FVertexKey Key = { {
+				Quantize(Position.X, Scale), Quantize(Position.Y, Scale), Quantize(Position.Z, Scale),
+				Quantize(Normal.X, Scale), Quantize(Normal.Y, Scale), Quantize(Normal.Z, Scale) } };
+
+			int32_t WeldedIndex = WeldTable.FindOrAdd(Key, NewIndex);
+			if (WeldedIndex != NewIndex)
+			{
+				return WeldedIndex;
+			}
+		}
+
+		Vertices.push_back(Position);
+		Normals.push_back(Normal);
+		return NewIndex;
+	}
+
+	void FMeshBuilder::AddTriangle(int32_t A, int32_t B, int32_t C)
+	{
+		if (A == B || B == C || C == A)
+		{
+			return;
+		}
+
+		Indices.push_back(A);
+		Indices.push_back(B);
+		Indices.push_back(C);
+	}
+
+	void FMeshBuilder::AddQuad(const FVec3& A, const FVec3& B, const FVec3& C, const FVec3& D, const FVec3& Normal)
+	{
+		int32_t Corners[4] = { AddVertex(A, Normal), AddVertex(B, Normal), AddVertex(C, Normal), AddVertex(D, Normal) };
+
+		if ((((B - A) ^ (C - A)) | Normal) < 0.0f)
+		{
+			AddTriangle(Corners[0], Corners[1], Corners[2]);
+			AddTriangle(Corners[0], Corners[2], Corners[3]);
+		}
+		else
+		{
+			AddTriangle(Corners[0], Corners[2], Corners[1]);
+			AddTriangle(Corners[0], Corners[3], Corners[2]);
+		}
+	}
+}
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateSurfaceKernel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MODUMATE_SURFACE_SSE 1
+#include <emmintrin.h>
+#else
+#define MODUMATE_SURFACE_SSE 0
+#endif
+
+static_assert(sizeof(ModumateCore::FVec3) == 3 * sizeof(float), "The kernel reads and writes FVec3 buffers as packed floats");
+static_assert(sizeof(ModumateCore::FVec2) == 2 * sizeof(float), "The kernel writes FVec2 buffers as packed floats");
+
+namespace ModumateCore
+{
+	namespace
+	{
+		// Faces closer to horizontal than this (as the squared length of their normal's XY) get tangents along +X
+		const float HorizontalNormalSizeSquared = 1.0e-6f;
+
+		void ComputeVertexSurface(const FVec3& Position, const FVec3& NormalSum, float UVScale, FVec3& OutNormal, FVec3& OutTangent, FVec2& OutUV)
+		{
+			float NormalSizeSquared = NormalSum.SizeSquared();
+			FVec3 Normal = (NormalSizeSquared > 0.0f) ? NormalSum * (1.0f / std::sqrt(NormalSizeSquared)) : FVec3{ 0.0f, 0.0f, 1.0f };
+
+			float TangentSizeSquared = Normal.X * Normal.X + Normal.Y * Normal.Y;
+			FVec3 Tangent = (TangentSizeSquared >= HorizontalNormalSizeSquared) ?
+				FVec3{ -Normal.Y, Normal.X, 0.0f } * (1.0f / std::sqrt(TangentSizeSquared)) : FVec3{ 1.0f, 0.0f, 0.0f };
+			FVec3 Bitangent = Normal ^ Tangent;
+
+			OutNormal = Normal;
+			OutTangent = Tangent;
+			OutUV = { (Position | Tangent) * UVScale, (Position | Bitangent) * UVScale };
+		}
+
+#if MODUMATE_SURFACE_SSE
+		// Splits four packed FVec3s into a register per component
+		inline void LoadVec3x4(const float* Src, __m128& OutX, __m128& OutY, __m128& OutZ)
+		{
+			__m128 A0 = _mm_loadu_ps(Src);     // X0 Y0 Z0 X1
+			__m128 A1 = _mm_loadu_ps(Src + 4); // Y1 Z1 X2 Y2
+			__m128 A2 = _mm_loadu_ps(Src + 8); // Z2 X3 Y3 Z3
+
+			__m128 XHigh = _mm_shuffle_ps(A1, A2, _MM_SHUFFLE(1, 1, 2, 2));
+			OutX = _mm_shuffle_ps(A0, XHigh, _MM_SHUFFLE(2, 0, 3, 0));
+
+			__m128 YLow = _mm_shuffle_ps(A0, A1, _MM_SHUFFLE(0, 0, 1, 1));
+			__m128 YHigh = _mm_shuffle_ps(A1, A2, _MM_SHUFFLE(2, 2, 3, 3));
+			OutY = _mm_shuffle_ps(YLow, YHigh, _MM_SHUFFLE(2, 0, 2, 0));
+
+			__m128 ZLow = _mm_shuffle_ps(A0, A1, _MM_SHUFFLE(1, 1, 2, 2));
+			OutZ = _mm_shuffle_ps(ZLow, A2, _MM_SHUFFLE(3, 0, 2, 0));
+		}
+
+		// Packs a register per component back into four FVec3s
+		inline void StoreVec3x4(float* Dest, __m128 X, __m128 Y, __m128 Z)
+		{
+			__m128 XYLow = _mm_unpacklo_ps(X, Y);  // X0 Y0 X1 Y1
+			__m128 XYHigh = _mm_unpackhi_ps(X, Y); // X2 Y2 X3 Y3
+
+			__m128 ZX = _mm_shuffle_ps(Z, X, _MM_SHUFFLE(1, 1, 0, 0));
+			_mm_storeu_ps(Dest, _mm_shuffle_ps(XYLow, ZX, _MM_SHUFFLE(2, 0, 1, 0)));
+
+			__m128 YZ = _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(1, 1, 1, 1));
+			_mm_storeu_ps(Dest + 4, _mm_shuffle_ps(YZ, XYHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+
+			__m128 ZXHigh = _mm_shuffle_ps(Z, XYHigh, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 YZHigh = _mm_shuffle_ps(XYHigh, Z, _MM_SHUFFLE(3, 3, 3, 3));
+			_mm_storeu_ps(Dest + 8, _mm_shuffle_ps(ZXHigh, YZHigh, _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+
+		inline __m128 Select(__m128 Mask, __m128 IfTrue, __m128 IfFalse)
+		{
+			return _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+		}
+
+		// The same as ComputeVertexSurface, for four vertices at once, with the normal sums already in OutNormals
+		void ComputeVertexSurfacex4(const FVec3* Positions, float UVScale, FVec3* InOutNormals, FVec3* OutTangents, FVec2* OutUVs)
+		{
+			const __m128 Zero = _mm_setzero_ps();
+			const __m128 One = _mm_set1_ps(1.0f);
+
+			__m128 NX, NY, NZ;
+			LoadVec3x4(&InOutNormals->X, NX, NY, NZ);
+			__m128 NormalSizeSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(NX, NX), _mm_mul_ps(NY, NY)), _mm_mul_ps(NZ, NZ));
+			__m128 HasNormal = _mm_cmpgt_ps(NormalSizeSquared, Zero);
+			__m128 InvNormalSize = _mm_div_ps(One, _mm_sqrt_ps(Select(HasNormal, NormalSizeSquared, One)));
+			NX = Select(HasNormal, _mm_mul_ps(NX, InvNormalSize), Zero);
+			NY = Select(HasNormal, _mm_mul_ps(NY, InvNormalSize), Zero);
+			NZ = Select(HasNormal, _mm_mul_ps(NZ, InvNormalSize), One);
+
+			__m128 TangentSizeSquared = _mm_add_ps(_mm_mul_ps(NX, NX), _mm_mul_ps(NY, NY));
+			__m128 IsVertical = _mm_cmpge_ps(TangentSizeSquared, _mm_set1_ps(HorizontalNormalSizeSquared));
+			__m128 InvTangentSize = _mm_div_ps(One, _mm_sqrt_ps(Select(IsVertical, TangentSizeSquared, One)));
+			__m128 TX = Select(IsVertical, _mm_mul_ps(_mm_sub_ps(Zero, NY), InvTangentSize), One);
+			__m128 TY = Select(IsVertical, _mm_mul_ps(NX, InvTangentSize), Zero);
+
+			// Normal ^ Tangent, where the tangent has no Z
+			__m128 BX = _mm_sub_ps(Zero, _mm_mul_ps(NZ, TY));
+			__m128 BY = _mm_mul_ps(NZ, TX);
+			__m128 BZ = _mm_sub_ps(_mm_mul_ps(NX, TY), _mm_mul_ps(NY, TX));
+
+			__m128 PX, PY, PZ;
+			LoadVec3x4(&Positions->X, PX, PY, PZ);
+			__m128 Scale = _mm_set1_ps(UVScale);
+			__m128 U = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(PX, TX), _mm_mul_ps(PY, TY)), Scale);
+			__m128 V = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(PX, BX), _mm_mul_ps(PY, BY)), _mm_mul_ps(PZ, BZ)), Scale);
+
+			StoreVec3x4(&InOutNormals->X, NX, NY, NZ);
+			StoreVec3x4(&OutTangents->X, TX, TY, Zero);
+			_mm_storeu_ps(&OutUVs->X, _mm_unpacklo_ps(U, V));
+			_mm_storeu_ps(&OutUVs->X + 4, _mm_unpackhi_ps(U, V));
+		}
+#endif
+	}
+
+	void ComputeFlatSurface(const FVec3* Positions, int32_t NumVertices, const int32_t* Indices, int32_t NumIndices, float UVScale,
+		FVec3* OutNormals, FVec3* OutTangents, FVec2* OutUVs)
+	{
+		for (int32_t VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex)
+		{
+			OutNormals[VertexIndex] = { 0.0f, 0.0f, 0.0f };
+		}
+
+		// Each triangle adds its area weighted normal to its vertices, which only ever sum the normals of one flat face
+		for (int32_t Index = 0; Index + 2 < NumIndices; Index += 3)
+		{
+			int32_t A = Indices[Index], B = Indices[Index + 1], C = Indices[Index + 2];
+			FVec3 FaceNormal = (Positions[C] - Positions[A]) ^ (Positions[B] - Positions[A]);
+			OutNormals[A] = OutNormals[A] + FaceNormal;
+			OutNormals[B] = OutNormals[B] + FaceNormal;
+			OutNormals[C] = OutNormals[C] + FaceNormal;
+		}
+
+		int32_t VertexIndex = 0;
+#if MODUMATE_SURFACE_SSE
+		for (; VertexIndex + 4 <= NumVertices; VertexIndex += 4)
+		{
+			ComputeVertexSurfacex4(Positions + VertexIndex, UVScale, OutNormals + VertexIndex, OutTangents + VertexIndex, OutUVs + VertexIndex);
+		}
+#endif
+		for (; VertexIndex < NumVertices; ++VertexIndex)
+		{
+			ComputeVertexSurface(Positions[VertexIndex], OutNormals[VertexIndex], UVScale,
+				OutNormals[VertexIndex], OutTangents[VertexIndex], OutUVs[VertexIndex]);
+		}
+	}
+}
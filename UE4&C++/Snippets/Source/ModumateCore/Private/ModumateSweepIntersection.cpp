@@ -0,0 +1,454 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateSweepIntersection.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#include <set>
+#include <unordered_set>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		// Segments are swept in a slightly rotated frame, so that axis-aligned walls (by far the most common) are never vertical.
+		const double SweepRotationSin = 0.00123456789;
+
+		// Parametric tolerance for treating a touch at a segment endpoint as a touch rather than a crossing.
+		const double SweepEndpointTolerance = 1e-7;
+
+		// Absolute tolerance (in cm) for treating two segments as passing through the same point on the sweep line.
+		const double SweepPointTolerance = 1e-6;
+
+		bool IsNearlyEqual(double A, double B)
+		{
+			return std::fabs(A - B) <= SweepPointTolerance;
+		}
+
+		uint64_t MakePairKey(int32_t IndexA, int32_t IndexB)
+		{
+			return (static_cast<uint64_t>(std::min(IndexA, IndexB)) << 32) | static_cast<uint32_t>(std::max(IndexA, IndexB));
+		}
+
+		enum class ESweepEventType : uint8_t
+		{
+			// Crossings are handled before segments end, and segments end before new ones start at the same point.
+			Crossing,
+			End,
+			Start
+		};
+
+		struct FSweepEvent
+		{
+			double X;
+			double Y;
+			ESweepEventType Type;
+			int32_t SegmentA;
+			int32_t SegmentB;
+
+			bool operator<(const FSweepEvent& Other) const
+			{
+				if (X != Other.X)
+				{
+					return X < Other.X;
+				}
+				if (Y != Other.Y)
+				{
+					return Y < Other.Y;
+				}
+				return Type < Other.Type;
+			}
+		};
+
+		// Turns the standard library's max-heap into a min-heap, so the next event along the sweep is at the front.
+		bool IsEventAfter(const FSweepEvent& A, const FSweepEvent& B)
+		{
+			return B < A;
+		}
+
+		struct FSweepSegment
+		{
+			int32_t InputIndex;
+			double X0, Y0, X1, Y1;
+			double Slope;
+			bool bVertical;
+		};
+
+		class FSweepState
+		{
+		public:
+			FSweepState(const FWallSegment* InSegments, int32_t NumSegments)
+				: Status(FStatusOrder{ this })
+			{
+				double SweepRotationCos = std::sqrt(1.0 - SweepRotationSin * SweepRotationSin);
+
+				Segments.reserve(NumSegments);
+				Events.reserve(2 * NumSegments);
+				for (int32_t InputIndex = 0; InputIndex < NumSegments; ++InputIndex)
+				{
+					const FWallSegment& Input = InSegments[InputIndex];
+					double StartX = SweepRotationCos * Input.Start.X - SweepRotationSin * Input.Start.Y;
+					double StartY = SweepRotationSin * Input.Start.X + SweepRotationCos * Input.Start.Y;
+					double EndX = SweepRotationCos * Input.End.X - SweepRotationSin * Input.End.Y;
+					double EndY = SweepRotationSin * Input.End.X + SweepRotationCos * Input.End.Y;
+
+					// Zero-length segments can't cross anything
+					if (IsNearlyEqual(StartX, EndX) && IsNearlyEqual(StartY, EndY))
+					{
+						continue;
+					}
+
+					// Orient every segment from left to right
+					bool bFlip = (EndX < StartX) || ((EndX == StartX) && (EndY < StartY));
+					FSweepSegment Segment;
+					Segment.InputIndex = InputIndex;
+					Segment.X0 = bFlip ? EndX : StartX;
+					Segment.Y0 = bFlip ? EndY : StartY;
+					Segment.X1 = bFlip ? StartX : EndX;
+					Segment.Y1 = bFlip ? StartY : EndY;
+					Segment.bVertical = IsNearlyEqual(Segment.X0, Segment.X1);
+					Segment.Slope = Segment.bVertical ? DBL_MAX : (Segment.Y1 - Segment.Y0) / (Segment.X1 - Segment.X0);
+
+					int32_t SegmentIndex = static_cast<int32_t>(Segments.size());
+					Segments.push_back(Segment);
+					PushEvent(FSweepEvent{ Segment.X0, Segment.Y0, ESweepEventType::Start, SegmentIndex, -1 });
+					PushEvent(FSweepEvent{ Segment.X1, Segment.Y1, ESweepEventType::End, SegmentIndex, -1 });
+				}
+
+				StatusHandles.assign(Segments.size(), Status.end());
+				bInCrossing.assign(Segments.size(), false);
+			}
+
+			void Run()
+			{
+				while (!Events.empty())
+				{
+					FSweepEvent Event = PopEvent();
+					SweepX = Event.X;
+					SweepY = Event.Y;
+
+					switch (Event.Type)
+					{
+					case ESweepEventType::Start:
+						HandleStart(Event.SegmentA);
+						break;
+					case ESweepEventType::End:
+						HandleEnd(Event.SegmentA);
+						break;
+					case ESweepEventType::Crossing:
+						HandleCrossing(Event);
+						break;
+					}
+				}
+			}
+
+			// Input index pairs whose segments properly cross, still to be confirmed with IntersectSegments2D
+			std::unordered_set<uint64_t> CandidatePairs;
+
+		protected:
+			// The segment is mutable so that crossings can reorder segments without rebalancing the tree
+			struct FStatusEntry
+			{
+				mutable int32_t SegmentIndex;
+			};
+
+			// Orders segments bottom to top along the current sweep line
+			struct FStatusOrder
+			{
+				const FSweepState* State;
+
+				bool operator()(const FStatusEntry& A, const FStatusEntry& B) const
+				{
+					return State->IsBelow(A.SegmentIndex, B.SegmentIndex);
+				}
+			};
+
+			typedef std::set<FStatusEntry, FStatusOrder> FStatus;
+
+			void PushEvent(const FSweepEvent& Event)
+			{
+				Events.push_back(Event);
+				std::push_heap(Events.begin(), Events.end(), IsEventAfter);
+			}
+
+			FSweepEvent PopEvent()
+			{
+				std::pop_heap(Events.begin(), Events.end(), IsEventAfter);
+				FSweepEvent Event = Events.back();
+				Events.pop_back();
+				return Event;
+			}
+
+			double GetYAtSweep(int32_t SegmentIndex) const
+			{
+				const FSweepSegment& Segment = Segments[SegmentIndex];
+				if (Segment.bVertical)
+				{
+					return std::min(std::max(SweepY, std::min(Segment.Y0, Segment.Y1)), std::max(Segment.Y0, Segment.Y1));
+				}
+
+				return Segment.Y0 + (SweepX - Segment.X0) * Segment.Slope;
+			}
+
+			// Orders segments bottom to top along the sweep line, using the order just to the right of it for ties.
+			bool IsBelow(int32_t SegmentIndexA, int32_t SegmentIndexB) const
+			{
+				double YA = GetYAtSweep(SegmentIndexA);
+				double YB = GetYAtSweep(SegmentIndexB);
+				if (!IsNearlyEqual(YA, YB))
+				{
+					return YA < YB;
+				}
+
+				double SlopeA = Segments[SegmentIndexA].Slope;
+				double SlopeB = Segments[SegmentIndexB].Slope;
+				if (SlopeA != SlopeB)
+				{
+					return SlopeA < SlopeB;
+				}
+				return SegmentIndexA < SegmentIndexB;
+			}
+
+			void HandleStart(int32_t SegmentIndex)
+			{
+				FStatus::iterator Handle = Status.insert(FStatusEntry{ SegmentIndex }).first;
+				StatusHandles[SegmentIndex] = Handle;
+
+				if (Handle != Status.begin())
+				{
+					CheckNeighbors(std::prev(Handle)->SegmentIndex, SegmentIndex);
+				}
+				FStatus::iterator Above = std::next(Handle);
+				if (Above != Status.end())
+				{
+					CheckNeighbors(SegmentIndex, Above->SegmentIndex);
+				}
+			}
+
+			void HandleEnd(int32_t SegmentIndex)
+			{
+				FStatus::iterator Handle = StatusHandles[SegmentIndex];
+				if (Handle == Status.end())
+				{
+					return;
+				}
+
+				FStatus::iterator Above = std::next(Handle);
+				bool bHasBelow = (Handle != Status.begin());
+				int32_t Below = bHasBelow ? std::prev(Handle)->SegmentIndex : -1;
+
+				Status.erase(Handle);
+				StatusHandles[SegmentIndex] = Status.end();
+
+				if (bHasBelow && (Above != Status.end()))
+				{
+					CheckNeighbors(Below, Above->SegmentIndex);
+				}
+			}
+
+			bool IsCrossingAtEvent(FStatus::iterator Handle, const FSweepEvent& Event) const
+			{
+				return bInCrossing[Handle->SegmentIndex] || IsNearlyEqual(GetYAtSweep(Handle->SegmentIndex), Event.Y);
+			}
+
+			void HandleCrossing(const FSweepEvent& Event)
+			{
+				// Gather every crossing at this point, so that more than two segments meeting at once are reordered together.
+				CrossingSegments.clear();
+				CrossingSegments.push_back(Event.SegmentA);
+				CrossingSegments.push_back(Event.SegmentB);
+				while (!Events.empty() && (Events.front().Type == ESweepEventType::Crossing) &&
+					IsNearlyEqual(Events.front().X, Event.X) && IsNearlyEqual(Events.front().Y, Event.Y))
+				{
+					FSweepEvent SameEvent = PopEvent();
+					CrossingSegments.push_back(SameEvent.SegmentA);
+					CrossingSegments.push_back(SameEvent.SegmentB);
+				}
+
+				FStatus::iterator First = Status.end();
+				int32_t NumToFind = 0;
+				for (int32_t SegmentIndex : CrossingSegments)
+				{
+					if ((StatusHandles[SegmentIndex] != Status.end()) && !bInCrossing[SegmentIndex])
+					{
+						bInCrossing[SegmentIndex] = true;
+						First = StatusHandles[SegmentIndex];
+						++NumToFind;
+					}
+				}
+
+				if (NumToFind < 2)
+				{
+					for (int32_t SegmentIndex : CrossingSegments)
+					{
+						bInCrossing[SegmentIndex] = false;
+					}
+					return;
+				}
+
+				// Grow a run of the status out from one of the crossing segments, over any other segments through the same point,
+				// and over anything that rounding left between the crossing segments, until it holds all of them.
+				FStatus::iterator Last = First;
+				int32_t NumFound = 1;
+				while ((First != Status.begin()) && IsCrossingAtEvent(std::prev(First), Event))
+				{
+					--First;
+					NumFound += bInCrossing[First->SegmentIndex] ? 1 : 0;
+				}
+				while ((std::next(Last) != Status.end()) && IsCrossingAtEvent(std::next(Last), Event))
+				{
+					++Last;
+					NumFound += bInCrossing[Last->SegmentIndex] ? 1 : 0;
+				}
+				for (FStatus::iterator Above = std::next(Last); (NumFound < NumToFind) && (Above != Status.end()); ++Above)
+				{
+					if (bInCrossing[Above->SegmentIndex])
+					{
+						Last = Above;
+						++NumFound;
+					}
+				}
+				while ((NumFound < NumToFind) && (First != Status.begin()))
+				{
+					--First;
+					NumFound += bInCrossing[First->SegmentIndex] ? 1 : 0;
+				}
+
+				CrossingGroup.clear();
+				for (FStatus::iterator Handle = First; Handle != std::next(Last); ++Handle)
+				{
+					CrossingGroup.push_back(Handle->SegmentIndex);
+				}
+				for (int32_t SegmentIndex : CrossingSegments)
+				{
+					bInCrossing[SegmentIndex] = false;
+				}
+
+				// Every pair of segments through this point is a candidate, even if they were never adjacent.
+				for (size_t GroupIndexA = 0; GroupIndexA < CrossingGroup.size(); ++GroupIndexA)
+				{
+					for (size_t GroupIndexB = GroupIndexA + 1; GroupIndexB < CrossingGroup.size(); ++GroupIndexB)
+					{
+						AddCandidate(CrossingGroup[GroupIndexA], CrossingGroup[GroupIndexB]);
+					}
+				}
+
+				// To the right of the crossing point, the segments are ordered by slope. They're rewritten in place,
+				// rather than reinserted, so that the tree never depends on comparing segments that are this close together.
+				std::sort(CrossingGroup.begin(), CrossingGroup.end(), [this](int32_t A, int32_t B) {
+					return (Segments[A].Slope != Segments[B].Slope) ? (Segments[A].Slope < Segments[B].Slope) : (A < B);
+				});
+
+				FStatus::iterator Handle = First;
+				for (int32_t SegmentIndex : CrossingGroup)
+				{
+					Handle->SegmentIndex = SegmentIndex;
+					StatusHandles[SegmentIndex] = Handle;
+					++Handle;
+				}
+
+				if (First != Status.begin())
+				{
+					CheckNeighbors(std::prev(First)->SegmentIndex, First->SegmentIndex);
+				}
+				if (std::next(Last) != Status.end())
+				{
+					CheckNeighbors(Last->SegmentIndex, std::next(Last)->SegmentIndex);
+				}
+			}
+
+			void CheckNeighbors(int32_t SegmentIndexA, int32_t SegmentIndexB)
+			{
+				uint64_t SegmentPair = MakePairKey(SegmentIndexA, SegmentIndexB);
+				if (ScheduledPairs.count(SegmentPair) > 0)
+				{
+					return;
+				}
+
+				const FSweepSegment& SegmentA = Segments[SegmentIndexA];
+				const FSweepSegment& SegmentB = Segments[SegmentIndexB];
+				double DeltaAX = SegmentA.X1 - SegmentA.X0, DeltaAY = SegmentA.Y1 - SegmentA.Y0;
+				double DeltaBX = SegmentB.X1 - SegmentB.X0, DeltaBY = SegmentB.Y1 - SegmentB.Y0;
+				double Denominator = DeltaAX * DeltaBY - DeltaAY * DeltaBX;
+				if (Denominator == 0.0)
+				{
+					return;
+				}
+
+				double StartDeltaX = SegmentB.X0 - SegmentA.X0, StartDeltaY = SegmentB.Y0 - SegmentA.Y0;
+				double AlongA = (StartDeltaX * DeltaBY - StartDeltaY * DeltaBX) / Denominator;
+				double AlongB = (StartDeltaX * DeltaAY - StartDeltaY * DeltaAX) / Denominator;
+
+				if ((AlongA < 0.0) || (AlongA > 1.0) || (AlongB < 0.0) || (AlongB > 1.0))
+				{
+					return;
+				}
+
+				double CrossingX = SegmentA.X0 + AlongA * DeltaAX;
+				double CrossingY = SegmentA.Y0 + AlongA * DeltaAY;
+				if ((CrossingX < SweepX) || ((CrossingX == SweepX) && (CrossingY < SweepY)))
+				{
+					// Already behind the sweep line, which can only come from rounding; don't go backwards.
+					CrossingX = SweepX;
+					CrossingY = SweepY;
+				}
+
+				// Segments that touch at an endpoint still need an event, since rounding can leave them out of order past it,
+				// but they're only candidates if they meet away from their endpoints.
+				ScheduledPairs.insert(SegmentPair);
+				if ((AlongA > SweepEndpointTolerance) && (AlongA < 1.0 - SweepEndpointTolerance) &&
+					(AlongB > SweepEndpointTolerance) && (AlongB < 1.0 - SweepEndpointTolerance))
+				{
+					AddCandidate(SegmentIndexA, SegmentIndexB);
+				}
+				PushEvent(FSweepEvent{ CrossingX, CrossingY, ESweepEventType::Crossing, SegmentIndexA, SegmentIndexB });
+			}
+
+			void AddCandidate(int32_t SegmentIndexA, int32_t SegmentIndexB)
+			{
+				CandidatePairs.insert(MakePairKey(Segments[SegmentIndexA].InputIndex, Segments[SegmentIndexB].InputIndex));
+			}
+
+			std::vector<FSweepSegment> Segments;
+			std::vector<FSweepEvent> Events;
+			FStatus Status;
+
+			// Where each segment is in Status, or Status.end() while it isn't on the sweep line
+			std::vector<FStatus::iterator> StatusHandles;
+
+			std::unordered_set<uint64_t> ScheduledPairs;
+			// Scratch for HandleCrossing
+			std::vector<int32_t> CrossingSegments;
+			std::vector<int32_t> CrossingGroup;
+			std::vector<bool> bInCrossing;
+			double SweepX = -DBL_MAX;
+			double SweepY = -DBL_MAX;
+		};
+	}
+
+	void FindSegmentCrossings(const FWallSegment* Segments, int32_t NumSegments, std::vector<FSegmentCrossing>& OutCrossings, float Epsilon)
+	{
+		OutCrossings.clear();
+
+		FSweepState SweepState(Segments, NumSegments);
+		SweepState.Run();
+
+		std::vector<uint64_t> CandidatePairs(SweepState.CandidatePairs.begin(), SweepState.CandidatePairs.end());
+		std::sort(CandidatePairs.begin(), CandidatePairs.end());
+
+		FSegmentIntersection Intersection;
+		for (uint64_t CandidatePair : CandidatePairs)
+		{
+			int32_t IndexA = static_cast<int32_t>(CandidatePair >> 32);
+			int32_t IndexB = static_cast<int32_t>(CandidatePair & 0xFFFFFFFFu);
+			const FWallSegment& SegmentA = Segments[IndexA];
+			const FWallSegment& SegmentB = Segments[IndexB];
+			if (IntersectSegments2D(SegmentA.Start, SegmentA.End, SegmentB.Start, SegmentB.End, Intersection, Epsilon))
+			{
+				OutCrossings.push_back(FSegmentCrossing{ IndexA, IndexB, Intersection });
+			}
+		}
+	}
+}
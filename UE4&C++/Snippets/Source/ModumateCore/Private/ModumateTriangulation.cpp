@@ -0,0 +1,309 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateTriangulation.h"
+
+#include "ModumateTriangulationBuffers.h"
+
+#include <algorithm>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		// Below this many vertices, scanning the whole ring for reflex vertices is cheaper than building the z-order list
+		const int32_t MinVertsForZOrder = 32;
+
+		// Twice the signed area of ABC, which is the same as ((B - A) ^ (C - A)) | Normal in the projected plane
+		float Area(const FEarNode& A, const FEarNode& B, const FEarNode& C)
+		{
+			return (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+		}
+
+		// Same as VectorsOnSameSide, where points on the line count as being on the same side
+		bool OnSameSide(float VecX, float VecY, float AX, float AY, float BX, float BY)
+		{
+			return !(((VecX * AY - VecY * AX) * (VecX * BY - VecY * BX)) < 0.0f);
+		}
+
+		// Same as PointInTriangle, where points on the edges count as inside
+		bool PointInTriangle2D(const FEarNode& A, const FEarNode& B, const FEarNode& C, const FEarNode& P)
+		{
+			return OnSameSide(B.X - A.X, B.Y - A.Y, P.X - A.X, P.Y - A.Y, C.X - A.X, C.Y - A.Y) &&
+				OnSameSide(C.X - B.X, C.Y - B.Y, P.X - B.X, P.Y - B.Y, A.X - B.X, A.Y - B.Y) &&
+				OnSameSide(A.X - C.X, A.Y - C.Y, P.X - C.X, P.Y - C.Y, B.X - C.X, B.Y - C.Y);
+		}
+
+		// Interleaves the bits of the coordinates, quantized to 16 bits within the polygon's bounds
+		uint32_t ZOrder(float X, float Y, float MinX, float MinY, float InvSize)
+		{
+			uint32_t QX = static_cast<uint32_t>((X - MinX) * InvSize);
+			uint32_t QY = static_cast<uint32_t>((Y - MinY) * InvSize);
+
+			QX = (QX | (QX << 8)) & 0x00FF00FF;
+			QX = (QX | (QX << 4)) & 0x0F0F0F0F;
+			QX = (QX | (QX << 2)) & 0x33333333;
+			QX = (QX | (QX << 1)) & 0x55555555;
+
+			QY = (QY | (QY << 8)) & 0x00FF00FF;
+			QY = (QY | (QY << 4)) & 0x0F0F0F0F;
+			QY = (QY | (QY << 2)) & 0x33333333;
+			QY = (QY | (QY << 1)) & 0x55555555;
+
+			return QX | (QY << 1);
+		}
+
+		class FEarClipper
+		{
+		public:
+			FEarClipper(const FVec2* Projected, int32_t NumVerts, FEarClipperBuffers& Buffers)
+				: Nodes(Buffers.Nodes)
+				, SortedNodes(Buffers.SortedNodes)
+				, NumRemaining(NumVerts)
+				, NumReflex(0)
+				, bUseZOrder(NumVerts >= MinVertsForZOrder)
+				, MinX(0.0f), MinY(0.0f), InvSize(0.0f)
+			{
+				Nodes.resize(NumVerts);
+				for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+				{
+					FEarNode& Node = Nodes[VertIndex];
+					Node.Index = VertIndex;
+					Node.X = Projected[VertIndex].X;
+					Node.Y = Projected[VertIndex].Y;
+					Node.Z = 0;
+					Node.Prev = (VertIndex == 0) ? (NumVerts - 1) : (VertIndex - 1);
+					Node.Next = (VertIndex + 1) % NumVerts;
+					Node.PrevZ = Node.NextZ = -1;
+					Node.bReflex = false;
+				}
+
+				for (int32_t NodeIndex = 0; NodeIndex < NumVerts; ++NodeIndex)
+				{
+					UpdateReflex(NodeIndex);
+				}
+
+				if (bUseZOrder)
+				{
+					BuildZOrder();
+				}
+			}
+
+			// Returns the number of indices written, or -1 on failure
+			int32_t Triangulate(int32_t* OutIndices)
+			{
+				int32_t NumIndices = 0;
+				int32_t Ear = 0;
+				int32_t Stop = Ear;
+
+				while (NumRemaining >= 3)
+				{
+					const FEarNode& EarNode = Nodes[Ear];
+					int32_t Prev = EarNode.Prev;
+					int32_t Next = EarNode.Next;
+
+					if (IsEar(Ear))
+					{
+						OutIndices[NumIndices++] = Nodes[Prev].Index;
+						OutIndices[NumIndices++] = EarNode.Index;
+						OutIndices[NumIndices++] = Nodes[Next].Index;
+
+						RemoveNode(Ear);
+						UpdateReflex(Prev);
+						UpdateReflex(Next);
+
+						// Skip ahead past the next vertex, which tends to avoid fans of long sliver triangles
+						Ear = Nodes[Next].Next;
+						Stop = Ear;
+						continue;
+					}
+
+					// If we went all the way around without finding an ear, then something is bad with this polygon
+					Ear = Next;
+					if (Ear == Stop)
+					{
+						return -1;
+					}
+				}
+
+				return NumIndices;
+			}
+
+		private:
+			void UpdateReflex(int32_t NodeIndex)
+			{
+				FEarNode& Node = Nodes[NodeIndex];
+				bool bReflex = !(Area(Nodes[Node.Prev], Node, Nodes[Node.Next]) < 0.0f);
+				if (bReflex != Node.bReflex)
+				{
+					NumReflex += bReflex ? 1 : -1;
+					Node.bReflex = bReflex;
+				}
+			}
+
+			void BuildZOrder()
+			{
+				float MaxX = Nodes[0].X, MaxY = Nodes[0].Y;
+				MinX = Nodes[0].X;
+				MinY = Nodes[0].Y;
+				for (const FEarNode& Node : Nodes)
+				{
+					MinX = std::min(MinX, Node.X);
+					MinY = std::min(MinY, Node.Y);
+					MaxX = std::max(MaxX, Node.X);
+					MaxY = std::max(MaxY, Node.Y);
+				}
+
+				float Size = std::max(MaxX - MinX, MaxY - MinY);
+				InvSize = (Size > 0.0f) ? (32767.0f / Size) : 0.0f;
+
+				SortedNodes.resize(Nodes.size());
+				for (int32_t NodeIndex = 0; NodeIndex < static_cast<int32_t>(Nodes.size()); ++NodeIndex)
+				{
+					Nodes[NodeIndex].Z = ZOrder(Nodes[NodeIndex].X, Nodes[NodeIndex].Y, MinX, MinY, InvSize);
+					SortedNodes[NodeIndex] = NodeIndex;
+				}
+
+				std::sort(SortedNodes.begin(), SortedNodes.end(), [this](int32_t A, int32_t B) {
+					return (Nodes[A].Z < Nodes[B].Z) || ((Nodes[A].Z == Nodes[B].Z) && (A < B));
+				});
+
+				for (size_t SortedIndex = 0; SortedIndex < SortedNodes.size(); ++SortedIndex)
+				{
+					FEarNode& Node = Nodes[SortedNodes[SortedIndex]];
+					Node.PrevZ = (SortedIndex > 0) ? SortedNodes[SortedIndex - 1] : -1;
+					Node.NextZ = (SortedIndex + 1 < SortedNodes.size()) ? SortedNodes[SortedIndex + 1] : -1;
+				}
+			}
+
+			bool IsBlocking(int32_t NodeIndex, const FEarNode& A, const FEarNode& B, const FEarNode& C) const
+			{
+				// Only reflex vertices can be inside of an ear, since any convex vertex inside it would imply a reflex one too
+				const FEarNode& Node = Nodes[NodeIndex];
+				return Node.bReflex && (&Node != &A) && (&Node != &B) && (&Node != &C) && PointInTriangle2D(A, B, C, Node);
+			}
+
+			bool IsEar(int32_t Ear) const
+			{
+				const FEarNode& B = Nodes[Ear];
+				const FEarNode& A = Nodes[B.Prev];
+				const FEarNode& C = Nodes[B.Next];
+
+				// The ear must be convex (cross product must be negative around the normal)
+				if (B.bReflex)
+				{
+					return false;
+				}
+
+				if (NumReflex == 0)
+				{
+					return true;
+				}
+
+				if (!bUseZOrder)
+				{
+					for (int32_t NodeIndex = C.Next; NodeIndex != B.Prev; NodeIndex = Nodes[NodeIndex].Next)
+					{
+						if (IsBlocking(NodeIndex, A, B, C))
+						{
+							return false;
+						}
+					}
+
+					return true;
+				}
+
+				// Only the vertices whose z-order is within the ear's bounds can be inside of it
+				float TriMinX = std::min(A.X, std::min(B.X, C.X));
+				float TriMinY = std::min(A.Y, std::min(B.Y, C.Y));
+				float TriMaxX = std::max(A.X, std::max(B.X, C.X));
+				float TriMaxY = std::max(A.Y, std::max(B.Y, C.Y));
+				uint32_t MinZ = ZOrder(TriMinX, TriMinY, MinX, MinY, InvSize);
+				uint32_t MaxZ = ZOrder(TriMaxX, TriMaxY, MinX, MinY, InvSize);
+
+				for (int32_t NodeIndex = B.PrevZ; (NodeIndex != -1) && (Nodes[NodeIndex].Z >= MinZ); NodeIndex = Nodes[NodeIndex].PrevZ)
+				{
+					if (IsBlocking(NodeIndex, A, B, C))
+					{
+						return false;
+					}
+				}
+
+				for (int32_t NodeIndex = B.NextZ; (NodeIndex != -1) && (Nodes[NodeIndex].Z <= MaxZ); NodeIndex = Nodes[NodeIndex].NextZ)
+				{
+					if (IsBlocking(NodeIndex, A, B, C))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			void RemoveNode(int32_t NodeIndex)
+			{
+				FEarNode& Node = Nodes[NodeIndex];
+				Nodes[Node.Prev].Next = Node.Next;
+				Nodes[Node.Next].Prev = Node.Prev;
+
+				if (Node.PrevZ != -1)
+				{
+					Nodes[Node.PrevZ].NextZ = Node.NextZ;
+				}
+				if (Node.NextZ != -1)
+				{
+					Nodes[Node.NextZ].PrevZ = Node.PrevZ;
+				}
+
+				if (Node.bReflex)
+				{
+					--NumReflex;
+				}
+				--NumRemaining;
+			}
+
+			std::vector<FEarNode>& Nodes;
+			std::vector<int32_t>& SortedNodes;
+			int32_t NumRemaining;
+			int32_t NumReflex;
+			bool bUseZOrder;
+			float MinX, MinY, InvSize;
+		};
+	}
+
+	FTriangulationScratch::FTriangulationScratch()
+		: EarClipperBuffers(new FEarClipperBuffers())
+		, DelaunayBuffers(new FDelaunayBuffers())
+	{ }
+
+	FTriangulationScratch::~FTriangulationScratch()
+	{ }
+
+	FTriangulationScratch& GetThreadTriangulationScratch()
+	{
+		thread_local FTriangulationScratch ThreadScratch;
+		return ThreadScratch;
+	}
+
+	int32_t TriangulateProjectedPolygon(int32_t NumVerts, FTriangulationScratch& Scratch, int32_t* OutIndices)
+	{
+		if (NumVerts < 3)
+		{
+			return 0;
+		}
+
+		FEarClipper EarClipper(Scratch.Projected.data(), NumVerts, Scratch.GetEarClipperBuffers());
+		return EarClipper.Triangulate(OutIndices);
+	}
+
+	bool TriangulatePolygon(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices)
+	{
+		// The thread's own scratch keeps its capacity, so only polygons larger than any before it on this thread allocate
+		size_t NumStartingIndices = OutIndices.size();
+		OutIndices.resize(NumStartingIndices + GetMaxTriangleIndices(NumVerts, 1));
+
+		int32_t NumIndices = TriangulatePolygon(TVertexArrayAccessor<FVec3>(Verts), NumVerts, Normal, GetThreadTriangulationScratch(),
+			OutIndices.data() + NumStartingIndices);
+		OutIndices.resize(NumStartingIndices + std::max(NumIndices, 0));
+		return NumIndices >= 0;
+	}
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+#include <utility>
+#include <vector>
+
+namespace ModumateCore
+{
+	struct FEarNode
+	{
+		int32_t Index;
+		float X, Y;
+		uint32_t Z;
+		int32_t Prev, Next;
+		int32_t PrevZ, NextZ;
+		bool bReflex;
+	};
+
+	struct FEarClipperBuffers
+	{
+		std::vector<FEarNode> Nodes;
+		std::vector<int32_t> SortedNodes;
+	};
+
+	struct FDelaunayPoint
+	{
+		double X, Y;
+	};
+
+	struct FDelaunayTriangle
+	{
+		// Counter-clockwise vertices; the neighbor and constraint count at each corner are for the edge opposite of it
+		int32_t Verts[3];
+		int32_t Neighbors[3];
+		uint8_t Constraints[3];
+	};
+
+	typedef std::pair<int32_t, int32_t> FDelaunayEdge;
+
+	struct FDelaunayBuffers
+	{
+		std::vector<int32_t> SortedVerts;
+		std::vector<int32_t> VertPoints;
+		std::vector<int32_t> PointVerts;
+		std::vector<FDelaunayPoint> Points;
+		std::vector<std::pair<uint32_t, int32_t>> SortedPoints;
+		std::vector<FDelaunayTriangle> Triangles;
+		std::vector<int32_t> VertTriangles;
+		std::vector<FDelaunayEdge> LegalizeStack;
+		std::vector<FDelaunayEdge> CrossedEdges;
+		std::vector<FDelaunayEdge> NewEdges;
+		std::vector<int32_t> Fan;
+		std::vector<int32_t> Depths;
+		std::vector<int32_t> CurrentTriangles;
+		std::vector<int32_t> DeeperTriangles;
+	};
+}
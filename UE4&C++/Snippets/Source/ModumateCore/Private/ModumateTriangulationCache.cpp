@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateTriangulationCache.h"
+
+#include "ModumateDelaunay.h"
+
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+namespace ModumateCore
+{
+	namespace
+	{
+		int64_t Quantize(float Value, float Size)
+		{
+			return static_cast<int64_t>(std::llround(static_cast<double>(Value) / Size));
+		}
+
+		// FNV-1a over the bytes of the key
+		uint64_t HashKey(const std::vector<int64_t>& Key)
+		{
+			uint64_t Hash = 14695981039346656037ull;
+			for (int64_t Value : Key)
+			{
+				for (int32_t Byte = 0; Byte < 8; ++Byte)
+				{
+					Hash ^= static_cast<uint64_t>(Value >> (8 * Byte)) & 0xFF;
+					Hash *= 1099511628211ull;
+				}
+			}
+
+			return Hash;
+		}
+	}
+
+	// A hundredth of a centimeter, well under the room node epsilon, so only polygons that are the same for editing share triangles
+	const float FTriangulationCache::QuantizeSize = 0.01f;
+
+	FTriangulationCache::FTriangulationCache(size_t InCapacity)
+		: Capacity(InCapacity)
+		, NumHits(0)
+		, NumMisses(0)
+	{ }
+
+	FTriangulationCache& FTriangulationCache::Get()
+	{
+		static FTriangulationCache SharedCache;
+		return SharedCache;
+	}
+
+	FTriangulationCache::FIndexBuffer FTriangulationCache::TriangulateProjected(const int32_t* LoopSizes, int32_t NumLoops,
+		FTriangulationScratch& Scratch, bool* bOutHit)
+	{
+		// Each thread builds its keys and indices in its own buffers, which keep their capacity between lookups
+		thread_local std::vector<int64_t> ScratchKey;
+		thread_local std::vector<int32_t> ScratchIndices;
+
+		// The triangulation only depends on the projected vertices, so the normal doesn't need to be part of the key
+		int32_t NumVerts = static_cast<int32_t>(Scratch.Projected.size());
+		ScratchKey.clear();
+		ScratchKey.reserve(1 + NumLoops + 2 * NumVerts);
+		ScratchKey.push_back(NumLoops);
+		ScratchKey.insert(ScratchKey.end(), LoopSizes, LoopSizes + NumLoops);
+		for (const FVec2& Vert : Scratch.Projected)
+		{
+			ScratchKey.push_back(Quantize(Vert.X, QuantizeSize));
+			ScratchKey.push_back(Quantize(Vert.Y, QuantizeSize));
+		}
+
+		uint64_t Hash = HashKey(ScratchKey);
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (FIndexBuffer CachedIndices = FindEntry(Hash, ScratchKey))
+			{
+				++NumHits;
+				if (bOutHit)
+				{
+					*bOutHit = true;
+				}
+				return CachedIndices;
+			}
+
+			++NumMisses;
+		}
+
+		if (bOutHit)
+		{
+			*bOutHit = false;
+		}
+
+		// Triangulate without holding the lock, so that other threads can keep looking up and triangulating other polygons
+		ScratchIndices.resize(GetMaxTriangleIndices(NumVerts, NumLoops));
+		int32_t NumIndices = TriangulateProjectedPolygonDelaunay(LoopSizes, NumLoops, Scratch, ScratchIndices.data());
+		if (NumIndices < 0)
+		{
+			return nullptr;
+		}
+
+		// Only the new buffer that the cache hands out is allocated, at its exact size
+		FIndexBuffer IndexBuffer = std::make_shared<const std::vector<int32_t>>(ScratchIndices.begin(), ScratchIndices.begin() + NumIndices);
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (Capacity > 0)
+		{
+			// Another thread may have triangulated the same polygon in the meantime, in which case its buffer is the one to share
+			if (FIndexBuffer CachedIndices = FindEntry(Hash, ScratchKey))
+			{
+				return CachedIndices;
+			}
+
+			// A full cache recycles its least recently used entry, swapping that key's capacity into this thread's ScratchKey
+			if (Entries.size() >= Capacity)
+			{
+				RemoveFromHash(std::prev(Entries.end()));
+				Entries.splice(Entries.begin(), Entries, std::prev(Entries.end()));
+				FEntry& Entry = Entries.front();
+				Entry.Hash = Hash;
+				Entry.Key.swap(ScratchKey);
+				Entry.Indices = IndexBuffer;
+			}
+			else
+			{
+				Entries.push_front({ Hash, std::move(ScratchKey), IndexBuffer });
+			}
+			EntriesByHash.emplace(Hash, Entries.begin());
+			TrimToCapacity();
+		}
+
+		return IndexBuffer;
+	}
+
+	FTriangulationCache::FIndexBuffer FTriangulationCache::FindEntry(uint64_t Hash, const std::vector<int64_t>& Key)
+	{
+		auto Range = EntriesByHash.equal_range(Hash);
+		for (auto It = Range.first; It != Range.second; ++It)
+		{
+			if (It->second->Key == Key)
+			{
+				Entries.splice(Entries.begin(), Entries, It->second);
+				return Entries.front().Indices;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void FTriangulationCache::TrimToCapacity()
+	{
+		while (Entries.size() > Capacity)
+		{
+			// Buffers that are still in use outlive their entries, since they're shared
+			RemoveFromHash(std::prev(Entries.end()));
+			Entries.pop_back();
+		}
+	}
+
+	void FTriangulationCache::RemoveFromHash(std::list<FEntry>::iterator Entry)
+	{
+		auto Range = EntriesByHash.equal_range(Entry->Hash);
+		for (auto It = Range.first; It != Range.second; ++It)
+		{
+			if (It->second == Entry)
+			{
+				EntriesByHash.erase(It);
+				break;
+			}
+		}
+	}
+
+	void FTriangulationCache::SetCapacity(size_t NewCapacity)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Capacity = NewCapacity;
+		TrimToCapacity();
+	}
+
+	size_t FTriangulationCache::GetCapacity() const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return Capacity;
+	}
+
+	size_t FTriangulationCache::Num() const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return Entries.size();
+	}
+
+	void FTriangulationCache::Empty()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Entries.clear();
+		EntriesByHash.clear();
+		NumHits = 0;
+		NumMisses = 0;
+	}
+
+	uint64_t FTriangulationCache::GetNumHits() const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return NumHits;
+	}
+
+	uint64_t FTriangulationCache::GetNumMisses() const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return NumMisses;
+	}
+}
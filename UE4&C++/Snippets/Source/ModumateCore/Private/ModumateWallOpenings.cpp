@@ -0,0 +1,475 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ModumateWallOpenings.h"
+
+#include "ModumateMeshBuilder.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+
+namespace ModumateCore
+{
+	FWallOpeningList::FWallOpeningList()
+		: NextID(0)
+	{ }
+
+	bool FWallOpeningList::CanPlace(const FWallOpening& Opening, float WallLength, int32_t IgnoreID) const
+	{
+		if (!(Opening.Start > 0.0f && Opening.Start < Opening.End && Opening.End < WallLength && Opening.SillHeight < Opening.HeadHeight))
+		{
+			return false;
+		}
+
+		// Since openings don't overlap, only the ones right before and after this one's start can reach it
+		auto Next = Openings.lower_bound(Opening.Start);
+		auto Prev = Next;
+		if (Next != Openings.end() && Next->second.ID == IgnoreID)
+		{
+			++Next;
+		}
+		if (Next != Openings.end() && Next->second.Start <= Opening.End)
+		{
+			return false;
+		}
+
+		if (Prev != Openings.begin())
+		{
+			--Prev;
+			if (Prev->second.ID == IgnoreID)
+			{
+				if (Prev == Openings.begin())
+				{
+					return true;
+				}
+				--Prev;
+			}
+			if (Prev->second.End >= Opening.Start)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	int32_t FWallOpeningList::Add(const FWallOpening& Opening, float WallLength)
+	{
+		if (!CanPlace(Opening, WallLength))
+		{
+			return -1;
+		}
+
+		FWallOpening NewOpening = Opening;
+		NewOpening.ID = NextID++;
+		Openings.emplace(NewOpening.Start, NewOpening);
+		OpeningStarts.emplace(NewOpening.ID, NewOpening.Start);
+		return NewOpening.ID;
+	}
+
+	bool FWallOpeningList::Move(int32_t ID, const FWallOpening& Opening, float WallLength)
+	{
+		auto StartIt = OpeningStarts.find(ID);
+		if (StartIt == OpeningStarts.end() || !CanPlace(Opening, WallLength, ID))
+		{
+			return false;
+		}
+
+		Openings.erase(StartIt->second);
+		FWallOpening MovedOpening = Opening;
+		MovedOpening.ID = ID;
+		Openings.emplace(MovedOpening.Start, MovedOpening);
+		StartIt->second = MovedOpening.Start;
+		return true;
+	}
+
+	bool FWallOpeningList::Remove(int32_t ID)
+	{
+		auto StartIt = OpeningStarts.find(ID);
+		if (StartIt == OpeningStarts.end())
+		{
+			return false;
+		}
+
+		Openings.erase(StartIt->second);
+		OpeningStarts.erase(StartIt);
+		return true;
+	}
+
+	void FWallOpeningList::GetGapAround(float U, float WallLength, float& OutStart, float& OutEnd) const
+	{
+		auto Next = Openings.upper_bound(U);
+		OutEnd = (Next != Openings.end()) ? std::min(Next->second.Start, WallLength) : WallLength;
+		OutStart = (Next != Openings.begin()) ? std::min(std::prev(Next)->second.End, OutEnd) : 0.0f;
+	}
+
+	const FWallOpening* FWallOpeningList::Find(int32_t ID) const
+	{
+		auto StartIt = OpeningStarts.find(ID);
+		if (StartIt == OpeningStarts.end())
+		{
+			return nullptr;
+		}
+
+		return &Openings.find(StartIt->second)->second;
+	}
+
+	void FWallOpeningList::Empty()
+	{
+		Openings.clear();
+		OpeningStarts.clear();
+	}
+
+	namespace
+	{
+		// A stretch of the wall's base or top that's solid so far, which is covered by a single quad once it ends
+		struct FWallFaceRun
+		{
+			bool bActive;
+			float Start;
+		};
+
+		class FWallMeshBuilder
+		{
+		public:
+			FWallMeshBuilder(const FVec3& InStartPoint, const FVec3& InDir, const FVec3& InRight, float InHalfThickness, float InHeight,
+				FMeshBuilder& InMesh)
+				: StartPoint(InStartPoint)
+				, Dir(InDir)
+				, Right(InRight)
+				, Up({ 0.0f, 0.0f, 1.0f })
+				, HalfThickness(InHalfThickness)
+				, Height(InHeight)
+				, Mesh(InMesh)
+				, BaseRun({ false, 0.0f })
+				, TopRun({ false, 0.0f })
+			{ }
+
+			FVec3 GetPoint(float U, float Side, float Z) const
+			{
+				return StartPoint + Dir * U + Right * (Side * HalfThickness) + Up * Z;
+			}
+
+			void GetOpeningHeights(const FWallOpening& Opening, float& OutSill, float& OutHead) const
+			{
+				OutSill = std::max(Opening.SillHeight, 0.0f);
+				OutHead = std::min(Opening.HeadHeight, Height);
+			}
+
+			/**
+			 * Adds the wall from FromU to ToU, which is solid, or the parts of it above and below the opening. The sides of each part are
+			 * a single quad, so full height spans meet the parts around openings in T-junctions, and the base and top are merged into runs.
+			 */
+			void AddSpan(float FromU, float ToU, const FWallOpening* Opening)
+			{
+				float Sill = 0.0f, Head = Height;
+				if (Opening)
+				{
+					GetOpeningHeights(*Opening, Sill, Head);
+					if (Sill > 0.0f)
+					{
+						AddSideQuads(FromU, ToU, 0.0f, Sill);
+					}
+					if (Head < Height)
+					{
+						AddSideQuads(FromU, ToU, Head, Height);
+					}
+				}
+				else
+				{
+					AddSideQuads(FromU, ToU, 0.0f, Height);
+				}
+
+				ExtendRun(BaseRun, !Opening || Sill > 0.0f, FromU, 0.0f, Up * -1.0f);
+				ExtendRun(TopRun, !Opening || Head < Height, FromU, Height, Up);
+			}
+
+			// Adds the faces inside of the opening, between its start and end
+			void AddReveals(const FWallOpening& Opening)
+			{
+				float Sill, Head;
+				GetOpeningHeights(Opening, Sill, Head);
+
+				Mesh.AddQuad(GetPoint(Opening.Start, -1.0f, Sill), GetPoint(Opening.Start, 1.0f, Sill),
+					GetPoint(Opening.Start, 1.0f, Head), GetPoint(Opening.Start, -1.0f, Head), Dir);
+				Mesh.AddQuad(GetPoint(Opening.End, -1.0f, Sill), GetPoint(Opening.End, 1.0f, Sill),
+					GetPoint(Opening.End, 1.0f, Head), GetPoint(Opening.End, -1.0f, Head), Dir * -1.0f);
+
+				if (Sill > 0.0f)
+				{
+					AddHorizontalQuad(Opening.Start, Opening.End, Sill, Up);
+				}
+				if (Head < Height)
+				{
+					AddHorizontalQuad(Opening.Start, Opening.End, Head, Up * -1.0f);
+				}
+			}
+
+			/** Meshes the wall from RangeStart to RangeEnd in one pass over the openings inside of it, and ExtraOpening if it's inside too. */
+			void AddRange(const FWallOpeningList& Openings, float Length, float RangeStart, float RangeEnd, const FWallOpening* ExtraOpening)
+			{
+				if (RangeStart == 0.0f)
+				{
+					AddCap(0.0f, Dir * -1.0f);
+				}
+
+				float SpanStart = RangeStart;
+				auto AddOpening = [&](const FWallOpening& Opening)
+				{
+					if (Opening.Start < SpanStart || !FitsWall(Opening, Length))
+					{
+						return;
+					}
+
+					if (Opening.Start > SpanStart)
+					{
+						AddSpan(SpanStart, Opening.Start, nullptr);
+					}
+					AddSpan(Opening.Start, Opening.End, &Opening);
+					AddReveals(Opening);
+					SpanStart = Opening.End;
+				};
+
+				const FWallOpeningList::FOpeningMap& OpeningMap = Openings.GetOpenings();
+				bool bAddedExtra = (ExtraOpening == nullptr);
+				for (auto It = OpeningMap.lower_bound(RangeStart); It != OpeningMap.end(); ++It)
+				{
+					const FWallOpening& Opening = It->second;
+					if (!bAddedExtra && ExtraOpening->Start < Opening.Start && ExtraOpening->End <= RangeEnd)
+					{
+						AddOpening(*ExtraOpening);
+						bAddedExtra = true;
+					}
+
+					if (Opening.End > RangeEnd)
+					{
+						break;
+					}
+
+					AddOpening(Opening);
+				}
+
+				if (!bAddedExtra && ExtraOpening->Start >= RangeStart && ExtraOpening->End <= RangeEnd)
+				{
+					AddOpening(*ExtraOpening);
+				}
+
+				if (SpanStart < RangeEnd)
+				{
+					AddSpan(SpanStart, RangeEnd, nullptr);
+				}
+				EndRun(BaseRun, RangeEnd, 0.0f, Up * -1.0f);
+				EndRun(TopRun, RangeEnd, Height, Up);
+
+				if (RangeEnd == Length)
+				{
+					AddCap(Length, Dir);
+				}
+			}
+
+		private:
+			bool FitsWall(const FWallOpening& Opening, float Length) const
+			{
+				float Sill, Head;
+				GetOpeningHeights(Opening, Sill, Head);
+				return Opening.Start > 0.0f && Opening.End < Length && Sill < Head;
+			}
+
+			void AddCap(float U, const FVec3& Normal)
+			{
+				Mesh.AddQuad(GetPoint(U, -1.0f, 0.0f), GetPoint(U, 1.0f, 0.0f), GetPoint(U, 1.0f, Height), GetPoint(U, -1.0f, Height), Normal);
+			}
+
+			void AddSideQuads(float FromU, float ToU, float Bottom, float Top)
+			{
+				for (float Side : { -1.0f, 1.0f })
+				{
+					Mesh.AddQuad(GetPoint(FromU, Side, Bottom), GetPoint(ToU, Side, Bottom), GetPoint(ToU, Side, Top), GetPoint(FromU, Side, Top), Right * Side);
+				}
+			}
+
+			// Spans are added in order along the wall, so a run continues until a span that isn't solid at its height
+			void ExtendRun(FWallFaceRun& Run, bool bSolid, float FromU, float Z, const FVec3& Normal)
+			{
+				if (!bSolid)
+				{
+					EndRun(Run, FromU, Z, Normal);
+				}
+				else if (!Run.bActive)
+				{
+					Run.bActive = true;
+					Run.Start = FromU;
+				}
+			}
+
+			void EndRun(FWallFaceRun& Run, float U, float Z, const FVec3& Normal)
+			{
+				if (Run.bActive)
+				{
+					AddHorizontalQuad(Run.Start, U, Z, Normal);
+					Run.bActive = false;
+				}
+			}
+
+			void AddHorizontalQuad(float FromU, float ToU, float Z, const FVec3& Normal)
+			{
+				Mesh.AddQuad(GetPoint(FromU, -1.0f, Z), GetPoint(FromU, 1.0f, Z), GetPoint(ToU, 1.0f, Z), GetPoint(ToU, -1.0f, Z), Normal);
+			}
+
+			FVec3 StartPoint, Dir, Right, Up;
+			float HalfThickness, Height;
+			FMeshBuilder& Mesh;
+			FWallFaceRun BaseRun, TopRun;
+		};
+	}
+
+	namespace
+	{
+		struct FWallRange
+		{
+			float Start;
+			float End;
+		};
+
+		// Meshes the given stretches of the wall, where ends of the wall itself are capped, and other range ends are left open
+		void BuildWallRanges(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+			const FWallRange* Ranges, int32_t NumRanges, const FWallOpening* ExtraOpening,
+			std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices)
+		{
+			FMeshBuilder Mesh(OutVertices, OutNormals, OutIndices, bWeldVertices);
+
+			FVec3 Axis = EndPoint - StartPoint;
+			FVec3 Right = FVec3{ 0.0f, 0.0f, 1.0f } ^ Axis;
+			float Length = Axis.Size();
+			float RightSize = Right.Size();
+			if (Length <= 0.0f || RightSize <= 0.0f || Height <= 0.0f)
+			{
+				return;
+			}
+
+			// Before welding, at most 12 quads per opening and the span before it, plus 4 for each range's last span, base, top and cap
+			size_t NumOpenings = Openings.GetOpenings().size() + (ExtraOpening ? 1 : 0);
+			size_t NumQuads = 12 * NumOpenings + 4 * NumRanges;
+			OutVertices.reserve(4 * NumQuads);
+			OutNormals.reserve(4 * NumQuads);
+			OutIndices.reserve(6 * NumQuads);
+
+			FWallMeshBuilder Builder(StartPoint, Axis / Length, Right / RightSize, HalfThickness, Height, Mesh);
+			for (int32_t RangeIndex = 0; RangeIndex < NumRanges; ++RangeIndex)
+			{
+				float RangeStart = std::max(Ranges[RangeIndex].Start, 0.0f);
+				float RangeEnd = std::min(Ranges[RangeIndex].End, Length);
+				if (RangeStart < RangeEnd)
+				{
+					Builder.AddRange(Openings, Length, RangeStart, RangeEnd, ExtraOpening);
+				}
+			}
+		}
+	}
+
+	void BuildWallMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices)
+	{
+		FWallRange WholeWall = { 0.0f, std::numeric_limits<float>::max() };
+		BuildWallRanges(StartPoint, EndPoint, HalfThickness, Height, Openings, &WholeWall, 1, nullptr, OutVertices, OutNormals, OutIndices, bWeldVertices);
+	}
+
+	void BuildWallSpanMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float SpanStart, float SpanEnd, const FWallOpening* ExtraOpening,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices)
+	{
+		FWallRange Span = { SpanStart, SpanEnd };
+		BuildWallRanges(StartPoint, EndPoint, HalfThickness, Height, Openings, &Span, 1, ExtraOpening, OutVertices, OutNormals, OutIndices, bWeldVertices);
+	}
+
+	void BuildWallMeshAroundSpan(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float SpanStart, float SpanEnd, std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices)
+	{
+		FWallRange Ranges[2] = { { 0.0f, SpanStart }, { SpanEnd, std::numeric_limits<float>::max() } };
+		BuildWallRanges(StartPoint, EndPoint, HalfThickness, Height, Openings, Ranges, 2, nullptr, OutVertices, OutNormals, OutIndices, bWeldVertices);
+	}
+
+	void BuildWallSlabMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices)
+	{
+		static const FWallOpeningList NoOpenings;
+		BuildWallMesh(StartPoint, EndPoint, HalfThickness, Height, NoOpenings, OutVertices, OutNormals, OutIndices);
+	}
+
+	void BuildWallOpeningQuads(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float Offset, std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices)
+	{
+		FMeshBuilder Mesh(OutVertices, OutNormals, OutIndices, false);
+
+		FVec3 Axis = EndPoint - StartPoint;
+		FVec3 Right = FVec3{ 0.0f, 0.0f, 1.0f } ^ Axis;
+		float Length = Axis.Size();
+		float RightSize = Right.Size();
+		if (Length <= 0.0f || RightSize <= 0.0f || Height <= 0.0f)
+		{
+			return;
+		}
+
+		FVec3 Dir = Axis / Length;
+		Right = Right / RightSize;
+		FVec3 Up = { 0.0f, 0.0f, 1.0f };
+		OutVertices.reserve(8 * Openings.GetOpenings().size());
+		OutNormals.reserve(8 * Openings.GetOpenings().size());
+		OutIndices.reserve(12 * Openings.GetOpenings().size());
+
+		for (const auto& OpeningPair : Openings.GetOpenings())
+		{
+			const FWallOpening& Opening = OpeningPair.second;
+			float Sill = std::max(Opening.SillHeight, 0.0f);
+			float Head = std::min(Opening.HeadHeight, Height);
+			if (!(Opening.Start > 0.0f && Opening.End < Length && Sill < Head))
+			{
+				continue;
+			}
+
+			for (float Side : { -1.0f, 1.0f })
+			{
+				FVec3 SideOffset = Right * (Side * (HalfThickness + Offset));
+				FVec3 Bottom = StartPoint + SideOffset + Up * Sill;
+				FVec3 Top = StartPoint + SideOffset + Up * Head;
+				Mesh.AddQuad(Bottom + Dir * Opening.Start, Bottom + Dir * Opening.End, Top + Dir * Opening.End, Top + Dir * Opening.Start, Right * Side);
+			}
+		}
+	}
+
+	void GetWallSolidBoxes(const FWallOpeningList& Openings, float WallLength, float Height, std::vector<FWallSolidBox>& OutBoxes)
+	{
+		OutBoxes.clear();
+		if (WallLength <= 0.0f || Height <= 0.0f)
+		{
+			return;
+		}
+
+		// Openings never touch, so every span between them has some width
+		float SpanStart = 0.0f;
+		for (const auto& OpeningPair : Openings.GetOpenings())
+		{
+			const FWallOpening& Opening = OpeningPair.second;
+			float Sill = std::max(Opening.SillHeight, 0.0f);
+			float Head = std::min(Opening.HeadHeight, Height);
+			if (!(Opening.Start > 0.0f && Opening.End < WallLength && Sill < Head))
+			{
+				continue;
+			}
+
+			OutBoxes.push_back({ SpanStart, Opening.Start, 0.0f, Height });
+			if (Sill > 0.0f)
+			{
+				OutBoxes.push_back({ Opening.Start, Opening.End, 0.0f, Sill });
+			}
+			if (Head < Height)
+			{
+				OutBoxes.push_back({ Opening.Start, Opening.End, Head, Height });
+			}
+			SpanStart = Opening.End;
+		}
+
+		OutBoxes.push_back({ SpanStart, WallLength, 0.0f, Height });
+	}
+}
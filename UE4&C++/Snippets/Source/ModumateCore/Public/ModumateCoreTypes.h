@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// When building inside the engine, UnrealBuildTool defines the module's export macro.
+#ifndef MODUMATECORE_API
+#define MODUMATECORE_API
+#endif
+
+/**
+ * Plain data types for the engine-independent geometry and topology code.
+ * These intentionally mirror the float math of the engine's FVector operators, so that the
+ * Modumate module can wrap the core algorithms without changing any of their results.
+ */
+namespace ModumateCore
+{
+	struct FVec2
+	{
+		float X;
+		float Y;
+	};
+
+	struct FVec3
+	{
+		float X;
+		float Y;
+		float Z;
+
+		FVec3 operator+(const FVec3& V) const { return { X + V.X, Y + V.Y, Z + V.Z }; }
+		FVec3 operator-(const FVec3& V) const { return { X - V.X, Y - V.Y, Z - V.Z }; }
+		FVec3 operator*(float Scale) const { return { X * Scale, Y * Scale, Z * Scale }; }
+		FVec3 operator/(float Scale) const { const float RScale = 1.0f / Scale; return { X * RScale, Y * RScale, Z * RScale }; }
+
+		/** Cross product, like FVector::operator^ */
+		FVec3 operator^(const FVec3& V) const { return { Y * V.Z - Z * V.Y, Z * V.X - X * V.Z, X * V.Y - Y * V.X }; }
+
+		/** Dot product, like FVector::operator| */
+		float operator|(const FVec3& V) const { return X * V.X + Y * V.Y + Z * V.Z; }
+
+		float Size() const { return std::sqrt(X * X + Y * Y + Z * Z); }
+		float SizeSquared() const { return X * X + Y * Y + Z * Z; }
+
+		bool Equals(const FVec3& V, float Tolerance) const
+		{
+			return std::fabs(X - V.X) <= Tolerance && std::fabs(Y - V.Y) <= Tolerance && std::fabs(Z - V.Z) <= Tolerance;
+		}
+	};
+
+	inline FVec3 operator*(float Scale, const FVec3& V) { return V * Scale; }
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+#include "ModumateTriangulation.h"
+
+#include <vector>
+
+namespace ModumateCore
+{
+	/**
+	 * Triangulates the loops that are already projected into Scratch.Projected, like TriangulatePolygonDelaunay,
+	 * returning the number of indices written to OutIndices, or -1 if they couldn't be triangulated.
+	 */
+	MODUMATECORE_API int32_t TriangulateProjectedPolygonDelaunay(const int32_t* LoopSizes, int32_t NumLoops, FTriangulationScratch& Scratch,
+		int32_t* OutIndices);
+
+	/**
+	 * Decomposes a polygon with holes into a constrained Delaunay triangulation, appending indices into Verts to OutIndices.
+	 * Verts holds the outer loop's vertices followed by each hole's, and LoopSizes holds the number of vertices in each of the
+	 * NumLoops loops. Loops can wind either way, and a hole may touch the outer loop or another hole at a vertex.
+	 * Triangles wind clockwise around Normal, like TriangulatePolygon, but avoid its long slivers, since they maximize their
+	 * minimum angles; points are inserted in z-order so typical polygons take O(n log n).
+	 * Coincident vertices are merged, so the triangles only use the first index of each group of them.
+	 * OutIndices must have room for GetMaxTriangleIndices of the loops' vertices; returns the number of indices written,
+	 * or -1 if the loops cross each other or couldn't be triangulated.
+	 */
+	template <typename VertexAccessor>
+	int32_t TriangulatePolygonDelaunay(const VertexAccessor& GetVertex, const int32_t* LoopSizes, int32_t NumLoops, const FVec3& Normal,
+		FTriangulationScratch& Scratch, int32_t* OutIndices)
+	{
+		int32_t NumVerts = 0;
+		for (int32_t LoopIndex = 0; LoopIndex < NumLoops; ++LoopIndex)
+		{
+			NumVerts += LoopSizes[LoopIndex];
+		}
+
+		ProjectToScratch(GetVertex, NumVerts, Normal, Scratch);
+		return TriangulateProjectedPolygonDelaunay(LoopSizes, NumLoops, Scratch, OutIndices);
+	}
+
+	/** Like the templated TriangulatePolygonDelaunay, but appends to OutIndices, and returns false without adding any if it fails. */
+	MODUMATECORE_API bool TriangulatePolygonDelaunay(const FVec3* Verts, const int32_t* LoopSizes, int32_t NumLoops, const FVec3& Normal,
+		std::vector<int32_t>& OutIndices);
+}
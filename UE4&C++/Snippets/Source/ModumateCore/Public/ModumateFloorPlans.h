@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+#include <vector>
+
+/**
+ * Synthetic floor plans, for benchmarking the edit pipeline at different scales.
+ * Walls never cross each other, and any wall that ends on another wall splits it there,
+ * so that every plan can be placed one wall at a time and forms closed rooms.
+ * Walls are in placement order, spreading out from the origin in the XY plane.
+ */
+namespace ModumateCore
+{
+	struct FWallSegment
+	{
+		FVec3 Start;
+		FVec3 End;
+	};
+
+	/** A grid of NumRoomsX by NumRoomsY square rooms, with one wall per room side. */
+	MODUMATECORE_API void GenerateGridPlan(int32_t NumRoomsX, int32_t NumRoomsY, float RoomSize, std::vector<FWallSegment>& OutWalls);
+
+	/** A rectangle that's recursively split into NumRooms rectangular rooms of random proportions, which meet at T-junctions. */
+	MODUMATECORE_API void GenerateRectilinearPlan(int32_t NumRooms, float CellSize, uint32_t Seed, std::vector<FWallSegment>& OutWalls);
+
+	/** A grid of rooms whose sides are split in half, where some rooms are cut corner to corner by a diagonal wall,
+	    and others are cut in half by a wall between the midpoints of opposite sides, making T-junctions. */
+	MODUMATECORE_API void GenerateDiagonalPlan(int32_t NumRoomsX, int32_t NumRoomsY, float RoomSize, uint32_t Seed, std::vector<FWallSegment>& OutWalls);
+}
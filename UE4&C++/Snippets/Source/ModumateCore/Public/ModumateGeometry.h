@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+#include <vector>
+
+namespace ModumateCore
+{
+	struct FSegmentIntersection
+	{
+		FVec3 Location;
+		float DistAlongA;
+		float DistAlongB;
+	};
+
+	/** Finds where segment A crosses segment B in the XY plane, ignoring touches within Epsilon (as a fraction of length) of either end.
+	    This is the math behind AWall::GetWallIntersection2D. */
+	MODUMATECORE_API bool IntersectSegments2D(const FVec3& StartA, const FVec3& EndA, const FVec3& StartB, const FVec3& EndB,
+		FSegmentIntersection& OutIntersection, float Epsilon = 0.01f);
+
+	/** Determines whether two edges may be merged. */
+	MODUMATECORE_API bool AreEdgesMergeable(const FVec3& V0, const FVec3& V1, const FVec3& V2);
+
+	/** Given three direction vectors, indicates if A and B are on the same 'side' of Vec. */
+	MODUMATECORE_API bool VectorsOnSameSide(const FVec3& Vec, const FVec3& A, const FVec3& B);
+
+	/** Util to see if P lies within triangle created by A, B and C. */
+	MODUMATECORE_API bool PointInTriangle(const FVec3& A, const FVec3& B, const FVec3& C, const FVec3& P);
+
+	/** Whether P is inside the polygon in the XY plane, by the even-odd rule. Points on its edges may go either way. */
+	MODUMATECORE_API bool PointInPolygon2D(const FVec3* Verts, int32_t NumVerts, const FVec3& P);
+
+	/** Signed angle in degrees from one direction to the next, around Normal. */
+	MODUMATECORE_API float GetWinding(const FVec3& FromDir, const FVec3& ToDir, const FVec3& Normal);
+
+	/** Total signed turning angle in degrees around a closed loop of edge directions, where the last direction connects back to the first. */
+	MODUMATECORE_API float GetLoopWinding(const FVec3* LoopDirs, int32_t NumDirs, const FVec3& Normal);
+
+	/** Unit axes (U, V) of the plane with the given normal, where U ^ V is along Normal. A +Z normal gives exactly X and Y. */
+	MODUMATECORE_API void GetPlaneBasis(const FVec3& Normal, FVec3& OutU, FVec3& OutV);
+
+	/** Projects points onto the plane's GetPlaneBasis axes, so that windings around Normal are preserved. */
+	MODUMATECORE_API void ProjectToPlane(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, FVec2* OutVerts);
+
+	/** Decomposes the polygon into triangles with a naive O(n^3) ear-clipping algorithm, appending indices into Verts to OutIndices.
+	    Ears must wind clockwise around Normal, like the engine's GeomTools. Does not handle internal holes in the polygon.
+	    Returns false, without adding any indices, if the polygon couldn't be triangulated.
+	    Kept as a reference for TriangulatePolygon, in ModumateTriangulation.h. */
+	MODUMATECORE_API bool TriangulatePolygonNaive(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices);
+
+	/** Converts to feet, inches and (if any) the nearest eighth-inch fraction, reduced.
+	    Fills OutImperial with { feet, inches } or { feet, inches, numerator, denominator }, and returns how many values were written. */
+	MODUMATECORE_API int32_t CentimetersToImperialInches(float Centimeters, int32_t OutImperial[4]);
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+#include <vector>
+
+namespace ModumateCore
+{
+	/**
+	 * Builds an indexed triangle mesh into caller-owned buffers, welding vertices that have the same position and normal,
+	 * so that neighboring parts of a flat face share their vertices, while each face at a hard edge keeps its own.
+	 * Welding goes through a hash table that belongs to the calling thread and keeps its capacity from one mesh to the next,
+	 * so each thread should only build one mesh at a time.
+	 */
+	class MODUMATECORE_API FMeshBuilder
+	{
+	public:
+		// Positions and normals within this of each other are welded, a hundredth of a centimeter like the triangulation cache
+		static const float WeldSize;
+
+		/** Clears the buffers and starts a new mesh in them. Without welding, every vertex that's added is kept. */
+		FMeshBuilder(std::vector<FVec3>& InVertices, std::vector<FVec3>& InNormals, std::vector<int32_t>& InIndices, bool bInWeldVertices = true);
+
+		/** Returns the index of a welded vertex with this position and normal, adding one if there isn't any. */
+		int32_t AddVertex(const FVec3& Position, const FVec3& Normal);
+
+		/** Adds a triangle, unless welding has collapsed it. */
+		void AddTriangle(int32_t A, int32_t B, int32_t C);
+
+		/** Adds a quad from corners in order around it, winding it clockwise around Normal, which is also its vertices' normal. */
+		void AddQuad(const FVec3& A, const FVec3& B, const FVec3& C, const FVec3& D, const FVec3& Normal);
+
+		int32_t NumVertices() const { return static_cast<int32_t>(Vertices.size()); }
+		int32_t NumTriangles() const { return static_cast<int32_t>(Indices.size() / 3); }
+
+	private:
+		std::vector<FVec3>& Vertices;
+		std::vector<FVec3>& Normals;
+		std::vector<int32_t>& Indices;
+		bool bWeldVertices;
+	};
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+namespace ModumateCore
+{
+	/**
+	 * Computes the flat shading of a mesh whose vertices aren't shared between faces that point different ways, like the ones
+	 * that FMeshBuilder welds, in one pass over its triangles and one over its packed vertices, four at a time with SSE where it's available.
+	 * Normals are the normalized sum of their triangles' normals, which wind clockwise around them like AWall's mesh, or +Z without any.
+	 * Tangents run horizontally along each face, as Up ^ Normal, or along +X on horizontal faces, and UVs are the positions
+	 * projected onto the tangent and the bitangent (Normal ^ Tangent), times UVScale. They're aligned to whatever space the positions
+	 * are in, so neighboring meshes only line up if they're shaded in the same space, like world space for meshes at the origin.
+	 * The outputs must each have room for NumVertices, and mustn't overlap the positions.
+	 */
+	MODUMATECORE_API void ComputeFlatSurface(const FVec3* Positions, int32_t NumVertices, const int32_t* Indices, int32_t NumIndices, float UVScale,
+		FVec3* OutNormals, FVec3* OutTangents, FVec2* OutUVs);
+}
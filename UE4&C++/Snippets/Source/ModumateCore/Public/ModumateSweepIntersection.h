@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateGeometry.h"
+#include "ModumateFloorPlans.h"
+
+#include <vector>
+
+namespace ModumateCore
+{
+	/** A pair of crossing segments, indexing into the array of segments that was swept, with SegmentIndexA < SegmentIndexB. */
+	struct FSegmentCrossing
+	{
+		int32_t SegmentIndexA;
+		int32_t SegmentIndexB;
+
+		// Intersection as reported by IntersectSegments2D for segment A against segment B
+		FSegmentIntersection Intersection;
+	};
+
+	/** Finds every pair of segments that cross in the XY plane, sorted by segment indices, with a Bentley-Ottmann sweep.
+	    The sweep status is a balanced tree with a handle per segment, so N segments with K crossings take O((N + K) log N).
+	    Candidate pairs are confirmed with IntersectSegments2D, so the results match testing every pair with the same Epsilon. */
+	MODUMATECORE_API void FindSegmentCrossings(const FWallSegment* Segments, int32_t NumSegments,
+		std::vector<FSegmentCrossing>& OutCrossings, float Epsilon = 0.01f);
+}
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+#include "ModumateGeometry.h"
+
+#include <memory>
+#include <vector>
+
+namespace ModumateCore
+{
+	struct FEarClipperBuffers;
+	struct FDelaunayBuffers;
+
+	/**
+	 * Working memory for the triangulators, which keeps its capacity from one polygon to the next,
+	 * so that triangulating polygons no larger than ones it has already seen doesn't allocate.
+	 */
+	class MODUMATECORE_API FTriangulationScratch
+	{
+	public:
+		FTriangulationScratch();
+		~FTriangulationScratch();
+
+		FTriangulationScratch(const FTriangulationScratch&) = delete;
+		FTriangulationScratch& operator=(const FTriangulationScratch&) = delete;
+
+		// Vertices projected onto the polygon's plane, which the triangulators read from
+		std::vector<FVec2> Projected;
+
+		FEarClipperBuffers& GetEarClipperBuffers() { return *EarClipperBuffers; }
+		FDelaunayBuffers& GetDelaunayBuffers() { return *DelaunayBuffers; }
+
+	private:
+		std::unique_ptr<FEarClipperBuffers> EarClipperBuffers;
+		std::unique_ptr<FDelaunayBuffers> DelaunayBuffers;
+	};
+
+	/** The calling thread's own scratch, so that polygons can be triangulated on worker threads without sharing any buffers. */
+	MODUMATECORE_API FTriangulationScratch& GetThreadTriangulationScratch();
+
+	/** Reads vertices from a contiguous array of any type with float X, Y and Z members, such as FVec3 or FVector, without copying it. */
+	template <typename VertexType>
+	class TVertexArrayAccessor
+	{
+	public:
+		explicit TVertexArrayAccessor(const VertexType* InVerts) : Verts(InVerts) { }
+
+		FVec3 operator()(int32_t Index) const
+		{
+			const VertexType& Vert = Verts[Index];
+			return { Vert.X, Vert.Y, Vert.Z };
+		}
+
+	private:
+		const VertexType* Verts;
+	};
+
+	/** The most indices that triangulating loops with NumVerts vertices in total can produce; exactly 3(n - 2) for a single loop. */
+	inline int32_t GetMaxTriangleIndices(int32_t NumVerts, int32_t NumLoops)
+	{
+		int32_t MaxTriangles = NumVerts + 2 * (NumLoops - 1) - 2;
+		return (MaxTriangles > 0) ? (3 * MaxTriangles) : 0;
+	}
+
+	/** Projects the accessor's vertices into Scratch.Projected, the same way as ProjectToPlane. */
+	template <typename VertexAccessor>
+	void ProjectToScratch(const VertexAccessor& GetVertex, int32_t NumVerts, const FVec3& Normal, FTriangulationScratch& Scratch)
+	{
+		FVec3 U, V;
+		GetPlaneBasis(Normal, U, V);
+
+		Scratch.Projected.resize(NumVerts);
+		for (int32_t VertIndex = 0; VertIndex < NumVerts; ++VertIndex)
+		{
+			FVec3 Vert = GetVertex(VertIndex);
+			Scratch.Projected[VertIndex] = { Vert | U, Vert | V };
+		}
+	}
+
+	/**
+	 * Ear clips the polygon that is already projected into Scratch.Projected, writing GetMaxTriangleIndices(NumVerts, 1)
+	 * indices to OutIndices. Ears must wind clockwise in the projected plane. Returns the number of indices written,
+	 * or -1 if the polygon couldn't be triangulated.
+	 */
+	MODUMATECORE_API int32_t TriangulateProjectedPolygon(int32_t NumVerts, FTriangulationScratch& Scratch, int32_t* OutIndices);
+
+	/**
+	 * Decomposes the polygon into triangles by ear clipping, writing indices into the accessor's vertices to OutIndices,
+	 * which must have room for GetMaxTriangleIndices(NumVerts, 1) of them.
+	 * Ears must wind clockwise around Normal, and each triangle is (previous, ear, next), like TriangulatePolygonNaive.
+	 * Vertices are kept in a linked list, and only reflex vertices near each ear are tested against it, found through
+	 * a z-order curve, so typical polygons take O(n log n) rather than O(n^3). Does not handle internal holes in the polygon.
+	 * Returns the number of indices written, or -1 if the polygon couldn't be triangulated.
+	 */
+	template <typename VertexAccessor>
+	int32_t TriangulatePolygon(const VertexAccessor& GetVertex, int32_t NumVerts, const FVec3& Normal, FTriangulationScratch& Scratch, int32_t* OutIndices)
+	{
+		if (NumVerts < 3)
+		{
+			return 0;
+		}
+
+		ProjectToScratch(GetVertex, NumVerts, Normal, Scratch);
+		return TriangulateProjectedPolygon(NumVerts, Scratch, OutIndices);
+	}
+
+	/** Like the templated TriangulatePolygon, but appends to OutIndices, and returns false without adding any if it fails. */
+	MODUMATECORE_API bool TriangulatePolygon(const FVec3* Verts, int32_t NumVerts, const FVec3& Normal, std::vector<int32_t>& OutIndices);
+}
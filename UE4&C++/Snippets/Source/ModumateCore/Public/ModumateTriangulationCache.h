@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+#include "ModumateTriangulation.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ModumateCore
+{
+	/**
+	 * Least-recently-used cache of TriangulatePolygonDelaunay results, keyed by the loops' vertices projected onto their plane
+	 * and quantized to QuantizeSize, in order. Polygons that are triangulated again without changing share the same index buffer.
+	 * Thread-safe: lookups only lock the cache briefly, and misses are triangulated outside of the lock, in the calling thread's
+	 * scratch. Get() is the instance shared by rooms, floors and casework.
+	 */
+	class MODUMATECORE_API FTriangulationCache
+	{
+	public:
+		typedef std::shared_ptr<const std::vector<int32_t>> FIndexBuffer;
+
+		static const size_t DefaultCapacity = 16384;
+		static const float QuantizeSize;
+
+		explicit FTriangulationCache(size_t InCapacity = DefaultCapacity);
+
+		static FTriangulationCache& Get();
+
+		/**
+		 * Returns the triangle indices for the loops like TriangulatePolygonDelaunay, reading their vertices through the accessor,
+		 * or null if they couldn't be triangulated.
+		 */
+		template <typename VertexAccessor>
+		FIndexBuffer Triangulate(const VertexAccessor& GetVertex, const int32_t* LoopSizes, int32_t NumLoops, const FVec3& Normal,
+			bool* bOutHit = nullptr)
+		{
+			int32_t NumVerts = 0;
+			for (int32_t LoopIndex = 0; LoopIndex < NumLoops; ++LoopIndex)
+			{
+				NumVerts += LoopSizes[LoopIndex];
+			}
+
+			FTriangulationScratch& Scratch = GetThreadTriangulationScratch();
+			ProjectToScratch(GetVertex, NumVerts, Normal, Scratch);
+			return TriangulateProjected(LoopSizes, NumLoops, Scratch, bOutHit);
+		}
+
+		void SetCapacity(size_t NewCapacity);
+		size_t GetCapacity() const;
+		size_t Num() const;
+		void Empty();
+
+		uint64_t GetNumHits() const;
+		uint64_t GetNumMisses() const;
+
+	private:
+		struct FEntry
+		{
+			uint64_t Hash;
+			std::vector<int64_t> Key;
+			FIndexBuffer Indices;
+		};
+
+		// Looks up or triangulates the loops that were projected into Scratch
+		FIndexBuffer TriangulateProjected(const int32_t* LoopSizes, int32_t NumLoops, FTriangulationScratch& Scratch, bool* bOutHit);
+
+		// Moves the entry to the front, and returns its indices, if it's cached; only call with Mutex locked
+		FIndexBuffer FindEntry(uint64_t Hash, const std::vector<int64_t>& Key);
+
+		// Evicts the least recently used entries until there are no more than Capacity; only call with Mutex locked
+		void TrimToCapacity();
+
+		// Removes the entry's hash, without removing the entry itself; only call with Mutex locked
+		void RemoveFromHash(std::list<FEntry>::iterator Entry);
+
+		// Most recently used first
+		std::list<FEntry> Entries;
+		std::unordered_multimap<uint64_t, std::list<FEntry>::iterator> EntriesByHash;
+		mutable std::mutex Mutex;
+		size_t Capacity;
+		uint64_t NumHits;
+		uint64_t NumMisses;
+	};
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ModumateCoreTypes.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ModumateCore
+{
+	/** A window or door through a wall, as an interval along the wall's axis, and the heights of its sill and head above the wall's base. */
+	struct FWallOpening
+	{
+		int32_t ID;
+		float Start;
+		float End;
+		float SillHeight;
+		float HeadHeight;
+	};
+
+	/**
+	 * A wall's openings, kept sorted along the wall and without overlapping or touching each other,
+	 * so that adding, moving or removing one is O(log k), and the wall can be meshed in one pass over them.
+	 */
+	class MODUMATECORE_API FWallOpeningList
+	{
+	public:
+		typedef std::map<float, FWallOpening> FOpeningMap;
+
+		FWallOpeningList();
+
+		/** Whether the opening fits strictly inside a wall of the given length, clear of every opening but IgnoreID. */
+		bool CanPlace(const FWallOpening& Opening, float WallLength, int32_t IgnoreID = -1) const;
+
+		/** Adds the opening with a new ID, which is returned, or returns -1 without adding it if it can't be placed. */
+		int32_t Add(const FWallOpening& Opening, float WallLength);
+
+		/** Moves or resizes an existing opening, or returns false without changing it if it's missing or can't be placed there. */
+		bool Move(int32_t ID, const FWallOpening& Opening, float WallLength);
+
+		bool Remove(int32_t ID);
+
+		/** The solid stretch of wall around U, between the openings on either side of it, or the wall's ends. */
+		void GetGapAround(float U, float WallLength, float& OutStart, float& OutEnd) const;
+
+		const FWallOpening* Find(int32_t ID) const;
+
+		/** Openings in order along the wall, keyed by their Start. */
+		const FOpeningMap& GetOpenings() const { return Openings; }
+
+		int32_t Num() const { return static_cast<int32_t>(Openings.size()); }
+		void Empty();
+
+	private:
+		FOpeningMap Openings;
+		std::unordered_map<int32_t, float> OpeningStarts;
+		int32_t NextID;
+	};
+
+	/** A solid part of a wall, as an interval along it and a range of heights above its base. */
+	struct FWallSolidBox
+	{
+		float Start;
+		float End;
+		float Bottom;
+		float Top;
+	};
+
+	/**
+	 * Splits a wall into the fewest boxes that make it up around its openings, for collision: the full height spans between
+	 * openings, and the parts below and above each one. Openings that don't fit inside the wall are skipped, like BuildWallMesh.
+	 */
+	MODUMATECORE_API void GetWallSolidBoxes(const FWallOpeningList& Openings, float WallLength, float Height, std::vector<FWallSolidBox>& OutBoxes);
+
+	/**
+	 * Meshes a wall from StartPoint to EndPoint, extruded HalfThickness to either side and Height up from its start,
+	 * with its openings cut out, in a single pass over them. Openings that don't fit inside the wall are skipped.
+	 * Vertices have their face's normal, and triangles wind clockwise around it, like AWall's mesh.
+	 * Each solid part of the wall's sides is a single quad, and the base and top are merged across the parts that they're solid under,
+	 * so the sides have T-junctions where openings meet full height spans. With welding, the parts of each flat face share their vertices.
+	 */
+	MODUMATECORE_API void BuildWallMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices = true);
+
+	/**
+	 * Meshes only the wall from SpanStart to SpanEnd, like BuildWallMesh, with ExtraOpening cut into it too, if it isn't null.
+	 * The span is only capped at the wall's own ends, so that it closes the gap that BuildWallMeshAroundSpan leaves.
+	 */
+	MODUMATECORE_API void BuildWallSpanMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float SpanStart, float SpanEnd, const FWallOpening* ExtraOpening,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices = true);
+
+	/** Meshes all of the wall except from SpanStart to SpanEnd, like BuildWallMesh, leaving the gap open. */
+	MODUMATECORE_API void BuildWallMeshAroundSpan(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float SpanStart, float SpanEnd, std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices, bool bWeldVertices = true);
+
+	/** Meshes the wall as a solid slab, like BuildWallMesh without any openings, for when it's too far away for them to be seen. */
+	MODUMATECORE_API void BuildWallSlabMesh(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height,
+		std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices);
+
+	/**
+	 * Meshes a quad over each opening on either side of the wall, Offset out from its slab, to stand in for the openings
+	 * that BuildWallSlabMesh leaves out. Openings that don't fit inside the wall are skipped, like BuildWallMesh.
+	 */
+	MODUMATECORE_API void BuildWallOpeningQuads(const FVec3& StartPoint, const FVec3& EndPoint, float HalfThickness, float Height, const FWallOpeningList& Openings,
+		float Offset, std::vector<FVec3>& OutVertices, std::vector<FVec3>& OutNormals, std::vector<int32_t>& OutIndices);
+}